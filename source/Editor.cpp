@@ -51,6 +51,11 @@ bool Editor::Awake()
 	return ret;
 }
 
+bool Editor::IsEditing() const
+{
+	return ImGuizmo::IsUsing() || ImGui::IsAnyItemActive();
+}
+
 bool Editor::PreUpdate()
 {
 	userInterface->PreUpdate();
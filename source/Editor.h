@@ -31,6 +31,9 @@ public:
 
 	void HandleInput(SDL_Event* event);
 
+	//A GIZMO DRAG OR AN INSPECTOR FIELD IS STILL BEING EDITED
+	bool IsEditing() const;
+
 	//EVENTS
 	void OnEvent(const Event& event) override;
 
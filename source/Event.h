@@ -25,6 +25,7 @@ struct Event
 
         //GAMEOBJECT
         GameObjectCreated,
+        GameObjectsCreated,
         GameObjectDestroyed,
         GameObjectEnabled,
         GameObjectDisabled,
@@ -32,6 +33,10 @@ struct Event
         GameObjectDeselected,
         StaticChanged,
 
+        //COMPONENT, THE DATA IS ITS OWNER
+        ComponentEnabled,
+        ComponentDisabled,
+
         //TRANSFORM
         TransformChanged,
 
@@ -62,6 +67,12 @@ struct Event
         GameObject* gameObject;
     };
 
+    //VALID ONLY WHILE THE EVENT IS BEING HANDLED
+    struct GameObjectListData {
+        GameObject* const* gameObjects;
+        int count;
+    };
+
     struct SDLEvent
     {
         SDL_Event* event;
@@ -72,6 +83,7 @@ struct Event
         Point2dData point;
         StringData string;
         GameObjectData gameObject;
+        GameObjectListData gameObjectList;
         SDLEvent event;
     } data;
 
@@ -91,6 +103,11 @@ struct Event
         data.gameObject.gameObject = gameObject;
     }
 
+    Event(Type t, GameObject* const* gameObjects, int count) : type(t) {
+        data.gameObjectList.gameObjects = gameObjects;
+        data.gameObjectList.count = count;
+    }
+
     Event(Type t, SDL_Event* event) : type(t) {
         data.event.event = event;
     }
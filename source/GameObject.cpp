@@ -194,10 +194,10 @@ void GameObject::Save(pugi::xml_node gameObjectNode)
 	}
 }
 
-void GameObject::Load(pugi::xml_node gameObjectNode)
+void GameObject::Load(pugi::xml_node gameObjectNode, bool newUUIDs)
 {
 	name = gameObjectNode.attribute("Name").as_string();
-	UUID = gameObjectNode.attribute("UID").as_uint();
+	if (!newUUIDs) UUID = gameObjectNode.attribute("UID").as_uint();
 	enabled = gameObjectNode.attribute("Enabled").as_bool();
 
 	pugi::xml_node componentsNode = gameObjectNode.child("Components");
@@ -228,7 +228,7 @@ void GameObject::Load(pugi::xml_node gameObjectNode)
 
 			if (childObject)
 			{
-				childObject->Load(childNode);
+				childObject->Load(childNode, newUUIDs);
 				AddChild(childObject);
 			}
 			else
@@ -265,7 +265,7 @@ void GameObject::SetSelected(bool _selected)
 	selected = _selected;
 	for (auto component : components)
 	{
-		component.second->selected = _selected;
+		component.second->SetSelected(_selected);
 	}
 }
 
@@ -278,6 +278,8 @@ void GameObject::SetStatic(bool _static)
 void GameObject::SetEnabled(bool _enabled)
 {
 	enabled = _enabled;
+	Event::Type type = enabled ? Event::Type::GameObjectEnabled : Event::Type::GameObjectDisabled;
+	Engine::GetInstance().events->PublishImmediate(Event(type, this));
 }
 
 bool GameObject::GetEnabled()
@@ -31,7 +31,8 @@ public:
 	std::vector<GameObject*> GetChilds() { return childs;}
 
 	void Save(pugi::xml_node gameObjectNode);
-	void Load(pugi::xml_node gameObjectNode);
+	//newUUIDs KEEPS THE FRESH UUIDS INSTEAD OF THE SAVED ONES, FOR INSTANCING A SAVED HIERARCHY MORE THAN ONCE
+	void Load(pugi::xml_node gameObjectNode, bool newUUIDs = false);
 
 	//GETTERS & SETTERS
 	void SetSelected(bool selected);
@@ -22,6 +22,7 @@
 #include "ImGuizmo.h"
 
 #include <SDL3/SDL_events.h>
+#include <cstdio>
 
 Interface::Interface()
 {
@@ -106,6 +107,7 @@ bool Interface::Update(float dt)
 			}
 			if (ImGui::MenuItem("New Scene"))
 			{
+				Engine::GetInstance().loader->CancelImports();
 				Engine::GetInstance().scene->CleanUp();
 			}
 			if (ImGui::MenuItem("Save Scene"))
@@ -177,6 +179,8 @@ bool Interface::Update(float dt)
 		ImGui::EndMainMenuBar();
 	}
 
+	DrawImports();
+
 	for (auto const& pair : windows)
 	{
 		const std::vector<UIWindow*>& windows = pair.second;
@@ -193,6 +197,45 @@ bool Interface::Update(float dt)
 	return true;
 }
 
+void Interface::DrawImports()
+{
+	Loader* loader = Engine::GetInstance().loader;
+	if (loader->GetNumImports() == 0) return;
+
+	std::vector<ImportProgress> progress;
+	loader->GetImportProgress(progress);
+
+	const ImGuiViewport* viewport = ImGui::GetMainViewport();
+	ImGui::SetNextWindowPos(ImVec2(viewport->WorkPos.x + viewport->WorkSize.x - 10.0f, viewport->WorkPos.y + viewport->WorkSize.y - 10.0f), ImGuiCond_Always, ImVec2(1.0f, 1.0f));
+
+	if (ImGui::Begin("Importing", nullptr, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoDocking | ImGuiWindowFlags_NoSavedSettings))
+	{
+		for (int i = 0; i < (int)progress.size(); i++)
+		{
+			const ImportProgress& entry = progress[i];
+			ImGui::PushID(i);
+
+			char overlay[64];
+			float fraction = 0.0f;
+
+			if (entry.cooking) snprintf(overlay, sizeof(overlay), "Cooking...");
+			else
+			{
+				snprintf(overlay, sizeof(overlay), "%d / %d meshes", entry.meshesLoaded, entry.meshesTotal);
+				fraction = entry.meshesTotal > 0 ? (float)entry.meshesLoaded / entry.meshesTotal : 1.0f;
+			}
+
+			ImGui::TextUnformatted(entry.path.c_str());
+			ImGui::ProgressBar(fraction, ImVec2(250.0f, 0.0f), overlay);
+			ImGui::SameLine();
+			if (ImGui::Button("Cancel")) loader->CancelImport(i);
+
+			ImGui::PopID();
+		}
+	}
+	ImGui::End();
+}
+
 bool Interface::PostUpdate()
 {
 
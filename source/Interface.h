@@ -44,6 +44,9 @@ public:
 	void ApplyTheme(Theme theme);
 
 private:
+	//PROGRESS AND CANCEL OF THE MODELS STREAMING IN, ONLY WHILE THERE ARE ANY
+	void DrawImports();
+
 	void SetDarkTheme();
 	void SetLightTheme();
 	void SetCyberpunkTheme();
@@ -2,6 +2,7 @@
 #include "Loader.h"
 #include "Scene.h"
 #include "Engine.h"
+#include "Render.h"
 #include "Input.h"
 #include "GameObject.h"
 #include "EventSystem.h"
@@ -11,9 +12,30 @@
 #include "components/Transform.h"
 #include "components/Texture.h"
 #include "utils/Log.h"
+#include "utils/JobSystem.h"
+#include "utils/VertexPacking.h"
+#include "utils/ImportDatabase.h"
+#include "utils/FilePath.h"
+#include "utils/FileIndex.h"
+#include "utils/ModelCook.h"
+#include "utils/AssimpMesh.h"
+#include "utils/TextureCache.h"
+#include "utils/Timer.h"
+#include "utils/ProcessMemory.h"
+#include "utils/MeshResidency.h"
+#include "utils/MeshCache.h"
+#include "utils/Prefab.h"
+#include "utils/AssetWatcher.h"
+#include "utils/AllocationCounter.h"
 #include "Global.h"
 
 #include <list>
+#include <deque>
+#include <unordered_map>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+#include <cmath>
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
@@ -21,57 +43,6 @@
 
 #include "pugixml.hpp"
 
-std::string GetDirectoryFromPath(const std::string& filePath)
-{
-	size_t pos = filePath.find_last_of("\\/");
-	return (std::string::npos == pos) ? "" : filePath.substr(0, pos + 1);
-}
-
-std::string GetFileExtension(const std::string& filePath)
-{
-	size_t pos = filePath.find_last_of(".");
-	if (std::string::npos == pos) return "";
-
-	std::string ext = filePath.substr(pos + 1);
-
-	std::transform(ext.begin(), ext.end(), ext.begin(),
-		[](unsigned char c) { return std::tolower(c); });
-
-	return ext;
-}
-
-std::string GetFileName(const std::string& filePath)
-{
-	size_t pos = filePath.find_last_of("/\\");
-	if (std::string::npos == pos) return filePath;
-	return filePath.substr(pos + 1);
-}
-
-std::string FindFileInDirectory(const std::string& directoryPath, const std::string& fileName)
-{
-	std::string resultPath = "";
-
-	struct CallbackData {
-		std::string* result;
-		const std::string* target;
-	} data{ &resultPath, &fileName };
-
-	SDL_EnumerateDirectory(
-		directoryPath.c_str(),
-		[](void* userdata, const char* dirname, const char* fname) -> SDL_EnumerationResult {
-			auto* d = static_cast<CallbackData*>(userdata);
-			if (fname && *d->target == fname) {
-				*d->result = std::string(dirname) + "/" + fname;
-				return SDL_ENUM_SUCCESS;
-			}
-			return SDL_ENUM_CONTINUE;
-		},
-		&data
-	);
-
-	return resultPath;
-}
-
 Loader::Loader(bool startEnabled) : Module(startEnabled)
 {
 	name = "loader";
@@ -85,6 +56,7 @@ Loader::~Loader()
 bool Loader::Awake()
 {
 	Engine::GetInstance().events->Subscribe(Event::Type::FileDropped, this);
+	assetWatcher = new AssetWatcher("Assets");
 	return true;
 }
 
@@ -97,7 +69,7 @@ bool Loader::Start()
 
 	LOG("Loading initial model: %s", modelPath.c_str());
 
-	if (!LoadModel(modelPath))
+	if (!(asyncImport ? LoadModelAsync(modelPath) : LoadModel(modelPath)))
 	{
 		LOG("ERROR: Failed to load the initial model. Check if the file exists in the build directory.");
 		ret = false;
@@ -106,8 +78,163 @@ bool Loader::Start()
 	return ret;
 }
 
+//ONE NODE OF A COOKED MODEL, IN HIERARCHY ORDER. THE GAMEOBJECT IS CREATED WHEN ITS MESH DECODE IS QUEUED AND ENTERS
+//THE SCENE WHEN THE MESH IS UPLOADED, SO PARENTS ALWAYS GO IN BEFORE THEIR CHILDS
+struct StreamedNode
+{
+	pugi::xml_node xmlNode;
+	int parentIndex = -1;
+	std::string meshPath;
+
+	GameObject* gameObject = nullptr;
+	Mesh* mesh = nullptr;
+
+	//WRITTEN BY THE DECODE JOB, READ ONCE decoded IS SET
+	MeshUpload upload;
+	bool prepared = false;
+	std::atomic<bool> decoded{ false };
+
+	//THE MESH FILE WAS ALREADY LOADED, NOTHING TO DECODE OR UPLOAD
+	bool shared = false;
+};
+
+struct ModelImport
+{
+	std::string path;
+	ModelCookSettings settings;
+	Timer timer;
+
+	//WRITTEN BY THE COOK JOB, READ ONCE cooked IS SET
+	pugi::xml_document doc;
+	std::deque<StreamedNode> nodes;
+	int meshesTotal = 0;
+	bool failed = false;
+	bool recooked = false;
+	std::atomic<bool> cooked{ false };
+
+	//NODES [nextAttach, nextCreate) HAVE A GAMEOBJECT THAT ISN'T IN THE SCENE YET
+	size_t nextCreate = 0;
+	size_t nextAttach = 0;
+	int meshesQueued = 0;
+	int meshesLoaded = 0;
+
+	//TREES THE ATTACHED CHILDS GO INTO, REBUILT ONCE WHEN THE IMPORT ENDS
+	bool attachedStatic = false;
+	bool attachedDynamic = false;
+
+	//THE COOK WAITS FOR THE OTHER IMPORTS AND RELOADS OF THE SAME MODEL
+	bool reimport = false;
+	bool queued = false;
+
+	//THE SOURCE CHANGED DURING THE IMPORT, IT IS RELOADED AFTERWARDS
+	bool reloadAfter = false;
+
+	std::atomic<int> jobsInFlight{ 0 };
+	bool cancelled = false;
+};
+
+//A MODEL CHANGED ON DISK. THE COOK WRITES ITS MESH FILES AGAIN UNDER THE SAME NAMES, THEN EACH ONE IS DECODED ON A
+//WORKER AND UPLOADED, AND ITS RESOURCE REPLACES THE OLD ONE IN EVERY MESH COMPONENT LOADED FROM THAT FILE
+struct MeshReload
+{
+	std::string path;
+
+	//A MESH WITHOUT OWNER THAT ONLY LOADS THE NEW RESOURCE
+	Mesh* loader = nullptr;
+	MeshUpload upload;
+	bool prepared = false;
+	std::atomic<bool> decoded{ false };
+};
+
+struct ModelReload
+{
+	std::string path;
+	ModelCookSettings settings;
+	Timer timer;
+
+	//WRITTEN BY THE COOK JOB, READ ONCE cooked IS SET
+	std::deque<MeshReload> meshes;
+	bool failed = false;
+	std::atomic<bool> cooked{ false };
+
+	//MESHES [nextSwap, nextDecode) ARE DECODING OR WAITING FOR THEIR UPLOAD
+	size_t nextDecode = 0;
+	size_t nextSwap = 0;
+	int componentsUpdated = 0;
+
+	std::atomic<int> jobsInFlight{ 0 };
+	bool cancelled = false;
+
+	//THE SOURCE CHANGED AGAIN DURING THE RELOAD, IT IS COOKED ONCE MORE AFTERWARDS
+	bool changedAgain = false;
+};
+
+bool Loader::Update(float dt)
+{
+	if (watchAssets && assetWatcher)
+	{
+		std::vector<std::string> changed;
+		assetWatcher->intervalSec = watchIntervalSec;
+		assetWatcher->Poll(changed);
+
+		for (const std::string& path : changed) HandleAssetChange(path);
+	}
+
+	//ONE BUDGET FOR EVERY IMPORT AND RELOAD, THE OLDEST FIRST
+	PerfTimer frameTimer;
+
+	for (size_t i = 0; i < imports.size();)
+	{
+		ModelImport* import = imports[i];
+		if (!import->queued && !import->cancelled && !IsModelBusy(import->path, import)) QueueImportCook(import);
+
+		//CANCELLED BEFORE ITS COOK, NOTHING WAS CREATED
+		if (import->queued ? StreamImport(*import, frameTimer) : import->cancelled)
+		{
+			std::string again = import->reloadAfter && !import->cancelled ? import->path : "";
+
+			delete import;
+			imports.erase(imports.begin() + i);
+
+			if (!again.empty()) ReloadModel(again);
+		}
+		else i++;
+	}
+
+	for (size_t i = 0; i < reloads.size();)
+	{
+		if (StreamReload(*reloads[i], frameTimer))
+		{
+			std::string again = reloads[i]->changedAgain && !reloads[i]->cancelled ? reloads[i]->path : "";
+
+			delete reloads[i];
+			reloads.erase(reloads.begin() + i);
+
+			if (!again.empty()) ReloadModel(again);
+		}
+		else i++;
+	}
+
+	return true;
+}
+
 bool Loader::CleanUp()
 {
+	CancelImports();
+	for (ModelReload* reload : reloads) reload->cancelled = true;
+
+	//THE JOBS IN FLIGHT WRITE INTO THE IMPORTS AND RELOADS
+	while (!imports.empty() || !reloads.empty())
+	{
+		Update(0.0f);
+		std::this_thread::yield();
+	}
+
+	delete assetWatcher;
+	assetWatcher = nullptr;
+
+	ClearPrefabs();
+
 	return true;
 }
 
@@ -118,7 +245,8 @@ void Loader::HandleAssetDrop(const std::string& path)
 
 	if (extension == "fbx" || extension == "obj")
 	{
-		LoadModel(path);
+		if (asyncImport) LoadModelAsync(path);
+		else LoadModel(path);
 	}
 	else if (extension == "png" || extension == "dds" || extension == "jpg" || extension == "tga")
 	{
@@ -130,24 +258,107 @@ void Loader::HandleAssetDrop(const std::string& path)
 	}
 }
 
+void Loader::HandleAssetChange(const std::string& path)
+{
+	std::string extension = GetFileExtension(path);
+
+	if (extension == "fbx" || extension == "obj")
+	{
+		//MODELS NEVER IMPORTED AREN'T IN THE LIBRARY OR THE SCENE
+		if (ImportDatabase::GetInstance().IsRecorded(path)) ReloadModel(path);
+	}
+	else if (extension == "png" || extension == "dds" || extension == "jpg" || extension == "tga")
+	{
+		if (TextureCache::GetInstance().Reload(path) > 0) LOG("Reloading texture: %s", path.c_str());
+	}
+}
+
 #pragma region Models
 
+//EVERYTHING THAT CHANGES WHAT AN IMPORT WRITES TO THE LIBRARY, SHARED WITH w16cook
+static ModelCookSettings GetModelCookSettings()
+{
+	ModelCookSettings settings;
+	settings.packedVertexFormat = Engine::GetInstance().render->packedVertexFormat;
+	settings.compressMeshes = Engine::GetInstance().loader->compressLibraryMeshes;
+	settings.compressTextures = TextureCache::GetInstance().compress;
+	settings.textureQuality = TextureCache::GetInstance().quality;
+	settings.lowMemory = Engine::GetInstance().loader->lowMemoryImport;
+	settings.profile = Engine::GetInstance().loader->importProfile;
+	return settings;
+}
+
+static void CollectMeshArtifacts(GameObject* gameObject, std::vector<std::string>& artifacts)
+{
+	Mesh* mesh = (Mesh*)gameObject->GetComponent(ComponentType::Mesh);
+	if (mesh && !mesh->libraryPath.empty()) artifacts.push_back(mesh->libraryPath);
+
+	for (GameObject* child : gameObject->childs) CollectMeshArtifacts(child, artifacts);
+}
+
+static bool AreMeshesLoaded(GameObject* gameObject)
+{
+	Mesh* mesh = (Mesh*)gameObject->GetComponent(ComponentType::Mesh);
+	if (mesh && mesh->meshData.VAO == 0) return false;
+
+	for (GameObject* child : gameObject->childs)
+	{
+		if (!AreMeshesLoaded(child)) return false;
+	}
+
+	return true;
+}
+
+//ONE MESH OF A MODEL BEING IMPORTED. parent IS SET WHEN target IS AN EXTRA CHILD OF A NODE WITH SEVERAL MESHES
+struct MeshImport
+{
+	GameObject* target = nullptr;
+	GameObject* parent = nullptr;
+	aiMesh* assimpMesh = nullptr;
+	unsigned int assimpIndex = 0;
+	Mesh* mesh = nullptr;
+
+	//GPU FORMAT COPIES, KEPT UNTIL THE MAIN THREAD UPLOADS THEM
+	std::vector<PackedVertex> packedVertices;
+	std::vector<uint16_t> shortIndices;
+	MeshUpload upload;
+	bool prepared = false;
+};
+
 bool Loader::LoadModel(const std::string& filePath)
 {
 	std::string modelDirectory = GetDirectoryFromPath(filePath);
+	uint64_t settingsHash = GetModelSettingsHash(GetModelCookSettings());
 
-	Assimp::Importer importer;
-	const aiScene* scene = importer.ReadFile(filePath,
-		aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_GlobalScale);
+	//LOADED BEFORE, ONLY THE GAMEOBJECTS ARE NEW
+	if (InstantiatePrefab(filePath, 1) > 0) return true;
 
-	if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+	//COOKED BEFORE AND UNCHANGED, THE LIBRARY HAS EVERYTHING
+	if (useImportCache)
 	{
-		LOG("Error loading model with Assimp: %s", importer.GetErrorString());
-		return false;
+		ImportRecord record;
+		GameObject* cachedGameObject = ImportDatabase::GetInstance().Find(filePath, settingsHash, record) ? LoadCookedModel(record.cookedPath) : nullptr;
+
+		if (cachedGameObject)
+		{
+			Engine::GetInstance().scene->AddGameObject(cachedGameObject);
+			LOG("Model loaded from Library: %s", filePath.c_str());
+
+			Prefab* prefab = new Prefab();
+			if (prefab->LoadFile(record.cookedPath)) StorePrefab(filePath, prefab);
+			else delete prefab;
+
+			return true;
+		}
 	}
 
-	//SCENE NODES PROCESS
-	GameObject* rootGameObject = ProcessNode(scene->mRootNode, scene, modelDirectory);
+	Assimp::Importer importer;
+	const aiScene* scene = ReadModel(importer, filePath, importProfile);
+	if (!scene) return false;
+
+	//SCENE NODES PROCESS. THE WHOLE HIERARCHY FIRST, SO NAMES AND UUIDS ARE FINAL BEFORE ANY LIBRARY FILE IS WRITTEN
+	std::vector<MeshImport> imports;
+	GameObject* rootGameObject = ProcessNode(scene->mRootNode, scene, imports);
 
 	if (rootGameObject == nullptr)
 	{
@@ -155,13 +366,24 @@ bool Loader::LoadModel(const std::string& filePath)
 		return false;
 	}
 
+	ImportMeshes(imports, scene, modelDirectory);
+
+	if (SaveCookedModel(filePath, rootGameObject, settingsHash))
+	{
+		Prefab* prefab = new Prefab();
+		if (prefab->LoadFile(GetCookedModelPath(filePath))) StorePrefab(filePath, prefab);
+		else delete prefab;
+	}
+
+	LOG("Model imported: %s, peak memory %.1f MB", filePath.c_str(), GetPeakResidentBytes() / (1024.0f * 1024.0f));
+
 	//ADD GAMEOBJECT TO SCENE
 	Engine::GetInstance().scene->AddGameObject(rootGameObject);
 
 	return true;
 }
 
-GameObject* Loader::ProcessNode(aiNode* node, const aiScene* scene, const std::string& modelDirectory)
+GameObject* Loader::ProcessNode(aiNode* node, const aiScene* scene, std::vector<MeshImport>& imports)
 {
 	GameObject* nodeGameObject = new GameObject(true, node->mName.C_Str());
 
@@ -175,123 +397,710 @@ GameObject* Loader::ProcessNode(aiNode* node, const aiScene* scene, const std::s
 	nodeGameObject->transform->SetQuaternionRotation(glm::quat(rotation.w, rotation.x, rotation.y, rotation.z));
 	nodeGameObject->transform->SetScale(glm::vec3(scaling.x, scaling.y, scaling.z));
 
-	//PROCESS MESHES
-	if (node->mNumMeshes == 1)
+	//QUEUE MESHES, THEY ARE LOADED ONCE THE TREE IS BUILT
+	for (unsigned int i = 0; i < node->mNumMeshes; i++)
 	{
-		aiMesh* assimpMesh = scene->mMeshes[node->mMeshes[0]];
+		MeshImport import;
+		import.assimpIndex = node->mMeshes[i];
+		import.assimpMesh = scene->mMeshes[import.assimpIndex];
+		import.target = nodeGameObject;
 
-		if (!AddMeshAndTextureFromAssimp(nodeGameObject, assimpMesh, scene, modelDirectory))
+		if (node->mNumMeshes > 1)
 		{
-			LOG("Error processing mesh for node %s. Node will be empty.", node->mName.C_Str());
+			import.target = new GameObject(true, import.assimpMesh->mName.C_Str());
+			import.parent = nodeGameObject;
+			nodeGameObject->AddChild(import.target);
 		}
+
+		import.mesh = (Mesh*)import.target->AddComponent(ComponentType::Mesh);
+		imports.push_back(std::move(import));
 	}
-	else if (node->mNumMeshes > 0)
+
+	//RECURSIVE CHILDS CREATION
+	for (unsigned int i = 0; i < node->mNumChildren; i++)
 	{
-		for (unsigned int i = 0; i < node->mNumMeshes; i++)
+		GameObject* childNodeGO = ProcessNode(node->mChildren[i], scene, imports);
+		if (childNodeGO)
+		{
+			nodeGameObject->AddChild(childNodeGO);
+		}
+	}
+
+	return nodeGameObject;
+}
+
+//THE CPU COPY GOES BACK TO THE LIBRARY RIGHT AWAY, IT IS PAGED IN AGAIN THE FIRST TIME SOMETHING ASKS FOR IT
+static void EvictImportedGeometry(Mesh* mesh)
+{
+	mesh->EvictGeometry();
+}
+
+void Loader::ImportMeshes(std::vector<MeshImport>& imports, const aiScene* scene, const std::string& modelDirectory)
+{
+	bool packed = Engine::GetInstance().render->packedVertexFormat;
+
+	//ONE SCAN OF THE MODEL DIRECTORY FOR EVERY MATERIAL, ONLY IF A MATERIAL HAS A TEXTURE
+	FileIndex textureFiles(modelDirectory);
+
+	//IMPORTS STILL TO CONVERT EACH ASSIMP MESH, THE LAST ONE FREES IT
+	std::vector<std::atomic<int>> assimpUses(scene->mNumMeshes);
+	for (const MeshImport& import : imports) assimpUses[import.assimpIndex]++;
+
+	//CONVERSION, BOUNDS, MESHLETS, PACKING AND LIBRARY WRITE. NO GL CALLS HERE
+	auto prepare = [&](MeshImport& import) {
+		if (!import.mesh) return;
+
+		size_t allocationsBefore = GetAllocationCount();
+
+		std::vector<Vertex> vertices;
+		std::vector<unsigned int> indices;
+		import.mesh->hasUVs = import.assimpMesh->HasTextureCoords(0);
+		ConvertAssimpMesh(import.assimpMesh, vertices, indices);
+
+		if (--assimpUses[import.assimpIndex] == 0) ReleaseAssimpMeshData(import.assimpMesh);
+
+		if (packed)
 		{
-			aiMesh* assimpMesh = scene->mMeshes[node->mMeshes[i]];
-			GameObject* meshGameObject = new GameObject(true, assimpMesh->mName.C_Str());
+			import.packedVertices.resize(vertices.size());
+			if (CanUseShortIndices(vertices.size())) import.shortIndices.resize(indices.size());
+		}
+
+		import.upload.compressLibrary = compressLibraryMeshes;
+		import.prepared = import.mesh->PrepareModel(std::move(vertices), std::move(indices), import.packedVertices, import.shortIndices, import.upload);
+
+#ifdef W16_COUNT_ALLOCATIONS
+		LOG("Allocation benchmark: %s used %zu heap allocations from conversion to Library file", import.mesh->owner->name.c_str(), GetAllocationCount() - allocationsBefore);
+#else
+		(void)allocationsBefore;
+#endif
+	};
 
-			if (AddMeshAndTextureFromAssimp(meshGameObject, assimpMesh, scene, modelDirectory))
+	//GPU UPLOAD AND TEXTURE, MAIN THREAD ONLY
+	auto finish = [&](MeshImport& import) {
+		bool loaded = import.prepared && import.mesh->FinishModel(import.upload);
+
+		std::vector<PackedVertex>().swap(import.packedVertices);
+		std::vector<uint16_t>().swap(import.shortIndices);
+
+		if (!loaded)
+		{
+			LOG("Error loading mesh data for %s.", import.target->name.c_str());
+
+			if (import.parent)
 			{
-				nodeGameObject->AddChild(meshGameObject);
+				LOG("Error processing mesh %s, skipping.", import.assimpMesh->mName.C_Str());
+				std::vector<GameObject*>& childs = import.parent->childs;
+				childs.erase(std::find(childs.begin(), childs.end(), import.target));
+				delete import.target;
 			}
 			else
 			{
-				LOG("Error processing mesh %s, skipping.", assimpMesh->mName.C_Str());
-				delete meshGameObject;
+				LOG("Error processing mesh for node %s. Node will be empty.", import.target->name.c_str());
+			}
+
+			return;
+		}
+
+		if (lowMemoryImport && import.upload.librarySaved) EvictImportedGeometry(import.mesh);
+
+		//ADD TEXTURE
+		if (scene->HasMaterials())
+		{
+			aiMaterial* material = scene->mMaterials[import.assimpMesh->mMaterialIndex];
+			Texture* texComp = (Texture*)import.target->AddComponent(ComponentType::Texture);
+			if (texComp != nullptr)
+			{
+				LoadFromAssimpMaterial(material, textureFiles, texComp);
 			}
 		}
+	};
+
+	//ONE MESH CONVERTED, UPLOADED AND RELEASED BEFORE THE NEXT ONE STARTS
+	if (lowMemoryImport)
+	{
+		for (MeshImport& import : imports)
+		{
+			prepare(import);
+			finish(import);
+		}
+
+		return;
 	}
 
-	//RECURSIVE CHILDS CREATION
-	for (unsigned int i = 0; i < node->mNumChildren; i++)
+#ifdef W16_COUNT_ALLOCATIONS
+	//THE COUNTER IS GLOBAL, ONE MESH AT A TIME KEEPS THE BENCHMARK EXACT
+	size_t batchSize = imports.size();
+#else
+	size_t batchSize = 1;
+#endif
+
+	JobSystem::GetInstance().ParallelFor(imports.size(), batchSize, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) prepare(imports[i]);
+	});
+
+	//UPLOADS IN NODE ORDER, SO THE RESULT DOESN'T DEPEND ON THE SCHEDULING
+	for (MeshImport& import : imports) finish(import);
+}
+
+GameObject* Loader::LoadCookedModel(const std::string& cookedPath)
+{
+	pugi::xml_document doc;
+	pugi::xml_node gameObjectNode = doc.load_file(cookedPath.c_str()) ? doc.child("Model").child("GameObject") : pugi::xml_node();
+
+	if (!gameObjectNode)
 	{
-		GameObject* childNodeGO = ProcessNode(node->mChildren[i], scene, modelDirectory);
-		if (childNodeGO)
+		LOG("Error: Invalid cooked model %s", cookedPath.c_str());
+		return nullptr;
+	}
+
+	//EVERY INSTANCE GETS ITS OWN UUIDS, THE MESH FILES ARE SHARED
+	GameObject* rootGameObject = new GameObject(true, gameObjectNode.attribute("Name").as_string());
+	rootGameObject->Load(gameObjectNode, true);
+
+	//A LIBRARY MESH THAT NO LONGER READS BACK SENDS THE MODEL THROUGH ASSIMP AGAIN
+	if (!AreMeshesLoaded(rootGameObject))
+	{
+		LOG("Error: Cooked model %s has broken meshes, importing it again", cookedPath.c_str());
+		rootGameObject->CleanUp();
+		delete rootGameObject;
+		return nullptr;
+	}
+
+	return rootGameObject;
+}
+
+bool Loader::SaveCookedModel(const std::string& filePath, GameObject* rootGameObject, uint64_t settingsHash)
+{
+	SDL_CreateDirectory(MODEL_LIBRARY_DIRECTORY);
+
+	//ONE FILE PER SOURCE PATH, RE-IMPORTS OVERWRITE IT
+	std::string cookedPath = GetCookedModelPath(filePath);
+
+	pugi::xml_document doc;
+	rootGameObject->Save(doc.append_child("Model").append_child("GameObject"));
+
+	if (!doc.save_file(cookedPath.c_str()))
+	{
+		LOG("Error: Could not save cooked model %s", cookedPath.c_str());
+		return false;
+	}
+
+	std::vector<std::string> artifacts;
+	CollectMeshArtifacts(rootGameObject, artifacts);
+
+	return ImportDatabase::GetInstance().Record(filePath, settingsHash, cookedPath, artifacts);
+}
+
+//HOW MANY MESHES ARE DECODED AHEAD OF THE UPLOADS. BOUNDS THE CPU COPIES WAITING IN MEMORY
+#define MODEL_IMPORT_DECODES_AHEAD 16
+
+static void MarkImportTreesDirty(const ModelImport& import)
+{
+	Scene* scene = Engine::GetInstance().scene;
+
+	if (import.attachedStatic) scene->MarkStaticTreeDirty();
+	if (import.attachedDynamic) scene->MarkDinamicTreeDirty();
+}
+
+static void FlattenCookedNode(ModelImport& import, pugi::xml_node gameObjectNode, int parentIndex)
+{
+	int index = (int)import.nodes.size();
+	import.nodes.emplace_back();
+
+	StreamedNode& node = import.nodes.back();
+	node.xmlNode = gameObjectNode;
+	node.parentIndex = parentIndex;
+
+	for (pugi::xml_node componentNode = gameObjectNode.child("Components").child("Component"); componentNode; componentNode = componentNode.next_sibling("Component"))
+	{
+		if ((ComponentType)componentNode.attribute("type").as_int() == ComponentType::Mesh)
 		{
-			nodeGameObject->AddChild(childNodeGO);
+			node.meshPath = componentNode.attribute("path").as_string();
+			import.meshesTotal++;
 		}
 	}
 
-	return nodeGameObject;
+	for (pugi::xml_node childNode = gameObjectNode.child("Childs").child("GameObject"); childNode; childNode = childNode.next_sibling("GameObject"))
+	{
+		FlattenCookedNode(import, childNode, index);
+	}
 }
 
-bool Loader::AddMeshAndTextureFromAssimp(GameObject* target, aiMesh* assimpMesh, const aiScene* scene, const std::string& modelDirectory)
+bool Loader::LoadModelAsync(const std::string& filePath)
 {
-	//ADD MESH
-	Mesh* meshComp = (Mesh*)target->AddComponent(ComponentType::Mesh);
-	if (!meshComp || !LoadFromAssimpMesh(assimpMesh, meshComp))
+	if (!SDL_GetPathInfo(filePath.c_str(), nullptr))
 	{
-		LOG("Error loading mesh data for %s.", target->name.c_str());
+		LOG("Error: Model not found: %s", filePath.c_str());
 		return false;
 	}
 
-	//ADD TEXTURE
-	if (scene->HasMaterials())
+	//LOADED BEFORE, ONLY THE GAMEOBJECTS ARE NEW
+	if (InstantiatePrefab(filePath, 1) > 0) return true;
+
+	ModelImport* import = new ModelImport();
+	import->path = filePath;
+	import->settings = GetModelCookSettings();
+	import->reimport = !useImportCache;
+
+	if (!IsModelBusy(filePath, import)) QueueImportCook(import);
+
+	imports.push_back(import);
+	LOG("Importing model: %s", filePath.c_str());
+	return true;
+}
+
+bool Loader::IsModelBusy(const std::string& filePath, const ModelImport* except) const
+{
+	std::string canonicalPath = CanonicalPath(filePath);
+
+	for (const ModelImport* import : imports)
+	{
+		if (import != except && import->queued && CanonicalPath(import->path) == canonicalPath) return true;
+	}
+
+	for (const ModelReload* reload : reloads)
 	{
-		aiMaterial* material = scene->mMaterials[assimpMesh->mMaterialIndex];
-		Texture* texComp = (Texture*)target->AddComponent(ComponentType::Texture);
-		if (texComp != nullptr)
+		if (CanonicalPath(reload->path) == canonicalPath) return true;
+	}
+
+	return false;
+}
+
+void Loader::QueueImportCook(ModelImport* import)
+{
+	import->queued = true;
+	import->jobsInFlight = 1;
+
+	bool reimport = import->reimport;
+
+	//THE SAME COOK AS w16cook, THEN THE HIERARCHY IS READ BACK. SKIPPED WHEN THE LIBRARY IS STILL VALID
+	JobSystem::GetInstance().Submit([import, reimport]() {
+		if (reimport) ImportDatabase::GetInstance().Forget(import->path);
+
+		bool skipped = false;
+		std::string cookedPath = GetCookedModelPath(import->path);
+		pugi::xml_node gameObjectNode;
+
+		if (CookModel(import->path, import->settings, skipped) && import->doc.load_file(cookedPath.c_str()))
 		{
-			LoadFromAssimpMaterial(material, modelDirectory, texComp);
+			gameObjectNode = import->doc.child("Model").child("GameObject");
 		}
+
+		import->recooked = !skipped;
+
+		if (gameObjectNode) FlattenCookedNode(*import, gameObjectNode, -1);
+		else import->failed = true;
+
+		import->cooked = true;
+		import->jobsInFlight--;
+	});
+}
+
+void Loader::CreateStreamedNode(ModelImport& import, size_t index)
+{
+	StreamedNode& node = import.nodes[index];
+	pugi::xml_node gameObjectNode = node.xmlNode;
+
+	//WHAT GameObject::Load DOES WITH NEW UUIDS, EXCEPT THE MESH, WHICH IS ONLY QUEUED
+	node.gameObject = new GameObject(gameObjectNode.attribute("Enabled").as_bool(), gameObjectNode.attribute("Name").as_string());
+
+	for (pugi::xml_node componentNode = gameObjectNode.child("Components").child("Component"); componentNode; componentNode = componentNode.next_sibling("Component"))
+	{
+		ComponentType type = (ComponentType)componentNode.attribute("type").as_int();
+		if (type == ComponentType::Mesh) continue;
+
+		Component* component = node.gameObject->GetComponent(type);
+		if (!component) component = node.gameObject->AddComponent(type);
+
+		if (component) component->Load(componentNode);
 	}
 
-	return true; // xito
+	if (node.meshPath.empty()) return;
+
+	node.mesh = (Mesh*)node.gameObject->AddComponent(ComponentType::Mesh);
+	import.meshesQueued++;
+
+	//A COOK REWROTE THE FILE UNDER THE SAME NAME, WHAT IS LOADED FROM IT IS STALE
+	if (import.recooked) MeshCache::GetInstance().Forget(node.meshPath);
+
+	MeshResource* shared = MeshCache::GetInstance().Find(node.meshPath);
+	if (shared)
+	{
+		node.shared = node.mesh->ShareResource(shared);
+		node.prepared = node.shared;
+		node.decoded = true;
+		return;
+	}
+
+	import.jobsInFlight++;
+
+	StreamedNode* decodeNode = &node;
+	ModelImport* owner = &import;
+
+	JobSystem::GetInstance().Submit([owner, decodeNode]() {
+		decodeNode->prepared = decodeNode->mesh->PrepareFromLibrary(decodeNode->meshPath, decodeNode->upload);
+		decodeNode->decoded = true;
+		owner->jobsInFlight--;
+	});
 }
 
-bool Loader::LoadFromAssimpMesh(aiMesh* assimpMesh, Mesh* mesh)
+bool Loader::StreamImport(ModelImport& import, const PerfTimer& frameTimer)
 {
-	std::vector<Vertex> vertices;
-	std::vector<unsigned int> indices;
+	if (!import.cooked) return false;
+
+	Scene* scene = Engine::GetInstance().scene;
+
+	if (import.cancelled)
+	{
+		//DECODES IN FLIGHT STILL WRITE INTO THE NODES
+		if (import.jobsInFlight > 0) return false;
+
+		for (size_t i = import.nextAttach; i < import.nextCreate; i++)
+		{
+			import.nodes[i].gameObject->CleanUp();
+			delete import.nodes[i].gameObject;
+		}
+
+		//THE CHILDS ATTACHED BEFORE THE CANCEL STAY IN THE SCENE
+		MarkImportTreesDirty(import);
+
+		LOG("Import cancelled after %d of %d meshes: %s", import.meshesLoaded, import.meshesTotal, import.path.c_str());
+		return true;
+	}
+
+	if (import.failed)
+	{
+		LOG("Error importing model: %s", import.path.c_str());
+		return true;
+	}
+
+	//QUEUE DECODES, ONLY SO FAR AHEAD THAT A HUGE MODEL NEVER HAS ALL ITS GEOMETRY WAITING IN MEMORY
+	while (import.nextCreate < import.nodes.size() && import.meshesQueued - import.meshesLoaded < MODEL_IMPORT_DECODES_AHEAD && frameTimer.ReadMs() < importBudgetMs)
+	{
+		CreateStreamedNode(import, import.nextCreate++);
+	}
+
+	//UPLOAD AND ATTACH IN ORDER, STOPPING AT THE FIRST MESH STILL DECODING
+	while (import.nextAttach < import.nextCreate && frameTimer.ReadMs() < importBudgetMs)
+	{
+		StreamedNode& node = import.nodes[import.nextAttach];
+
+		if (node.mesh)
+		{
+			if (!node.decoded) break;
+
+			if (!node.prepared || (!node.shared && !node.mesh->FinishModel(node.upload)))
+			{
+				//THE NEXT IMPORT COOKS THE MODEL AGAIN, THIS ONE KEEPS THE NODE WITHOUT ITS MESH
+				LOG("Error: Could not load %s, %s will be empty", node.meshPath.c_str(), node.gameObject->name.c_str());
+				ImportDatabase::GetInstance().Forget(import.path);
+
+				node.gameObject->components.erase(ComponentType::Mesh);
+				node.mesh->CleanUp();
+				delete node.mesh;
+				node.mesh = nullptr;
+			}
+
+			if (node.mesh && lowMemoryImport) EvictImportedGeometry(node.mesh);
+
+			node.upload = MeshUpload();
+			import.meshesLoaded++;
+		}
+
+		if (node.parentIndex < 0)
+		{
+			scene->AddGameObject(node.gameObject);
+		}
+		else
+		{
+			import.nodes[node.parentIndex].gameObject->AddChild(node.gameObject);
+
+			if (node.gameObject->GetStatic()) import.attachedStatic = true;
+			else import.attachedDynamic = true;
+		}
+
+		import.nextAttach++;
+	}
+
+	if (import.nextAttach < import.nodes.size()) return false;
+
+	MarkImportTreesDirty(import);
+
+	LOG("Model imported in %.2f s: %s, peak memory %.1f MB", import.timer.ReadSec(), import.path.c_str(), GetPeakResidentBytes() / (1024.0f * 1024.0f));
+
+	//EVERY MESH IS LOADED BY NOW, THE PREFAB ONLY TAKES REFERENCES
+	Prefab* prefab = new Prefab();
+	if (prefab->Load(import.doc.child("Model").child("GameObject"))) StorePrefab(import.path, prefab);
+	else delete prefab;
+
+	return true;
+}
+
+void Loader::CancelImport(int index)
+{
+	if (index >= 0 && index < (int)imports.size()) imports[index]->cancelled = true;
+}
+
+void Loader::CancelImports()
+{
+	for (ModelImport* import : imports) import->cancelled = true;
+}
+
+void Loader::GetImportProgress(std::vector<ImportProgress>& progress) const
+{
+	progress.clear();
+
+	for (const ModelImport* import : imports)
+	{
+		ImportProgress entry;
+		entry.path = import->path;
+		entry.cooking = !import->cooked;
+		entry.meshesLoaded = import->meshesLoaded;
+		entry.meshesTotal = import->cooked ? import->meshesTotal : 0;
+		progress.push_back(entry);
+	}
+}
+
+Prefab* Loader::FindPrefab(const std::string& filePath)
+{
+	auto it = prefabs.find(CanonicalPath(filePath));
+	if (it == prefabs.end()) return nullptr;
+
+	//THE SAME CHECK AS ANY IMPORT: SOURCE, SETTINGS AND LIBRARY FILES
+	ImportRecord record;
+	if (useImportCache && ImportDatabase::GetInstance().Find(filePath, GetModelSettingsHash(GetModelCookSettings()), record)) return it->second;
+
+	LOG("Prefab of %s is out of date", filePath.c_str());
+	delete it->second;
+	prefabs.erase(it);
+	return nullptr;
+}
+
+void Loader::StorePrefab(const std::string& filePath, Prefab* prefab)
+{
+	Prefab*& stored = prefabs[CanonicalPath(filePath)];
+	delete stored;
+	stored = prefab;
+
+	lastModelPath = filePath;
+}
+
+int Loader::InstantiatePrefab(const std::string& filePath, int count)
+{
+	Prefab* prefab = count > 0 ? FindPrefab(filePath) : nullptr;
+	if (!prefab) return 0;
+
+	PerfTimer timer;
+
+	//A SQUARE GRID, ONE MODEL APART
+	glm::vec3 size = prefab->GetSize();
+	float spacing = std::max(std::max(size.x, size.z), 1.0f) * 1.25f;
+	int columns = (int)std::ceil(std::sqrt((float)count));
 
-	//FILL VERTEXS
-	for (unsigned int i = 0; i < assimpMesh->mNumVertices; i++)
+	std::vector<GameObject*> roots;
+	roots.reserve(count);
+
+	for (int i = 0; i < count; i++)
 	{
-		Vertex vertex;
+		roots.push_back(prefab->Instantiate(glm::vec3((i % columns) * spacing, 0.0f, (i / columns) * spacing)));
+	}
+
+	//ONE COPY BEHAVES LIKE ANY LOADED MODEL AND GETS SELECTED
+	if (count == 1) Engine::GetInstance().scene->AddGameObject(roots[0]);
+	else Engine::GetInstance().scene->AddGameObjects(roots);
 
-		vertex.position.x = assimpMesh->mVertices[i].x;
-		vertex.position.y = assimpMesh->mVertices[i].y;
-		vertex.position.z = assimpMesh->mVertices[i].z;
+	LOG("%d instances of %s (%d GameObjects) in %.2f ms", count, filePath.c_str(), count * (int)prefab->GetNumNodes(), timer.ReadMs());
+	return count;
+}
 
-		if (assimpMesh->HasNormals()) {
-			vertex.normal.x = assimpMesh->mNormals[i].x;
-			vertex.normal.y = assimpMesh->mNormals[i].y;
-			vertex.normal.z = assimpMesh->mNormals[i].z;
+void Loader::ClearPrefabs()
+{
+	for (auto& pair : prefabs) delete pair.second;
+	prefabs.clear();
+}
+
+static void CollectReloadMeshes(ModelReload& reload, pugi::xml_node gameObjectNode)
+{
+	for (pugi::xml_node componentNode = gameObjectNode.child("Components").child("Component"); componentNode; componentNode = componentNode.next_sibling("Component"))
+	{
+		if ((ComponentType)componentNode.attribute("type").as_int() == ComponentType::Mesh)
+		{
+			reload.meshes.emplace_back();
+			reload.meshes.back().path = componentNode.attribute("path").as_string();
 		}
-		else {
-			vertex.normal = glm::vec3(0.0f);
+	}
+
+	for (pugi::xml_node childNode = gameObjectNode.child("Childs").child("GameObject"); childNode; childNode = childNode.next_sibling("GameObject"))
+	{
+		CollectReloadMeshes(reload, childNode);
+	}
+}
+
+static void FreeReloadLoader(MeshReload& mesh)
+{
+	if (!mesh.loader) return;
+
+	mesh.upload = MeshUpload();
+	mesh.loader->CleanUp();
+	delete mesh.loader->aabb;
+	delete mesh.loader;
+	mesh.loader = nullptr;
+}
+
+bool Loader::ReloadModel(const std::string& filePath)
+{
+	//TWO COOKS OF THE SAME FILE WOULD WRITE THE SAME MESH FILES AT ONCE
+	for (ModelReload* reload : reloads)
+	{
+		if (!reload->cancelled && CanonicalPath(reload->path) == CanonicalPath(filePath))
+		{
+			reload->changedAgain = true;
+			return true;
 		}
+	}
 
-		if (assimpMesh->HasTextureCoords(0)) {
-			vertex.texCoords.x = assimpMesh->mTextureCoords[0][i].x;
-			vertex.texCoords.y = assimpMesh->mTextureCoords[0][i].y;
-			mesh->hasUVs = true;
+	//AN IMPORT MAY STILL BE COOKING OR DECODING THOSE FILES. THE RELOAD RUNS WHEN IT ENDS
+	for (ModelImport* import : imports)
+	{
+		if (!import->cancelled && CanonicalPath(import->path) == CanonicalPath(filePath))
+		{
+			import->reloadAfter = true;
+			return true;
 		}
-		else {
-			vertex.texCoords = glm::vec2(0.0f);
-			mesh->hasUVs = false;
+	}
+
+	//ITS MESHES ARE ABOUT TO BE REPLACED, NEW COPIES ARE LOADED FROM THE NEW COOK
+	auto prefab = prefabs.find(CanonicalPath(filePath));
+	if (prefab != prefabs.end())
+	{
+		delete prefab->second;
+		prefabs.erase(prefab);
+	}
+
+	ModelReload* reload = new ModelReload();
+	reload->path = filePath;
+	reload->settings = GetModelCookSettings();
+	reload->jobsInFlight = 1;
+
+	//THE SOURCE NO LONGER MATCHES ITS RECORD, SO THE COOK WRITES EVERYTHING AGAIN. SKIPPED IF ONLY ITS DATE CHANGED
+	JobSystem::GetInstance().Submit([reload]() {
+		bool skipped = false;
+		pugi::xml_document doc;
+
+		if (CookModel(reload->path, reload->settings, skipped) && doc.load_file(GetCookedModelPath(reload->path).c_str()))
+		{
+			if (!skipped) CollectReloadMeshes(*reload, doc.child("Model").child("GameObject"));
 		}
+		else reload->failed = true;
+
+		reload->cooked = true;
+		reload->jobsInFlight--;
+	});
 
-		vertices.push_back(vertex);
+	reloads.push_back(reload);
+	LOG("Reloading model: %s", filePath.c_str());
+	return true;
+}
+
+bool Loader::StreamReload(ModelReload& reload, const PerfTimer& frameTimer)
+{
+	if (!reload.cooked) return false;
+
+	if (reload.cancelled)
+	{
+		//DECODES IN FLIGHT STILL WRITE INTO THE MESHES
+		if (reload.jobsInFlight > 0) return false;
+
+		for (size_t i = reload.nextSwap; i < reload.nextDecode; i++) FreeReloadLoader(reload.meshes[i]);
+		return true;
 	}
 
-	//FILL INDEX
-	for (unsigned int i = 0; i < assimpMesh->mNumFaces; i++)
+	if (reload.failed)
 	{
-		aiFace face = assimpMesh->mFaces[i];
+		LOG("Error reloading model: %s", reload.path.c_str());
+		return true;
+	}
 
-		for (unsigned int j = 0; j < face.mNumIndices; j++) {
-			indices.push_back(face.mIndices[j]);
+	//DECODES AHEAD OF THE SWAPS, BOUNDED LIKE AN IMPORT
+	while (reload.nextDecode < reload.meshes.size() && reload.nextDecode - reload.nextSwap < MODEL_IMPORT_DECODES_AHEAD)
+	{
+		MeshReload* mesh = &reload.meshes[reload.nextDecode++];
+		mesh->loader = new Mesh(nullptr, true);
+
+		ModelReload* owner = &reload;
+		reload.jobsInFlight++;
+
+		JobSystem::GetInstance().Submit([owner, mesh]() {
+			//JUST WRITTEN BY THE COOK OF THIS RELOAD
+			mesh->prepared = mesh->loader->PrepareFromLibrary(mesh->path, mesh->upload, false);
+			mesh->decoded = true;
+			owner->jobsInFlight--;
+		});
+	}
+
+	if (reload.nextSwap < reload.nextDecode && reload.meshes[reload.nextSwap].decoded)
+	{
+		//THE MESH COMPONENTS OF THE SCENE BY LIBRARY FILE. GATHERED EVERY FRAME, THE SCENE MAY HAVE CHANGED
+		std::unordered_map<std::string, std::vector<Mesh*>> users;
+		for (GameObject* gameObject : Engine::GetInstance().scene->GetAllGameObjects())
+		{
+			Mesh* mesh = (Mesh*)gameObject->GetComponent(ComponentType::Mesh);
+			if (mesh && !mesh->libraryPath.empty()) users[mesh->libraryPath].push_back(mesh);
+		}
+
+		bool anySwapped = false;
+
+		while (reload.nextSwap < reload.nextDecode && frameTimer.ReadMs() < importBudgetMs)
+		{
+			MeshReload& mesh = reload.meshes[reload.nextSwap];
+			if (!mesh.decoded) break;
+
+			//WHAT WAS LOADED FROM THE OLD FILE IS NEVER SHARED AGAIN
+			MeshCache::GetInstance().Forget(mesh.path);
+
+			if (mesh.prepared && mesh.loader->FinishModel(mesh.upload))
+			{
+				auto found = users.find(mesh.path);
+				if (found != users.end())
+				{
+					for (Mesh* user : found->second) user->ShareResource(mesh.loader->resource);
+					reload.componentsUpdated += (int)found->second.size();
+					anySwapped = true;
+				}
+			}
+			else
+			{
+				LOG("Error: Could not reload %s", mesh.path.c_str());
+			}
+
+			FreeReloadLoader(mesh);
+			reload.nextSwap++;
+		}
+
+		//NEW BOUNDS, AND THE STATIC BATCHES STILL HOLD THE OLD GEOMETRY
+		if (anySwapped)
+		{
+			Engine::GetInstance().scene->MarkStaticTreeDirty();
+			Engine::GetInstance().scene->MarkDinamicTreeDirty();
 		}
 	}
 
-	mesh->LoadModel(vertices, indices);
+	if (reload.nextSwap < reload.meshes.size()) return false;
 
+	LOG("Model reloaded in %.2f s: %s, %d meshes, %d components updated", reload.timer.ReadSec(), reload.path.c_str(), (int)reload.meshes.size(), reload.componentsUpdated);
 	return true;
 }
 
+bool Loader::LoadFromAssimpMesh(aiMesh* assimpMesh, Mesh* mesh)
+{
+	std::vector<Vertex> vertices;
+	std::vector<unsigned int> indices;
+	ConvertAssimpMesh(assimpMesh, vertices, indices);
+
+	mesh->hasUVs = assimpMesh->HasTextureCoords(0);
+	return mesh->LoadModel(std::move(vertices), std::move(indices), compressLibraryMeshes);
+}
+
 #pragma endregion
 
 #pragma region Textures
@@ -310,6 +1119,7 @@ bool Loader::LoadTexture(const std::string& filePath)
 
 		if (texture->LoadTexture(filePath))
 		{
+			if (selectedGameObject->GetStatic()) Engine::GetInstance().scene->MarkStaticTreeDirty();
 			LOG("Texture %s applied to GameObject: %s", filePath.c_str(), selectedGameObject->name.c_str());
 			return true;
 		}
@@ -322,44 +1132,24 @@ bool Loader::LoadTexture(const std::string& filePath)
 
 }
 
-bool Loader::LoadFromAssimpMaterial(aiMaterial* material, const std::string& modelDirectory, Texture* texture)
+bool Loader::LoadFromAssimpMaterial(aiMaterial* material, FileIndex& textureFiles, Texture* texture)
 {
-	if (material->GetTextureCount(aiTextureType_DIFFUSE) > 0)
+	if (material->GetTextureCount(aiTextureType_DIFFUSE) == 0)
 	{
-		aiString aiPath;
-		material->GetTexture(aiTextureType_DIFFUSE, 0, &aiPath);
-
-		std::string fileName = GetFileName(aiPath.C_Str());
-
-		// Intento 1: Ruta tal como viene en el material
-		std::string texPath = modelDirectory + aiPath.C_Str();
-		if (texture->LoadTexture(texPath))
-		{
-			return true;
-		}
-
-		// Intento 2: Solo el nombre del archivo en el directorio del modelo
-		texPath = modelDirectory + fileName;
-		if (texture->LoadTexture(texPath))
-		{
-			return true;
-		}
-
-		// Intento 3: Buscar el archivo en el directorio del modelo
-		texPath = FindFileInDirectory(modelDirectory, fileName);
-		if (!texPath.empty() && texture->LoadTexture(texPath))
-		{
-			return true;
-		}
-
-		LOG("Error: Could not find texture '%s' in any location", fileName.c_str());
+		LOG("The material does not have a diffuse texture.");
 		return false;
 	}
-	else
+
+	std::string texPath = FindMaterialTexture(material, textureFiles);
+	if (!texPath.empty() && texture->LoadTexture(texPath))
 	{
-		LOG("The material does not have a diffuse texture.");
-		return false;
+		return true;
 	}
+
+	aiString aiPath;
+	material->GetTexture(aiTextureType_DIFFUSE, 0, &aiPath);
+	LOG("Error: Could not find texture '%s' in any location", GetFileName(aiPath.C_Str()).c_str());
+	return false;
 }
 
 #pragma endregion
@@ -432,7 +1222,7 @@ void Loader::CreateCube()
 		20, 21, 22, 22, 23, 20
 	};
 
-	mesh->LoadModel(vertices, indices);
+	mesh->LoadModel(std::move(vertices), std::move(indices), compressLibraryMeshes);
 
 	if (gameObject)
 	{
@@ -488,7 +1278,7 @@ void Loader::CreateSphere()
 		}
 	}
 
-	mesh->LoadModel(vertices, indices);
+	mesh->LoadModel(std::move(vertices), std::move(indices), compressLibraryMeshes);
 
 	if (gameObject)
 	{
@@ -537,7 +1327,7 @@ void Loader::CreatePyramid()
 		13, 14, 15
 	};
 
-	mesh->LoadModel(vertices, indices);
+	mesh->LoadModel(std::move(vertices), std::move(indices), compressLibraryMeshes);
 
 	if (gameObject)
 	{
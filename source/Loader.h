@@ -1,7 +1,11 @@
 #pragma once
 #include "Module.h"
 #include "EventListener.h"
+#include "utils/ModelCook.h"
 #include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
 
 class Mesh;
 class Texture;
@@ -10,6 +14,22 @@ struct aiMesh;
 struct aiMaterial;
 struct aiScene;
 struct aiNode;
+class PerfTimer;
+class Prefab;
+class AssetWatcher;
+class FileIndex;
+struct MeshImport;
+struct ModelImport;
+struct ModelReload;
+
+//ONE MODEL STREAMING IN, FOR THE EDITOR
+struct ImportProgress
+{
+	std::string path;
+	bool cooking = true;
+	int meshesLoaded = 0;
+	int meshesTotal = 0;
+};
 
 class Loader : public Module, public EventListener
 {
@@ -22,19 +42,43 @@ public:
 	bool Awake();
 	bool Start();
 
+	bool Update(float dt);
+
 	bool CleanUp();
 
 	void HandleAssetDrop(const std::string& path);
 
+	//HOT RELOAD OF A FILE CHANGED ON DISK. TEXTURES ARE DECODED AGAIN IN PLACE, MODELS THAT WERE IMPORTED ARE COOKED AGAIN
+	//AND THEIR NEW MESHES SWAPPED INTO EVERY COMPONENT USING THE OLD ONES. THE HIERARCHY IN THE SCENE IS LEFT AS IT IS
+	void HandleAssetChange(const std::string& path);
+	bool ReloadModel(const std::string& filePath);
+	int GetNumReloads() const { return (int)reloads.size(); }
+
 	//MODELS
 	bool LoadModel(const std::string& filePath);
 	bool LoadFromAssimpMesh(aiMesh* assimpMesh, Mesh* mesh);
-	GameObject* ProcessNode(aiNode* node, const aiScene* scene, const std::string& modelDirectory);
-	bool AddMeshAndTextureFromAssimp(GameObject* target, aiMesh* assimpMesh, const aiScene* scene, const std::string& modelDirectory);
+	GameObject* ProcessNode(aiNode* node, const aiScene* scene, std::vector<MeshImport>& imports);
+	void ImportMeshes(std::vector<MeshImport>& imports, const aiScene* scene, const std::string& modelDirectory);
+
+	//ASYNC MODELS. THE COOK AND THE MESH DECODES RUN ON THE JOB SYSTEM, THE UPLOADS IN Update UNDER importBudgetMs, AND
+	//EVERY GAMEOBJECT ENTERS THE SCENE AS SOON AS ITS MESH IS ON THE GPU. CANCELLING KEEPS WHAT ALREADY ENTERED
+	bool LoadModelAsync(const std::string& filePath);
+	void CancelImport(int index);
+	void CancelImports();
+	void GetImportProgress(std::vector<ImportProgress>& progress) const;
+	int GetNumImports() const { return (int)imports.size(); }
+
+	//PREFABS. EVERY MODEL LOADED KEEPS ITS FLATTENED HIERARCHY AND A REFERENCE TO ITS MESHES AND TEXTURES, SO LOADING IT
+	//AGAIN, OR SPAWNING THOUSANDS OF COPIES, ONLY CREATES GAMEOBJECTS. DROPPED WHEN ITS IMPORT IS NO LONGER VALID
+	Prefab* FindPrefab(const std::string& filePath);
+	int InstantiatePrefab(const std::string& filePath, int count);
+	void ClearPrefabs();
+	int GetNumPrefabs() const { return (int)prefabs.size(); }
+	const std::string& GetLastModelPath() const { return lastModelPath; }
 
 	//TEXTURES
 	bool LoadTexture(const std::string& filePath);
-	bool LoadFromAssimpMaterial(aiMaterial* material, const std::string& modelDirectory, Texture* texture);
+	bool LoadFromAssimpMaterial(aiMaterial* material, FileIndex& textureFiles, Texture* texture);
 	
 	//BASICS
 	void CreateBasic(int basic);
@@ -46,8 +90,52 @@ public:
 	//EVENTS
 	void OnEvent(const Event& event) override;
 
+	bool compressLibraryMeshes = true;
+
+	//MODELS STILL VALID IN THE IMPORT DATABASE ARE LOADED FROM THE LIBRARY WITHOUT ASSIMP
+	bool useImportCache = true;
+
+	bool asyncImport = true;
+	float importBudgetMs = 4.0f;
+
+	//MESHES CONVERTED, UPLOADED AND RELEASED ONE AT A TIME, AND THEIR CPU COPIES LEFT IN THE LIBRARY. SLOWER, BUT THE
+	//PEAK MEMORY OF AN IMPORT IS THE ASSIMP SCENE PLUS ONE MESH
+	bool lowMemoryImport = false;
+
+	//ASSIMP POST PROCESSING OF NEW IMPORTS. PART OF THE IMPORT SETTINGS, CHANGING IT IMPORTS MODELS AGAIN
+	ModelImportProfile importProfile = ModelImportProfile::Editable;
+
+	//Assets/ IS SCANNED FOR CHANGED FILES EVERY watchIntervalSec, ON THE JOB SYSTEM
+	bool watchAssets = true;
+	float watchIntervalSec = 1.0f;
+
 private:
+	GameObject* LoadCookedModel(const std::string& cookedPath);
+	bool SaveCookedModel(const std::string& filePath, GameObject* rootGameObject, uint64_t settingsHash);
+
+	//TWO COOKS OF THE SAME MODEL WOULD WRITE THE SAME LIBRARY FILES, SO AN IMPORT COOKS ONLY WHEN IT IS THE ONLY USER
+	bool IsModelBusy(const std::string& filePath, const ModelImport* except) const;
+	void QueueImportCook(ModelImport* import);
+
+	//FALSE WHILE THE IMPORT STILL NEEDS FRAMES
+	bool StreamImport(ModelImport& import, const PerfTimer& frameTimer);
+	void CreateStreamedNode(ModelImport& import, size_t index);
+
+	//REPLACES THE PREFAB OF THE MODEL, DELETED IF IT COULDN'T BE LOADED
+	void StorePrefab(const std::string& filePath, Prefab* prefab);
+
+	//FALSE WHILE THE RELOAD STILL NEEDS FRAMES
+	bool StreamReload(ModelReload& reload, const PerfTimer& frameTimer);
+
 	void CreateCube();
 	void CreateSphere();
 	void CreatePyramid();
+
+private:
+	std::vector<ModelImport*> imports;
+	std::vector<ModelReload*> reloads;
+	AssetWatcher* assetWatcher = nullptr;
+
+	std::unordered_map<std::string, Prefab*> prefabs;
+	std::string lastModelPath;
 };
\ No newline at end of file
@@ -14,6 +14,27 @@
 #include "components/Mesh.h"
 #include "components/Texture.h"
 #include "utils/Log.h"
+#include "utils/VertexPacking.h"
+#include "utils/StaticBatch.h"
+#include "utils/TextureFile.h"
+#include "utils/TextureStreamer.h"
+#include "utils/TextureCache.h"
+#include <algorithm>
+#include <cstring>
+
+//S3TC IS AN EXTENSION AND RGTC/BPTC NEED GL 3.0/4.2 HEADERS, THE TOKENS ARE FIXED
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+#ifndef GL_COMPRESSED_RG_RGTC2
+#define GL_COMPRESSED_RG_RGTC2 0x8DBD
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+#define GL_COMPRESSED_RGBA_BPTC_UNORM 0x8E8C
+#endif
 
 Render::Render(bool startEnabled) : Module(startEnabled)
 {
@@ -55,6 +76,40 @@ bool Render::Awake()
 	glVersion = reinterpret_cast<const char*>(glGetString(GL_VERSION));
 	glslVersion = reinterpret_cast<const char*>(glGetString(GL_SHADING_LANGUAGE_VERSION));
 
+	//BLOCK COMPRESSED FORMATS THE DRIVER ACCEPTS. THAT LIST ONLY HAS TO HOLD GENERAL PURPOSE FORMATS AND DRIVERS LEAVE
+	//OUT RGTC AND BPTC, SO THOSE COME FROM THE CORE VERSION AND S3TC FROM ITS EXTENSION
+	GLint numCompressedFormats = 0;
+	glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &numCompressedFormats);
+	compressedFormats.resize(numCompressedFormats);
+	if (numCompressedFormats > 0) glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, compressedFormats.data());
+
+	GLint majorVersion = 0;
+	GLint minorVersion = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &majorVersion);
+	glGetIntegerv(GL_MINOR_VERSION, &minorVersion);
+
+	bool hasS3TC = false;
+	bool hasRGTC = majorVersion >= 3;
+	bool hasBPTC = majorVersion > 4 || (majorVersion == 4 && minorVersion >= 2);
+
+	GLint numExtensions = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &numExtensions);
+	for (GLint i = 0; i < numExtensions; i++)
+	{
+		const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, i));
+		if (!extension) continue;
+
+		if (strcmp(extension, "GL_EXT_texture_compression_s3tc") == 0) hasS3TC = true;
+		else if (strcmp(extension, "GL_ARB_texture_compression_rgtc") == 0) hasRGTC = true;
+		else if (strcmp(extension, "GL_ARB_texture_compression_bptc") == 0) hasBPTC = true;
+	}
+
+	if (hasS3TC) compressedFormats.insert(compressedFormats.end(), { GL_COMPRESSED_RGB_S3TC_DXT1_EXT, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT });
+	if (hasRGTC) compressedFormats.push_back(GL_COMPRESSED_RG_RGTC2);
+	if (hasBPTC) compressedFormats.push_back(GL_COMPRESSED_RGBA_BPTC_UNORM);
+
+	if (!CreateUploadRing()) LOG("Persistent pixel unpack buffers not available, textures upload from client memory");
+
 	//CREATE DEFAULT SHADER
 	if (!CreateDefaultShader())
 	{
@@ -90,6 +145,8 @@ bool Render::Awake()
 		return false;
 	}
 
+	staticBatcher = new StaticBatcher();
+
 	Engine::GetInstance().events->Subscribe(Event::Type::WindowResize, this);
 	
 	return ret;
@@ -111,11 +168,33 @@ bool Render::PostUpdate()
 {
 	bool ret = true;
 
+	Camera* camera = Engine::GetInstance().camera;
+	int windowWidth = 0, windowHeight = 0;
+	Engine::GetInstance().window->GetWindowSize(windowWidth, windowHeight);
+	screenPixelScale = camera->GetProjectionMatrix()[1][1] * windowHeight * 0.5f;
+
+	//DECODED TEXTURES GO UP BEFORE THE LISTS PICK THEIR IDS
+	TextureCache::GetInstance().Update();
+
 	for (GameObject* gameObject : Engine::GetInstance().scene->GetGameObjects())
 	{
 		BuildRenderListsRecursive(gameObject);
 	}
 
+	staticBatchList.clear();
+	if (staticBatching)
+	{
+		staticBatcher->CollectVisible(*camera->frustum, camera->GetPosition(), camera->GetProjectionMatrix()[1][1], hlod ? hlodScreenSize : 0.0f, staticBatchList);
+
+		for (const StaticBatch* batch : staticBatchList)
+		{
+			RequestTextureLevels(batch->GetTextureID(checkerTextureID), batch->bounds);
+		}
+	}
+
+	//FINER MIPS READ SINCE LAST FRAME ARE UPLOADED BEFORE DRAWING
+	TextureStreamer::GetInstance().Update();
+
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 	glClearStencil(0);
 
@@ -126,6 +205,7 @@ bool Render::PostUpdate()
 	glEnable(GL_DEPTH_TEST);
 	glDepthMask(GL_TRUE);
 	glDisable(GL_BLEND);
+	DrawStaticBatches();
 	DrawRenderList(opaqueList);
 
 	glEnable(GL_BLEND);
@@ -161,7 +241,7 @@ void Render::DrawRenderList(const std::multimap<float, RenderObject>& map)
 {
 	for (auto pair = map.rbegin(); pair != map.rend(); ++pair)
 	{
-		RenderObject renderObject = pair->second;
+		const RenderObject& renderObject = pair->second;
 
 		//STENCIL
 		if (renderObject.mesh->selected)
@@ -178,28 +258,96 @@ void Render::DrawRenderList(const std::multimap<float, RenderObject>& map)
 		glActiveTexture(GL_TEXTURE0);
 		glBindTexture(GL_TEXTURE_2D, renderObject.textToBind);
 
+		//BATCHED OBJECTS ARE ALREADY SHADED, ONLY THE OUTLINE MASK IS WRITTEN
+		if (renderObject.stencilOnly)
+		{
+			glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+			glDepthMask(GL_FALSE);
+		}
+
 		//DRAW MESH
+		const MeshData& meshData = renderObject.mesh->meshData;
+		GLenum indexType = GetGLIndexType(meshData.indexFormat);
+
 		glUniformMatrix4fv(modelMatrixLoc, 1, GL_FALSE, glm::value_ptr(renderObject.globalModelMatrix));
 		glUniform1i(hasUVsLoc, renderObject.mesh->hasUVs);
+		glUniform3fv(positionOffsetLoc, 1, glm::value_ptr(meshData.positionOffset));
+		glUniform3fv(positionScaleLoc, 1, glm::value_ptr(meshData.positionScale));
 
-		glBindVertexArray(renderObject.mesh->meshData.VAO);
-		glDrawElements(GL_TRIANGLES, renderObject.mesh->meshData.numIndices, GL_UNSIGNED_INT, 0);
+		glBindVertexArray(meshData.VAO);
+
+		if (renderObject.visibleRanges.empty())
+		{
+			glDrawElements(GL_TRIANGLES, meshData.numIndices, indexType, 0);
+		}
+		else
+		{
+			multiDrawCounts.clear();
+			multiDrawOffsets.clear();
+			for (const IndexRange& range : renderObject.visibleRanges)
+			{
+				multiDrawCounts.push_back(range.count);
+				multiDrawOffsets.push_back((const void*)(range.offset * GetIndexSize(meshData.indexFormat)));
+			}
+			glMultiDrawElements(GL_TRIANGLES, multiDrawCounts.data(), indexType, multiDrawOffsets.data(), (GLsizei)multiDrawCounts.size());
+		}
 
+		if (renderObject.stencilOnly)
+		{
+			glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+			glDepthMask(GL_TRUE);
+		}
 
 		//DRAW NORMALS
-		if (renderObject.mesh->drawNormals && renderObject.mesh->meshData.VAO != 0)
+		if (renderObject.mesh->drawNormals && meshData.VAO != 0)
 		{
 			glUseProgram(normalShaderProgram);
 			glUniformMatrix4fv(normalModelMatrixLoc, 1, GL_FALSE, glm::value_ptr(renderObject.globalModelMatrix));
-			glBindVertexArray(renderObject.mesh->meshData.VAO);
+			glUniform3fv(normalPositionOffsetLoc, 1, glm::value_ptr(meshData.positionOffset));
+			glUniform3fv(normalPositionScaleLoc, 1, glm::value_ptr(meshData.positionScale));
+			glUniform1i(normalOctNormalsLoc, meshData.vertexFormat == VertexFormat::Packed);
+			glBindVertexArray(meshData.VAO);
 
-			glDrawArrays(GL_POINTS, 0, renderObject.mesh->meshData.numVertices);
+			glDrawArrays(GL_POINTS, 0, meshData.numVertices);
 
 			glUseProgram(shaderProgram);
 		}
 	}
 }
 
+void Render::DrawStaticBatches()
+{
+	glStencilFunc(GL_ALWAYS, 0, 0xFF);
+	glStencilMask(0x00);
+	glActiveTexture(GL_TEXTURE0);
+
+	//VERTICES ARE ALREADY IN WORLD SPACE
+	glm::mat4 identity = glm::mat4(1.0f);
+	glm::vec3 zero = glm::vec3(0.0f);
+	glm::vec3 one = glm::vec3(1.0f);
+	glUniformMatrix4fv(modelMatrixLoc, 1, GL_FALSE, glm::value_ptr(identity));
+	glUniform3fv(positionOffsetLoc, 1, glm::value_ptr(zero));
+	glUniform3fv(positionScaleLoc, 1, glm::value_ptr(one));
+
+	for (const StaticBatch* batch : staticBatchList)
+	{
+		glBindTexture(GL_TEXTURE_2D, batch->GetTextureID(checkerTextureID));
+		glUniform1i(hasUVsLoc, batch->hasUVs);
+		glBindVertexArray(batch->meshData.VAO);
+		glDrawElements(GL_TRIANGLES, batch->meshData.numIndices, GetGLIndexType(batch->meshData.indexFormat), 0);
+	}
+}
+
+void Render::BuildStaticBatches(TreeNode* staticTreeRoot)
+{
+	staticBatcher->Build(staticTreeRoot, hlod ? hlodMinNodeSize : 0.0f);
+}
+
+void Render::InvalidateStaticBatch(Mesh* mesh)
+{
+	staticBatcher->Invalidate(mesh);
+}
+
 void Render::DrawLine(const glm::vec3& start, const glm::vec3& end, const glm::vec4& color)
 {
 	RenderLine line = { start, end, color };
@@ -253,8 +401,13 @@ void Render::DrawStencil()
 			glUniform4f(outlineColorLoc, 0.0f, 1.0f, 1.0f, 1.0f);
 			glUniformMatrix4fv(outlineModelMatrixLoc, 1, GL_FALSE, glm::value_ptr(globalMatrix));
 
-			glBindVertexArray(selectedMesh->stencilData.VAO);
-			glDrawElements(GL_TRIANGLES, selectedMesh->stencilData.numVertices, GL_UNSIGNED_INT, 0);
+			//NO OUTLINE WHEN IT COULDN'T BE BUILT
+			const StencilData& stencilData = selectedMesh->GetStencilData();
+			if (stencilData.VAO != 0)
+			{
+				glBindVertexArray(stencilData.VAO);
+				glDrawElements(GL_TRIANGLES, stencilData.numIndices, GL_UNSIGNED_INT, 0);
+			}
 
 			glBindVertexArray(0);
 			glUseProgram(0);
@@ -271,7 +424,15 @@ void Render::BuildRenderListsRecursive(GameObject* gameObject)
 		{
 			Mesh* mesh = (Mesh*)gameObject->GetComponent(ComponentType::Mesh);
 
-			if (mesh && mesh->enabled && mesh->meshData.VAO != 0)
+			//BATCHED STATIC MESHES ARE DRAWN WITH THEIR OCTREE NODE, ONLY THE OUTLINE AND NORMALS NEED THEM
+			bool batched = staticBatching && mesh && mesh->staticBatched;
+			if (batched && (mesh->selected || mesh->drawNormals))
+			{
+				RenderObject renderObject = { mesh, checkerTextureID, globalModelMatrix };
+				renderObject.stencilOnly = true;
+				opaqueList.emplace(0.0f, std::move(renderObject));
+			}
+			else if (!batched && mesh && mesh->enabled && mesh->meshData.VAO != 0)
 			{
 				const AABB& globalAABB = mesh->aabb->GetGlobalAABB(globalModelMatrix);
 
@@ -290,16 +451,36 @@ void Render::BuildRenderListsRecursive(GameObject* gameObject)
 
 					RenderObject renderObject = { mesh, texToBind, globalModelMatrix };
 
+					//PER CLUSTER CULLING FOR DENSE MESHES
+					bool anyClusterVisible = true;
+					if (meshletCulling && !mesh->GetMeshlets().empty())
+					{
+						Camera* camera = Engine::GetInstance().camera;
+						CullMeshlets(mesh->GetMeshlets(), *camera->frustum, globalModelMatrix, camera->GetPosition(), renderObject.visibleRanges);
+
+						if (validateMeshletCulling)
+						{
+							ValidateMeshletCulling(mesh->GetVertices(), mesh->GetIndices(), *camera->frustum, globalModelMatrix, camera->GetPosition(), renderObject.visibleRanges);
+						}
+
+						anyClusterVisible = !renderObject.visibleRanges.empty();
+					}
+
 					glm::vec3 aabbCenter = (globalAABB.min + globalAABB.max) * 0.5f;
 					float distanceToCamera = glm::distance(aabbCenter, Engine::GetInstance().camera->GetPosition());
 
-					if (texture && texture->transparent)
-					{
-						transparentList.emplace(distanceToCamera, renderObject);
-					}
-					else
+					if (anyClusterVisible)
 					{
-						opaqueList.emplace(distanceToCamera, renderObject);
+						RequestTextureLevels(texToBind, globalAABB);
+
+						if (texture && texture->transparent)
+						{
+							transparentList.emplace(distanceToCamera, std::move(renderObject));
+						}
+						else
+						{
+							opaqueList.emplace(distanceToCamera, std::move(renderObject));
+						}
 					}
 				}
 			}
@@ -313,10 +494,28 @@ void Render::BuildRenderListsRecursive(GameObject* gameObject)
 
 
 
+void Render::RequestTextureLevels(unsigned int textureID, const AABB& bounds)
+{
+	//THE TEXTURE IS ASSUMED TO SPAN THE OBJECT ONCE, ITS BOUNDING SPHERE GIVES THE SIZE ON SCREEN
+	glm::vec3 center = (bounds.min + bounds.max) * 0.5f;
+	float radius = glm::length(bounds.max - bounds.min) * 0.5f;
+	float distance = std::max(glm::distance(center, Engine::GetInstance().camera->GetPosition()), 0.001f);
+
+	TextureStreamer::GetInstance().Request(textureID, radius * 2.0f / distance * screenPixelScale);
+}
+
 bool Render::CleanUp()
 {
 	bool ret = true;
 
+	//NO READ OR DECODE MAY FINISH AFTER THE CONTEXT AND DEVIL ARE GONE
+	TextureCache::GetInstance().CleanUp();
+	TextureStreamer::GetInstance().CleanUp();
+	DestroyUploadRing();
+
+	staticBatcher->Clear();
+	delete staticBatcher;
+	staticBatcher = nullptr;
 
 	glDeleteProgram(shaderProgram);
 	glDeleteProgram(normalShaderProgram);
@@ -399,12 +598,15 @@ bool Render::CreateDefaultShader()
 		"uniform mat4 model; \n"
 		"uniform mat4 view; \n"
 		"uniform mat4 projection; \n"
+		"uniform vec3 u_positionOffset = vec3(0.0);\n"
+		"uniform vec3 u_positionScale = vec3(1.0);\n"
 		"out vec3 localPos; \n"     
 		"out vec2 texCoord; \n"     
 		"void main()\n"
 		"{\n"
-		"   gl_Position = projection * view * model * vec4(position, 1.0f);\n"
-		"   localPos = position;\n"
+		"   vec3 meshPosition = u_positionOffset + position * u_positionScale;\n"
+		"   gl_Position = projection * view * model * vec4(meshPosition, 1.0f);\n"
+		"   localPos = meshPosition;\n"
 		"   texCoord = aTexCoord;\n"
 		"}\n";
 
@@ -457,6 +659,8 @@ bool Render::CreateDefaultShader()
 	viewMatrixLoc = glGetUniformLocation(shaderProgram, "view");
 	projectionMatrixLoc = glGetUniformLocation(shaderProgram, "projection");
 	hasUVsLoc = glGetUniformLocation(shaderProgram, "u_hasUVs");
+	positionOffsetLoc = glGetUniformLocation(shaderProgram, "u_positionOffset");
+	positionScaleLoc = glGetUniformLocation(shaderProgram, "u_positionScale");
 
 	return true;
 }
@@ -467,10 +671,20 @@ bool Render::CreateNormalShader()
 	const char* vertexSource = "#version 460 core\n"
 		"layout (location = 0) in vec3 position;\n"
 		"layout (location = 2) in vec3 aNormal;\n"
+		"uniform vec3 u_positionOffset = vec3(0.0);\n"
+		"uniform vec3 u_positionScale = vec3(1.0);\n"
+		"uniform bool u_octNormals = false;\n"
 		"out VS_OUT { vec3 normal; } vs_out;\n"
+		"vec3 OctDecode(vec2 e) {\n"
+		"   vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));\n"
+		"   float t = max(-n.z, 0.0);\n"
+		"   n.x += n.x >= 0.0 ? -t : t;\n"
+		"   n.y += n.y >= 0.0 ? -t : t;\n"
+		"   return normalize(n);\n"
+		"}\n"
 		"void main() {\n"
-		"   gl_Position = vec4(position, 1.0);\n"
-		"   vs_out.normal = aNormal;\n"
+		"   gl_Position = vec4(u_positionOffset + position * u_positionScale, 1.0);\n"
+		"   vs_out.normal = u_octNormals ? OctDecode(aNormal.xy) : aNormal;\n"
 		"}\n";
 	if (!CreateShaderFromSources(vShader, GL_VERTEX_SHADER, vertexSource, strlen(vertexSource))) return false;
 
@@ -523,6 +737,9 @@ bool Render::CreateNormalShader()
 	normalModelMatrixLoc = glGetUniformLocation(normalShaderProgram, "model");
 	normalViewMatrixLoc = glGetUniformLocation(normalShaderProgram, "view");
 	normalProjectionMatrixLoc = glGetUniformLocation(normalShaderProgram, "projection");
+	normalPositionOffsetLoc = glGetUniformLocation(normalShaderProgram, "u_positionOffset");
+	normalPositionScaleLoc = glGetUniformLocation(normalShaderProgram, "u_positionScale");
+	normalOctNormalsLoc = glGetUniformLocation(normalShaderProgram, "u_octNormals");
 
 	return true;
 }
@@ -674,8 +891,7 @@ bool Render::CreateCheckerTexture()
 	return true;
 }
 
-bool Render::UploadMeshToGPU(MeshData& meshData, const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices)
-
+bool Render::UploadMeshToGPU(MeshData& meshData, const void* vertexData, const void* indexData)
 {
 	//CREATE VAO
 	glGenVertexArrays(1, &meshData.VAO);
@@ -684,78 +900,88 @@ bool Render::UploadMeshToGPU(MeshData& meshData, const std::vector<Vertex>& vert
 	//CREATE VBO
 	glGenBuffers(1, &meshData.VBO);
 	glBindBuffer(GL_ARRAY_BUFFER, meshData.VBO);
-	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
+	glBufferData(GL_ARRAY_BUFFER, meshData.numVertices * GetVertexStride(meshData.vertexFormat), vertexData, GL_STATIC_DRAW);
 
 	//CREATE EBO
 	glGenBuffers(1, &meshData.EBO);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, meshData.EBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
-
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)0);
-
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoords));
-
-	glEnableVertexAttribArray(2);
-	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, meshData.numIndices * GetIndexSize(meshData.indexFormat), indexData, GL_STATIC_DRAW);
 
+	SetupVertexAttributes(meshData.vertexFormat);
 
 	glBindVertexArray(0);
 
-	meshData.numIndices = indices.size();
-
-	LOG("Mesh uploaded to GPU. VAO: %u, VBO: %u, EBO: %u, Indices: %d",
-		meshData.VAO, meshData.VBO, meshData.EBO, meshData.numIndices);
+	LOG("Mesh uploaded to GPU. VAO: %u, VBO: %u, EBO: %u, Indices: %d, Packed: %d",
+		meshData.VAO, meshData.VBO, meshData.EBO, meshData.numIndices, meshData.vertexFormat == VertexFormat::Packed);
 
 	return true;
-
 }
 
-bool Render::UploadSmoothedMeshToGPU(unsigned int& vao, unsigned int& vbo, unsigned int& sharedEbo ,const std::vector<Vertex>& vertices)
+void Render::SetupVertexAttributes(VertexFormat format)
 {
-	glGenVertexArrays(1, &vao);
-	glBindVertexArray(vao);
-	glGenBuffers(1, &vbo);
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
+	if (format == VertexFormat::Packed)
+	{
+		//UNORM16 POSITION IN THE MESH AABB, OCTAHEDRAL SNORM16 NORMAL, HALF FLOAT UV
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, position));
 
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sharedEbo);
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(1, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, texCoords));
 
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
-	glEnableVertexAttribArray(1);
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoords));
-	glEnableVertexAttribArray(2);
-	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(2, 2, GL_SHORT, GL_TRUE, sizeof(PackedVertex), (void*)offsetof(PackedVertex, normal));
+	}
+	else
+	{
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
 
-	glBindVertexArray(0);
-	glBindBuffer(GL_ARRAY_BUFFER, 0);
-	LOG("Outline smoothed mesh upload to GPU. VAO: %u, VBO: % u", vao, vbo);
-	return true;
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, texCoords));
+
+		glEnableVertexAttribArray(2);
+		glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, normal));
+	}
 }
 
-bool Render::UploadLinesToGPU(unsigned int& vao, unsigned int& vbo, const std::vector<glm::vec3>& lines)
+GLenum Render::GetGLIndexType(IndexFormat format)
 {
-	//CREATE VAO
-	glGenVertexArrays(1, &vao);
-	glBindVertexArray(vao);
+	return format == IndexFormat::UInt16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
 
-	//CREATE VBO
-	glGenBuffers(1, &vbo);
-	glBindBuffer(GL_ARRAY_BUFFER, vbo);
-	glBufferData(GL_ARRAY_BUFFER, lines.size() * sizeof(glm::vec3), &lines[0], GL_STATIC_DRAW);
+bool Render::UploadSmoothedMeshToGPU(StencilData& stencilData, const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices)
+{
+	glGenVertexArrays(1, &stencilData.VAO);
+	glBindVertexArray(stencilData.VAO);
+	glGenBuffers(1, &stencilData.VBO);
+	glBindBuffer(GL_ARRAY_BUFFER, stencilData.VBO);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
 
-	glEnableVertexAttribArray(0);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+	glGenBuffers(1, &stencilData.EBO);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, stencilData.EBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+
+	SetupVertexAttributes(VertexFormat::Full);
 
 	glBindVertexArray(0);
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-	LOG("Lines of normals uploaded to GPU. VAO: %u, Vertices: %d", vao, lines.size());
+	stencilData.numVertices = (int)vertices.size();
+	stencilData.numIndices = (int)indices.size();
+
+	LOG("Outline smoothed mesh upload to GPU. VAO: %u, VBO: %u, Welded vertices: %d", stencilData.VAO, stencilData.VBO, stencilData.numVertices);
 	return true;
 }
 
+void Render::DeleteStencilFromGPU(StencilData& stencilData)
+{
+	LOG("Outline mesh removed from GPU. VAO: %d", stencilData.VAO);
+	if (stencilData.VBO != 0) glDeleteBuffers(1, &stencilData.VBO);
+	if (stencilData.EBO != 0) glDeleteBuffers(1, &stencilData.EBO);
+	if (stencilData.VAO != 0) glDeleteVertexArrays(1, &stencilData.VAO);
+	stencilData = StencilData();
+}
+
 void Render::DeleteMeshFromGPU(MeshData& meshData)
 {
 	LOG("Mesh removed from GPU. VAO: %d, EBO: %d, VBO: %d", meshData.VAO, meshData.EBO, meshData.VBO);
@@ -765,27 +991,256 @@ void Render::DeleteMeshFromGPU(MeshData& meshData)
 	meshData = MeshData();
 }
 
-unsigned int Render::UploadTextureToGPU(unsigned char* data, int width, int height)
+unsigned int Render::UploadTextureToGPU(const TextureFileData& texture, int baseLevel)
 {
 	unsigned int textureID = 0;
+	int numLevels = (int)texture.levels.size();
 
 	glGenTextures(1, &textureID);
 	glBindTexture(GL_TEXTURE_2D, textureID);
 
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, numLevels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
 
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+	//THE MIP CHAIN COMES PRECOMPUTED, NO glGenerateMipmap
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, numLevels - 1);
+	glBindTexture(GL_TEXTURE_2D, 0);
 
-	glGenerateMipmap(GL_TEXTURE_2D);
+	//LEVELS ABOVE baseLevel ARE LEFT FOR THE STREAMER
+	std::vector<TextureLevel> levels(texture.levels.begin() + baseLevel, texture.levels.end());
+	UploadTextureLevels(textureID, texture.format, levels, baseLevel);
+
+	LOG("Texture uploaded to GPU. ID: %u, Levels: %d of %d", textureID, numLevels - baseLevel, numLevels);
+	return textureID;
+}
 
+void Render::UploadTextureLevels(unsigned int textureID, TextureFormat format, const std::vector<TextureLevel>& levels, int firstLevel)
+{
+	GLenum compressedFormat = GetGLTextureFormat(format);
+	StagingAllocation* staging = nullptr;
+
+	glBindTexture(GL_TEXTURE_2D, textureID);
+
+	for (int i = 0; i < (int)levels.size(); i++)
+	{
+		const TextureLevel& mip = levels[i];
+
+		//LEVELS IN THE RING ARE PASSED AS BUFFER OFFSETS, THE COPY RUNS ASYNCHRONOUSLY ON THE DRIVER SIDE
+		const void* source = mip.data;
+		StagingAllocation* allocation = FindUploadStaging(mip.data);
+		if (allocation)
+		{
+			staging = allocation;
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, uploadBuffer);
+			source = reinterpret_cast<const void*>(static_cast<const uint8_t*>(mip.data) - uploadMapping);
+		}
+
+		//BLOCKS GO TO THE GPU AS THEY ARE, NO DRIVER SIDE ENCODE
+		if (compressedFormat != GL_RGBA) glCompressedTexImage2D(GL_TEXTURE_2D, firstLevel + i, compressedFormat, mip.width, mip.height, 0, (GLsizei)mip.size, source);
+		else glTexImage2D(GL_TEXTURE_2D, firstLevel + i, GL_RGBA, mip.width, mip.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, source);
+
+		if (allocation) glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+		if (validateTextureUploads) ValidateTextureLevel(textureID, format, firstLevel + i, mip);
+	}
+
+	//THE REGION IS REUSED ONCE THE GPU HAS READ IT
+	if (staging && !staging->submitted)
+	{
+		staging->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		staging->submitted = true;
+	}
+
+	//SAMPLING STARTS AT THE FINEST LEVEL NOW RESIDENT
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, firstLevel);
 	glBindTexture(GL_TEXTURE_2D, 0);
+}
 
-	LOG("Texture uploaded to GPU. ID: %u", textureID);
-	return textureID;
+void Render::ValidateTextureLevel(unsigned int textureID, TextureFormat format, int level, const TextureLevel& mip)
+{
+	//READ THE LEVEL BACK AND COMPARE IT WITH WHAT WAS SENT
+	std::vector<uint8_t> readBack(mip.size);
+
+	glFinish();
+	if (GetGLTextureFormat(format) != GL_RGBA) glGetCompressedTexImage(GL_TEXTURE_2D, level, readBack.data());
+	else glGetTexImage(GL_TEXTURE_2D, level, GL_RGBA, GL_UNSIGNED_BYTE, readBack.data());
+
+	if (memcmp(readBack.data(), mip.data, mip.size) != 0)
+	{
+		LOG("Error: Texture %u level %d doesn't match its source after upload (%s)", textureID, level, FindUploadStaging(mip.data) ? "pixel buffer" : "client memory");
+	}
+}
+
+bool Render::CreateUploadRing()
+{
+	//PERSISTENT MAPPINGS NEED GL 4.4 OR ARB_buffer_storage
+	if (!glBufferStorage || !glFenceSync) return false;
+
+	GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+	glGenBuffers(1, &uploadBuffer);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, uploadBuffer);
+	glBufferStorage(GL_PIXEL_UNPACK_BUFFER, TEXTURE_UPLOAD_RING_SIZE, nullptr, flags);
+	uploadMapping = static_cast<uint8_t*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, TEXTURE_UPLOAD_RING_SIZE, flags));
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	if (!uploadMapping)
+	{
+		glDeleteBuffers(1, &uploadBuffer);
+		uploadBuffer = 0;
+		return false;
+	}
+
+	LOG("Texture upload ring created: %llu MB", (unsigned long long)(TEXTURE_UPLOAD_RING_SIZE / (1024 * 1024)));
+	return true;
+}
+
+void Render::DestroyUploadRing()
+{
+	for (StagingAllocation& allocation : stagingAllocations)
+	{
+		if (allocation.fence) glDeleteSync(allocation.fence);
+	}
+	stagingAllocations.clear();
+
+	if (uploadBuffer != 0)
+	{
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, uploadBuffer);
+		glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		glDeleteBuffers(1, &uploadBuffer);
+	}
+
+	uploadBuffer = 0;
+	uploadMapping = nullptr;
+	uploadHead = 0;
+}
+
+void Render::RetireUploadStaging()
+{
+	//IN ALLOCATION ORDER, A REGION STILL BEING FILLED OR READ HOLDS BACK EVERYTHING AFTER IT
+	while (!stagingAllocations.empty() && stagingAllocations.front().submitted)
+	{
+		StagingAllocation& oldest = stagingAllocations.front();
+
+		if (oldest.fence)
+		{
+			GLenum status = glClientWaitSync(oldest.fence, 0, 0);
+			if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) break;
+			glDeleteSync(oldest.fence);
+		}
+
+		stagingAllocations.pop_front();
+	}
+
+	if (stagingAllocations.empty()) uploadHead = 0;
+}
+
+uint8_t* Render::AllocateUploadStaging(size_t bytes)
+{
+	if (!pboUploads || !uploadMapping || bytes == 0) return nullptr;
+
+	RetireUploadStaging();
+
+	bytes = (bytes + 63) & ~(size_t)63;
+	if (bytes > TEXTURE_UPLOAD_RING_SIZE) return nullptr;
+
+	size_t begin = uploadHead;
+
+	//THE FREE SPACE IS [head, size) + [0, tail) OR [head, tail). THE HEAD NEVER CATCHES UP WITH THE TAIL EXACTLY
+	if (stagingAllocations.empty())
+	{
+		if (begin + bytes > TEXTURE_UPLOAD_RING_SIZE) begin = 0;
+	}
+	else
+	{
+		size_t tail = stagingAllocations.front().begin;
+
+		if (begin >= tail)
+		{
+			if (begin + bytes > TEXTURE_UPLOAD_RING_SIZE)
+			{
+				if (bytes >= tail) return nullptr;
+				begin = 0;
+			}
+		}
+		else if (begin + bytes >= tail)
+		{
+			return nullptr;
+		}
+	}
+
+	StagingAllocation allocation;
+	allocation.begin = begin;
+	allocation.end = begin + bytes;
+	stagingAllocations.push_back(allocation);
+	uploadHead = allocation.end;
+
+	return uploadMapping + begin;
+}
+
+void Render::ReleaseUploadStaging(const void* staging)
+{
+	//NO-OP ONCE AN UPLOAD FENCED IT
+	StagingAllocation* allocation = FindUploadStaging(staging);
+	if (allocation) allocation->submitted = true;
+}
+
+size_t Render::GetUploadStagingBytes() const
+{
+	size_t bytes = 0;
+	for (const StagingAllocation& allocation : stagingAllocations) bytes += allocation.end - allocation.begin;
+	return bytes;
+}
+
+Render::StagingAllocation* Render::FindUploadStaging(const void* pointer)
+{
+	if (!uploadMapping || pointer < uploadMapping || pointer >= uploadMapping + TEXTURE_UPLOAD_RING_SIZE) return nullptr;
+
+	size_t offset = static_cast<const uint8_t*>(pointer) - uploadMapping;
+	for (StagingAllocation& allocation : stagingAllocations)
+	{
+		if (offset >= allocation.begin && offset < allocation.end) return &allocation;
+	}
+
+	return nullptr;
+}
+
+void Render::EvictTextureLevels(unsigned int textureID, int firstLevel, int baseLevel)
+{
+	glBindTexture(GL_TEXTURE_2D, textureID);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, baseLevel);
+
+	//A 0x0 IMAGE RELEASES THE LEVEL STORAGE, LEVELS BELOW THE BASE DON'T COUNT FOR COMPLETENESS
+	for (int level = firstLevel; level < baseLevel; level++)
+	{
+		glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	}
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+bool Render::SupportsTextureFormat(TextureFormat format) const
+{
+	GLenum glFormat = GetGLTextureFormat(format);
+	if (glFormat == GL_RGBA) return true;
+
+	return std::find(compressedFormats.begin(), compressedFormats.end(), (GLint)glFormat) != compressedFormats.end();
+}
+
+GLenum Render::GetGLTextureFormat(TextureFormat format)
+{
+	switch (format)
+	{
+	case TextureFormat::BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	case TextureFormat::BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	case TextureFormat::BC5: return GL_COMPRESSED_RG_RGTC2;
+	case TextureFormat::BC7: return GL_COMPRESSED_RGBA_BPTC_UNORM;
+	default: return GL_RGBA;
+	}
 }
 
 void Render::DeleteTextureFromGPU(unsigned int textureID)
@@ -3,24 +3,41 @@
 #include "EventListener.h"
 #include <glm/gtc/matrix_transform.hpp>
 #include "glad/glad.h"
+#include "utils/Meshlet.h"
 #include <glm/glm.hpp>
 #include <vector>
 #include <map>
+#include <deque>
 #include <string>
+#include <cstdint>
 
+class AABB;
 struct MeshData;
+struct StencilData;
+class StaticBatcher;
+struct StaticBatch;
+struct TextureFileData;
+struct TextureLevel;
+enum class TextureFormat : uint32_t;
+class TreeNode;
 struct Vertex;
+enum class VertexFormat;
+enum class IndexFormat;
 class GameObject;
 class Mesh;
 
 #define CHECKERS_WIDTH 64
 #define CHECKERS_HEIGHT 64
 
+#define TEXTURE_UPLOAD_RING_SIZE (64ull * 1024 * 1024)
+
 struct RenderObject
 {
 	Mesh* mesh;
 	unsigned int textToBind;
 	glm::mat4 globalModelMatrix;
+	std::vector<IndexRange> visibleRanges;
+	bool stencilOnly = false;
 };
 
 struct RenderLine
@@ -50,18 +67,30 @@ public:
 
 	static bool CreateShaderFromSources(unsigned int& shaderID, int type, const char* source, const int soruceLength);
 	
-	bool UploadMeshToGPU(MeshData& meshData, const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
+	bool UploadMeshToGPU(MeshData& meshData, const void* vertexData, const void* indexData);
 	void DeleteMeshFromGPU(MeshData& meshData);
 
-	bool UploadSmoothedMeshToGPU(unsigned int& vao, unsigned int& vbo, unsigned int& sharedEbo,const std::vector<Vertex>& vertices);
-	
-	bool UploadLinesToGPU(unsigned int& vao, unsigned int& vbo, const std::vector<glm::vec3>& lines);
+	bool UploadSmoothedMeshToGPU(StencilData& stencilData, const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
+	void DeleteStencilFromGPU(StencilData& stencilData);
 
-	unsigned int UploadTextureToGPU(unsigned char* data, int width, int height);
+	unsigned int UploadTextureToGPU(const TextureFileData& texture, int baseLevel = 0);
+	void UploadTextureLevels(unsigned int textureID, TextureFormat format, const std::vector<TextureLevel>& levels, int firstLevel);
+	void EvictTextureLevels(unsigned int textureID, int firstLevel, int baseLevel);
 	void DeleteTextureFromGPU(unsigned int textureID);
+	bool SupportsTextureFormat(TextureFormat format) const;
+
+	//PIXEL UNPACK RING. THE MEMORY CAN BE FILLED FROM ANY THREAD, LEVELS POINTING INTO IT ARE UPLOADED FROM THE BUFFER
+	uint8_t* AllocateUploadStaging(size_t bytes);
+	void ReleaseUploadStaging(const void* staging);
+	size_t GetUploadStagingBytes() const;
 
 	void DrawLine(const glm::vec3& start, const glm::vec3& end, const glm::vec4& color);
 
+	//STATIC BATCHING
+	void BuildStaticBatches(TreeNode* staticTreeRoot);
+	void InvalidateStaticBatch(Mesh* mesh);
+	const StaticBatcher* GetStaticBatcher() const { return staticBatcher; }
+
 	void ChangeWindowSize(int x, int y);
 
 	//INFORMATION
@@ -72,6 +101,16 @@ public:
 	//EVENTS
 	void OnEvent(const Event& event) override;
 
+public:
+	bool meshletCulling = true;
+	bool validateMeshletCulling = false;
+	bool packedVertexFormat = true;
+	bool staticBatching = true;
+	bool hlod = true;
+	float hlodMinNodeSize = 32.0f;
+	float hlodScreenSize = 0.05f;
+	bool pboUploads = true;
+	bool validateTextureUploads = false;
 
 private:
 
@@ -84,9 +123,31 @@ private:
 
 	//DRAW FUNCTIONS
 	void DrawRenderList(const std::multimap<float, RenderObject>& map);
+	void DrawStaticBatches();
 	void DrawLinesList(std::vector<RenderLine> list);
 	void DrawStencil();
 	void BuildRenderListsRecursive(GameObject* gameObject);
+	void RequestTextureLevels(unsigned int textureID, const AABB& bounds);
+
+	//VERTEX LAYOUT
+	void SetupVertexAttributes(VertexFormat format);
+	static GLenum GetGLIndexType(IndexFormat format);
+	static GLenum GetGLTextureFormat(TextureFormat format);
+
+	//TEXTURE UPLOAD RING
+	struct StagingAllocation
+	{
+		size_t begin;
+		size_t end;
+		GLsync fence = nullptr;
+		bool submitted = false;
+	};
+
+	bool CreateUploadRing();
+	void DestroyUploadRing();
+	void RetireUploadStaging();
+	StagingAllocation* FindUploadStaging(const void* pointer);
+	void ValidateTextureLevel(unsigned int textureID, TextureFormat format, int level, const TextureLevel& mip);
 
 private:
 	unsigned int shaderProgram;
@@ -98,11 +159,16 @@ private:
 	GLint modelMatrixLoc;
 	GLint viewMatrixLoc;
 	GLint projectionMatrixLoc;
+	GLint positionOffsetLoc;
+	GLint positionScaleLoc;
 
 	//NORMAL DRAW
 	GLint normalModelMatrixLoc;
 	GLint normalViewMatrixLoc;
 	GLint normalProjectionMatrixLoc;
+	GLint normalPositionOffsetLoc;
+	GLint normalPositionScaleLoc;
+	GLint normalOctNormalsLoc;
 
 	//STENCIL DRAW
 	GLint outlineModelMatrixLoc;
@@ -126,8 +192,23 @@ private:
 	std::string glslVersion;
 	std::string devilVersion;
 	std::string gpu;
+	std::vector<GLint> compressedFormats;
+
+	unsigned int uploadBuffer = 0;
+	uint8_t* uploadMapping = nullptr;
+	size_t uploadHead = 0;
+	std::deque<StagingAllocation> stagingAllocations;
 
 	std::multimap<float,RenderObject> opaqueList;
 	std::multimap<float,RenderObject> transparentList;
 	std::vector<RenderLine> linesList;
+
+	StaticBatcher* staticBatcher = nullptr;
+	std::vector<const StaticBatch*> staticBatchList;
+
+	//PROJECTION SCALE TIMES HALF THE VIEWPORT HEIGHT, FOR TEXTURE STREAMING REQUESTS
+	float screenPixelScale = 0.0f;
+
+	std::vector<GLsizei> multiDrawCounts;
+	std::vector<const void*> multiDrawOffsets;
 };
\ No newline at end of file
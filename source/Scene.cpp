@@ -2,13 +2,19 @@
 #include "GameObject.h"
 #include "EventSystem.h"
 #include "Engine.h"
+#include "Render.h"
+#include "Editor.h"
+#include "components/Mesh.h"
 
 #include "utils/Log.h"
 #include "utils/Tree.h"
 #include "utils/AABB.h"
 #include "utils/Ray.h"
+#include "utils/MeshResidency.h"
 #include <list>
 #include <cmath>
+#include <unordered_set>
+#include <unordered_map>
 
 Scene::Scene(bool startEnabled) : Module(startEnabled)
 {
@@ -32,6 +38,10 @@ bool Scene::Awake()
 
 	Engine::GetInstance().events->Subscribe(Event::Type::TransformChanged, this);
 	Engine::GetInstance().events->Subscribe(Event::Type::StaticChanged, this);
+	Engine::GetInstance().events->Subscribe(Event::Type::GameObjectEnabled, this);
+	Engine::GetInstance().events->Subscribe(Event::Type::GameObjectDisabled, this);
+	Engine::GetInstance().events->Subscribe(Event::Type::ComponentEnabled, this);
+	Engine::GetInstance().events->Subscribe(Event::Type::ComponentDisabled, this);
 
 	return ret;
 }
@@ -47,6 +57,16 @@ bool Scene::PreUpdate()
 {
 	bool ret = true;
 
+	//MOVED STATIC OBJECTS ARE DRAWN ON THEIR OWN DURING THE EDIT, NOT RE-BATCHED ON EVERY FRAME OF A DRAG
+	if (staticEditPending && !Engine::GetInstance().editor->IsEditing())
+	{
+		staticEditPending = false;
+		MarkStaticTreeDirty();
+	}
+
+	//STATIC BATCHES ARE REBUILT WITH THE STATIC TREE, BEFORE THE RENDER LISTS ARE BUILT
+	if (staticTreeDirty) RebuildTrees();
+
 	return ret;
 }
 
@@ -70,6 +90,9 @@ bool Scene::PostUpdate()
 {
 	bool ret = true;
 
+	//CPU MESH COPIES OVER BUDGET ARE DROPPED AT THE END OF THE FRAME
+	MeshResidency::GetInstance().Enforce();
+
 	return ret;
 }
 
@@ -137,9 +160,46 @@ void Scene::AddGameObject(GameObject* gameObject)
 
 	gameObject->name = newName;
 	gameObjects.push_back(gameObject);
+	MarkStaticTreeDirty();
+	MarkDinamicTreeDirty();
 	SetSelectedGameObject(gameObject);
 }
 
+void Scene::AddGameObjects(const std::vector<GameObject*>& newGameObjects)
+{
+	if (newGameObjects.empty()) return;
+
+	//SAME NAMES AS ADDING THEM ONE BY ONE, WITHOUT SCANNING THE SCENE FOR EVERY CANDIDATE
+	std::unordered_set<std::string> usedNames;
+	usedNames.reserve(gameObjects.size() + newGameObjects.size());
+	for (GameObject* existingGO : gameObjects) usedNames.insert(existingGO->name);
+
+	std::unordered_map<std::string, int> counters;
+	gameObjects.reserve(gameObjects.size() + newGameObjects.size());
+
+	for (GameObject* gameObject : newGameObjects)
+	{
+		std::string baseName = gameObject->name;
+		std::string newName = baseName;
+		int& counter = counters.emplace(baseName, 1).first->second;
+
+		while (usedNames.count(newName) > 0)
+		{
+			newName = baseName + " (" + std::to_string(counter) + ")";
+			counter++;
+		}
+
+		usedNames.insert(newName);
+		gameObject->name = newName;
+		gameObjects.push_back(gameObject);
+	}
+
+	MarkStaticTreeDirty();
+	MarkDinamicTreeDirty();
+
+	Engine::GetInstance().events->PublishImmediate(Event(Event::Type::GameObjectsCreated, newGameObjects.data(), (int)newGameObjects.size()));
+}
+
 void Scene::CollectGameObjectsRecursive(GameObject* go, std::vector<GameObject*>& list)
 {
 	list.push_back(go);
@@ -177,8 +237,17 @@ void Scene::RebuildTrees()
 	{
 		staticTree->Build(staticObjects, GetWorldLimits());
 		staticTreeDirty = false;
+		staticOctreeDirty = false;
 		LOG("Static octree rebuilt with %d objects, %d nodes",
 			staticObjects.size(), staticTree->GetNodeCount());
+
+		Engine::GetInstance().render->BuildStaticBatches(staticTree->GetRoot());
+	}
+	else if (staticOctreeDirty)
+	{
+		//PICKING SEES THE NEW PLACE, THE BATCHES WAIT FOR THE END OF THE EDIT
+		staticTree->Build(staticObjects, GetWorldLimits());
+		staticOctreeDirty = false;
 	}
 	if (dynamicTreeDirty)
 	{
@@ -232,6 +301,31 @@ AABB Scene::GetWorldLimits()
 	return mapLimits;
 }
 
+//TAKES EVERY STATIC MESH OF THE SUBTREE OUT OF ITS BATCH UNTIL THE BATCHES ARE BUILT AGAIN
+static void InvalidateStaticBatches(GameObject* gameObject)
+{
+	Mesh* mesh = (Mesh*)gameObject->GetComponent(ComponentType::Mesh);
+	if (mesh && gameObject->GetStatic()) Engine::GetInstance().render->InvalidateStaticBatch(mesh);
+
+	for (GameObject* child : gameObject->childs)
+	{
+		InvalidateStaticBatches(child);
+	}
+}
+
+//WHICH TREES HOLD THE OBJECT OR ANY OF ITS DESCENDANTS. THEY ALL MOVE WITH IT
+static void FindSubtreeTrees(GameObject* gameObject, bool& hasStatic, bool& hasDynamic)
+{
+	if (gameObject->GetStatic()) hasStatic = true;
+	else hasDynamic = true;
+
+	for (GameObject* child : gameObject->childs)
+	{
+		if (hasStatic && hasDynamic) return;
+		FindSubtreeTrees(child, hasStatic, hasDynamic);
+	}
+}
+
 void Scene::OnEvent(const Event& event)
 {
 	switch (event.type)
@@ -241,9 +335,18 @@ void Scene::OnEvent(const Event& event)
 		{
 			GameObject* gameObject = event.data.gameObject.gameObject;
 			if(!gameObject) return;
-			if (gameObject->GetStatic()) 
-				MarkStaticTreeDirty();
-			else MarkDinamicTreeDirty();
+
+			bool hasStatic = false;
+			bool hasDynamic = false;
+			FindSubtreeTrees(gameObject, hasStatic, hasDynamic);
+
+			if (hasStatic)
+			{
+				InvalidateStaticBatches(gameObject);
+				staticOctreeDirty = true;
+				staticEditPending = true;
+			}
+			if (hasDynamic) MarkDinamicTreeDirty();
 		}
 		break;
 	}
@@ -257,6 +360,28 @@ void Scene::OnEvent(const Event& event)
 		}
 		break;
 	}
+	case Event::Type::GameObjectEnabled:
+	case Event::Type::GameObjectDisabled:
+	{
+		{
+			//DISABLED OBJECTS MUST LEAVE THEIR STATIC BATCH
+			MarkStaticTreeDirty();
+		}
+		break;
+	}
+	case Event::Type::ComponentEnabled:
+	case Event::Type::ComponentDisabled:
+	{
+		{
+			//A DISABLED MESH MUST LEAVE ITS STATIC BATCH TOO
+			GameObject* gameObject = event.data.gameObject.gameObject;
+			if (!gameObject) return;
+			if (gameObject->GetStatic())
+				MarkStaticTreeDirty();
+			else MarkDinamicTreeDirty();
+		}
+		break;
+	}
 
 	default:
 		break;
@@ -33,6 +33,9 @@ public:
 	void SetSelectedGameObject(GameObject* gameObject);
 	void AddGameObject(GameObject* gameObject);
 
+	//MANY ROOTS AT ONCE: ONE NAME PASS, ONE TREE REBUILD AND ONE GameObjectsCreated EVENT. THE SELECTION DOESN'T CHANGE
+	void AddGameObjects(const std::vector<GameObject*>& newGameObjects);
+
 	//WORLD
 	AABB GetWorldLimits();
 
@@ -53,4 +56,8 @@ private:
 	Tree* dynamicTree;
 	bool staticTreeDirty;
 	bool dynamicTreeDirty;
+
+	//A STATIC OBJECT MOVED: ONLY THE OCTREE IS REBUILT UNTIL THE EDIT ENDS, THEN THE STATIC BATCHES ONCE
+	bool staticOctreeDirty = false;
+	bool staticEditPending = false;
 };
\ No newline at end of file
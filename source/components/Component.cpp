@@ -0,0 +1,11 @@
+#include "Component.h"
+
+#include "../EventSystem.h"
+#include "../Engine.h"
+
+void Component::SetEnabled(bool enabled)
+{
+    this->enabled = enabled;
+    Event::Type type = enabled ? Event::Type::ComponentEnabled : Event::Type::ComponentDisabled;
+    Engine::GetInstance().events->PublishImmediate(Event(type, owner));
+}
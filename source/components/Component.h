@@ -29,6 +29,11 @@ public:
 
     virtual void Load(pugi::xml_node componentNode) {}
 
+    virtual void SetSelected(bool selected) { this->selected = selected; }
+
+    //Publishes ComponentEnabled or ComponentDisabled, so the scene can rebuild what depends on it
+    void SetEnabled(bool enabled);
+
 public:
     GameObject* owner;
     bool enabled;
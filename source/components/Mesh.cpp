@@ -1,23 +1,24 @@
 #include "Mesh.h"
 #include "../utils/Log.h"
 #include "../utils/AABB.h"
+#include "../utils/VertexPacking.h"
+#include "../utils/VertexWeld.h"
+#include "../utils/JobSystem.h"
+#include "../utils/MeshFile.h"
+#include "../utils/MappedFile.h"
+#include "../utils/MeshResidency.h"
+#include "../utils/MeshCache.h"
+#include "../utils/ScratchArena.h"
 #include "Component.h"
 #include "../GameObject.h"
 #include <vector>
 #include <assimp/scene.h>
 #include "../Engine.h"
 #include "../Render.h"
-#include <fstream>
+#include <cstring>
 #include <cmath>
 #include <unordered_map>
-
-struct Vec3Comparator {
-    bool operator()(const glm::vec3& a, const glm::vec3& b) const {
-        if (a.x != b.x) return a.x < b.x;
-        if (a.y != b.y) return a.y < b.y;
-        return a.z < b.z;
-    }
-};
+#include <algorithm>
 
 Mesh::Mesh(GameObject* owner, bool enabled) : Component(owner, enabled)
 {
@@ -26,74 +27,255 @@ Mesh::Mesh(GameObject* owner, bool enabled) : Component(owner, enabled)
 
 Mesh::~Mesh()
 {
-	
 }
 
 void Mesh::CleanUp()
 {
-	Engine::GetInstance().render->DeleteMeshFromGPU(this->meshData);
+	if (resource)
+	{
+		ReleaseResource();
+		meshData = MeshData();
+	}
+	else Engine::GetInstance().render->DeleteMeshFromGPU(this->meshData);
+
+	ReleaseStencilData();
+}
+
+void Mesh::SetSelected(bool selected)
+{
+    Component::SetSelected(selected);
+
+    if (!selected) ReleaseStencilData();
+}
+
+const StencilData& Mesh::GetStencilData()
+{
+    if (stencilData.VAO == 0 && !stencilFailed && (!EnsureGeometryResident() || !LoadSmothedNormalsToGpu(GetVertices(), GetIndices())))
+    {
+        LOG("Error: Failed to upload outline mesh to GPU.");
+        stencilFailed = true;
+    }
+
+    return stencilData;
+}
+
+void Mesh::ReleaseStencilData()
+{
+    if (stencilData.VAO != 0) Engine::GetInstance().render->DeleteStencilFromGPU(stencilData);
 }
     
-bool Mesh::LoadModel(std::vector<Vertex> vertices, std::vector<unsigned int> indices)
+bool Mesh::LoadModel(std::vector<Vertex> vertices, std::vector<unsigned int> indices, bool compressLibrary)
 {
-    if (vertices.empty() || indices.empty()) {
-        LOG("Error: Assimp mesh read but empty vectors.");
-        return false;
+    //GPU VERTEX FORMAT, THE PACKED COPIES LIVE IN THE IMPORT SCRATCH ARENA
+    ScratchScope scratch;
+    Span<PackedVertex> packedVertices;
+    Span<uint16_t> shortIndices;
+
+    if (Engine::GetInstance().render->packedVertexFormat)
+    {
+        packedVertices = scratch.Allocate<PackedVertex>(vertices.size());
+        if (CanUseShortIndices(vertices.size())) shortIndices = scratch.Allocate<uint16_t>(indices.size());
     }
 
-    meshData.numVertices = vertices.size();
-    meshData.numIndices = indices.size();
-    this->vertices = vertices;
-    this->indices = indices;
+    MeshUpload upload;
+    upload.compressLibrary = compressLibrary;
+    if (!PrepareModel(std::move(vertices), std::move(indices), packedVertices, shortIndices, upload)) return false;
 
-    aabb = new AABB();
+    return FinishModel(upload);
+}
 
-    aabb->min = {INFINITY, INFINITY, INFINITY};
-    aabb->max = {-INFINITY, -INFINITY, -INFINITY};
+static AABB ComputeBounds(const std::vector<Vertex>& vertices)
+{
+    AABB bounds;
+    bounds.min = {INFINITY, INFINITY, INFINITY};
+    bounds.max = {-INFINITY, -INFINITY, -INFINITY};
 
     for (const Vertex& vertex : vertices)
     {
-        aabb->min.x = fmin(aabb->min.x, vertex.position.x);
-        aabb->min.y = fmin(aabb->min.y, vertex.position.y);
-        aabb->min.z = fmin(aabb->min.z, vertex.position.z);
-        aabb->max.x = fmax(aabb->max.x, vertex.position.x);
-        aabb->max.y = fmax(aabb->max.y, vertex.position.y);
-        aabb->max.z = fmax(aabb->max.z, vertex.position.z);
+        bounds.min.x = fmin(bounds.min.x, vertex.position.x);
+        bounds.min.y = fmin(bounds.min.y, vertex.position.y);
+        bounds.min.z = fmin(bounds.min.z, vertex.position.z);
+        bounds.max.x = fmax(bounds.max.x, vertex.position.x);
+        bounds.max.y = fmax(bounds.max.y, vertex.position.y);
+        bounds.max.z = fmax(bounds.max.z, vertex.position.z);
     }
 
-    if (!LoadToGpu(vertices, indices))
-    {
-        LOG("Error: Failed to upload mesh to GPU.");
+    return bounds;
+}
+
+bool Mesh::PrepareModel(std::vector<Vertex> vertices, std::vector<unsigned int> indices, Span<PackedVertex> packedVertices, Span<uint16_t> shortIndices, MeshUpload& upload)
+{
+    if (vertices.empty() || indices.empty()) {
+        LOG("Error: Assimp mesh read but empty vectors.");
         return false;
     }
 
-    if (!LoadNormalsToGpu(vertices, indices))
+    if (packedVertices.Size() != vertices.size())
+    {
+        SetGeometry(std::move(vertices), std::move(indices), nullptr);
+    }
+    else
+    {
+        //THE GPU DRAWS THE QUANTIZED VERTICES, SO THE CPU COPY IS DECODED FROM THEM TOO. PICKING, CULLING AND THE OUTLINE
+        //MATCH WHAT IS DRAWN, AND THE SAME COPY COMES BACK FROM A LIBRARY LOAD OR A PAGE-IN
+        AABB bounds = ComputeBounds(vertices);
+        PackVertices(vertices, bounds, packedVertices);
+        UnpackVertices(packedVertices.Data(), packedVertices.Size(), bounds, vertices);
+        SetGeometry(std::move(vertices), std::move(indices), &bounds);
+    }
+
+    upload.vertexData = this->vertices.data();
+    upload.indexData = this->indices.data();
+
+    if (packedVertices.Size() == this->vertices.size())
     {
-        LOG("Error: Failed to upload normals to GPU.");
+        meshData.vertexFormat = VertexFormat::Packed;
+        meshData.positionOffset = aabb->min;
+        meshData.positionScale = aabb->max - aabb->min;
+        upload.vertexData = packedVertices.Data();
+
+        if (shortIndices.Size() == this->indices.size() && CanUseShortIndices(this->vertices.size()))
+        {
+            PackIndices(this->indices, shortIndices);
+            meshData.indexFormat = IndexFormat::UInt16;
+            upload.indexData = shortIndices.Data();
+        }
     }
 
-    if (!LoadSmothedNormalsToGpu(vertices, indices))
+    upload.librarySaved = SaveToLibrary(upload.vertexData, upload.indexData, upload.compressLibrary);
+    if (!upload.librarySaved) LOG("Error: Failed saving to library.");
+
+    return true;
+}
+
+bool Mesh::FinishModel(const MeshUpload& upload)
+{
+    ReleaseStencilData();
+    ReleaseResource();
+
+    if (!UploadGeometry(upload.vertexData, upload.indexData)) return false;
+
+    if (upload.librarySaved)
+    {
+        //THE NEXT MESH LOADED FROM THE SAME FILE ONLY COPIES THE HANDLES AND READS THE SAME CPU COPY
+        resource = MeshCache::GetInstance().Create(libraryPath, contentHash, meshData, aabb->min, aabb->max, std::move(meshlets));
+        meshlets.clear();
+
+        resource->vertices = std::move(vertices);
+        resource->indices = std::move(indices);
+        resource->geometryResident = true;
+        MeshResidency::GetInstance().Register(resource);
+    }
+
+    return true;
+}
+
+bool Mesh::ShareResource(MeshResource* shared)
+{
+    if (!shared) return false;
+
+    MeshCache::GetInstance().AddReference(shared);
+
+    ReleaseStencilData();
+
+    if (resource) ReleaseResource();
+    else if (meshData.VAO != 0) Engine::GetInstance().render->DeleteMeshFromGPU(meshData);
+
+    resource = shared;
+    meshData = shared->meshData;
+    libraryPath = shared->libraryPath;
+    contentHash = shared->contentHash;
+    meshlets.clear();
+    hasUVs = true;
+
+    if (!aabb) aabb = new AABB();
+    aabb->min = shared->aabbMin;
+    aabb->max = shared->aabbMax;
+
+    std::vector<Vertex>().swap(vertices);
+    std::vector<unsigned int>().swap(indices);
+    stencilFailed = false;
+
+    return true;
+}
+
+void Mesh::ReleaseResource()
+{
+    UnloadResource(resource);
+    resource = nullptr;
+}
+
+MeshResource* Mesh::LoadResource(const std::string& path)
+{
+    Mesh loader(nullptr, true);
+
+    MeshResource* loaded = loader.LoadFromLibrary(path) ? loader.resource : nullptr;
+    MeshCache::GetInstance().AddReference(loaded);
+
+    loader.CleanUp();
+    delete loader.aabb;
+
+    return loaded;
+}
+
+void Mesh::UnloadResource(MeshResource* shared)
+{
+    if (!shared) return;
+
+    //THE RESOURCE IS DELETED WITH ITS LAST REFERENCE, ITS BUFFERS ARE FREED FROM A COPY
+    MeshData sharedData = shared->meshData;
+    if (MeshCache::GetInstance().Release(shared)) Engine::GetInstance().render->DeleteMeshFromGPU(sharedData);
+}
+
+const std::vector<Meshlet>& Mesh::GetMeshlets() const
+{
+    return resource ? resource->meshlets : meshlets;
+}
+
+void Mesh::SetGeometry(std::vector<Vertex> vertices, std::vector<unsigned int> indices, const AABB* bounds)
+{
+    meshData.numVertices = vertices.size();
+    meshData.numIndices = indices.size();
+    meshData.vertexFormat = VertexFormat::Full;
+    meshData.indexFormat = IndexFormat::UInt32;
+    meshData.positionOffset = glm::vec3(0.0f);
+    meshData.positionScale = glm::vec3(1.0f);
+    this->vertices = std::move(vertices);
+    this->indices = std::move(indices);
+    stencilFailed = false;
+
+    if (!aabb) aabb = new AABB();
+
+    *aabb = bounds ? *bounds : ComputeBounds(this->vertices);
+
+    meshlets.clear();
+    if (this->indices.size() / 3 >= MESHLET_MIN_MESH_TRIANGLES)
     {
-        LOG("Error: Failed to upload normals to GPU.");
+        BuildMeshlets(this->vertices, this->indices, meshlets);
+        LOG("Mesh split into %d meshlets", (int)meshlets.size());
     }
+}
 
-    if (!SaveToLibrary(vertices, indices))
+bool Mesh::UploadGeometry(const void* vertexData, const void* indexData)
+{
+    if (!LoadToGpu(vertexData, indexData))
     {
-        LOG("Error: Failed saving to library.");
+        LOG("Error: Failed to upload mesh to GPU.");
+        return false;
     }
 
     return true;
 }
 
-bool Mesh::LoadToGpu(std::vector<Vertex> vertices, std::vector<unsigned int> indices)
+bool Mesh::LoadToGpu(const void* vertexData, const void* indexData)
 {
-    if (vertices.empty() || indices.empty())
+    if (meshData.numVertices == 0 || meshData.numIndices == 0)
     {
         LOG("Error: Vertices or indices were empty");
         return false;
     }
 
-    bool success = Engine::GetInstance().render->UploadMeshToGPU(meshData, vertices, indices);
+    bool success = Engine::GetInstance().render->UploadMeshToGPU(meshData, vertexData, indexData);
 
     if (!success)
     {
@@ -105,138 +287,222 @@ bool Mesh::LoadToGpu(std::vector<Vertex> vertices, std::vector<unsigned int> ind
     return true;
 }
 
-bool Mesh::LoadNormalsToGpu(std::vector<Vertex> vertices, std::vector<unsigned int> indices)
+bool Mesh::LoadSmothedNormalsToGpu(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices)
+{
+    if (vertices.empty() || indices.empty()) return true;
+
+    //WELD WITH A TOLERANCE RELATIVE TO THE MESH SIZE
+    float epsilon = WELD_RELATIVE_EPSILON;
+    if (aabb) epsilon *= std::max(glm::length(aabb->max - aabb->min), 1.0f);
+
+    std::vector<unsigned int> remap;
+    std::vector<unsigned int> uniqueVertices;
+    size_t numUnique = WeldPositions(vertices, epsilon, remap, uniqueVertices);
+
+    std::vector<glm::vec3> accumulatedNormals(numUnique, glm::vec3(0.0f));
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        accumulatedNormals[remap[i]] += vertices[i].normal;
+    }
+
+    JobSystem& jobs = JobSystem::GetInstance();
+
+    std::vector<Vertex> smothedVertices(numUnique);
+    jobs.ParallelFor(numUnique, 4096, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            const Vertex& source = vertices[uniqueVertices[i]];
+            float length = glm::length(accumulatedNormals[i]);
+            smothedVertices[i] = { source.position, length > 0.0f ? accumulatedNormals[i] / length : source.normal, source.texCoords };
+        }
+    });
+
+    //THE OUTLINE ONLY NEEDS THE WELDED VERTICES, SO IT GETS ITS OWN REMAPPED INDICES
+    std::vector<unsigned int> stencilIndices(indices.size());
+    jobs.ParallelFor(indices.size(), 16384, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            stencilIndices[i] = remap[indices[i]];
+        }
+    });
+
+    return Engine::GetInstance().render->UploadSmoothedMeshToGPU(stencilData, smothedVertices, stencilIndices);
+}
+
+bool Mesh::SaveToLibrary(const void* vertexData, const void* indexData, bool compress)
 {
-    std::vector<glm::vec3> normal_lines;
-    normal_lines.reserve(vertices.size() * 2);
-    const float NORMAL_LINE_LENGTH = 0.5f;
+    libraryPath = "Library/Meshes/" + owner->name + "_" + std::to_string(owner->UUID) + ".W16Mesh";
+
+    MeshFileData fileData;
+    fileData.vertexFormat = meshData.vertexFormat;
+    fileData.indexFormat = meshData.indexFormat;
+    fileData.numVertices = meshData.numVertices;
+    fileData.numIndices = meshData.numIndices;
+    fileData.aabbMin = aabb->min;
+    fileData.aabbMax = aabb->max;
+    fileData.vertexData = vertexData;
+    fileData.indexData = indexData;
+
+    if (!WriteMeshFile(libraryPath, fileData, compress, &contentHash)) return false;
+
+    LOG("Mesh saved in Library: %s", libraryPath.c_str());
+    return true;
+}
 
-    for (const Vertex& v : vertices)
+static bool OpenLibraryFile(const std::string& path, MappedFile& file, MeshFileData& fileData, bool& isV2, bool verifyHash)
+{
+    if (!file.Open(path))
     {
-        normal_lines.push_back(v.position);
-        glm::vec3 lineEnd = v.position + (glm::normalize(v.normal) * NORMAL_LINE_LENGTH);
-        normal_lines.push_back(lineEnd);
+        LOG("Error: Could not open the .mesh file for reading: %s", path.c_str());
+        return false;
     }
 
-    if (!normal_lines.empty())
+    isV2 = IsMeshFileV2(file);
+
+    if (!(isV2 ? ReadMeshFile(file, fileData, verifyHash) : ReadMeshFileV1(file, fileData)))
     {
-        Engine::GetInstance().render->UploadLinesToGPU(
-            this->normalData.VAO,
-            this->normalData.VBO,
-            normal_lines
-        );
-        this->normalData.numVertices = normal_lines.size();
+        LOG("Error: Invalid mesh file: %s", path.c_str());
+        return false;
     }
+
+    if (fileData.numVertices == 0 || fileData.numIndices == 0)
+    {
+        LOG("Error: Mesh file has 0 vertices or indices: %s", path.c_str());
+        return false;
+    }
+
     return true;
 }
 
-bool Mesh::LoadSmothedNormalsToGpu(std::vector<Vertex> vertices, std::vector<unsigned int> indices)
+static void DecodeLibraryGeometry(const MeshFileData& fileData, std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
 {
-    std::vector<Vertex> smothedVertices;
+    AABB bounds;
+    bounds.min = fileData.aabbMin;
+    bounds.max = fileData.aabbMax;
 
-    std::map<glm::vec3, glm::vec3, Vec3Comparator> accumulatedNormals;
-    for (const Vertex& v : vertices)
+    if (fileData.vertexFormat == VertexFormat::Packed)
     {
-        accumulatedNormals[v.position] += v.normal;
+        UnpackVertices(static_cast<const PackedVertex*>(fileData.vertexData), fileData.numVertices, bounds, vertices);
     }
-    for (auto& pair : accumulatedNormals)
+    else
     {
-        pair.second = glm::normalize(pair.second);
+        const Vertex* mappedVertices = static_cast<const Vertex*>(fileData.vertexData);
+        vertices.assign(mappedVertices, mappedVertices + fileData.numVertices);
     }
 
-    smothedVertices.reserve(vertices.size());
-    for (const Vertex& v : vertices)
+    indices.resize(fileData.numIndices);
+
+    if (fileData.indexFormat == IndexFormat::UInt16)
     {
-        smothedVertices.push_back({
-            v.position,
-            accumulatedNormals[v.position],
-            v.texCoords
-            });
+        const uint16_t* mappedIndices = static_cast<const uint16_t*>(fileData.indexData);
+        std::copy(mappedIndices, mappedIndices + fileData.numIndices, indices.begin());
     }
-
-    if (!smothedVertices.empty())
+    else
     {
-        Engine::GetInstance().render->UploadSmoothedMeshToGPU(
-            stencilData.VAO,
-            stencilData.VBO,
-            meshData.EBO,
-            smothedVertices
-        );
-        stencilData.numVertices = indices.size();
+        memcpy(indices.data(), fileData.indexData, fileData.numIndices * sizeof(unsigned int));
     }
-    return true;
 }
 
-bool Mesh::SaveToLibrary(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices)
+//A LIBRARY FILE OPENED BY PrepareFromLibrary, KEPT ALIVE BY THE UPLOAD UNTIL FinishModel
+struct LibraryMapping
 {
-    libraryPath = "Library/Meshes/" + owner->name + ".W16Mesh";
-    std::ofstream file(libraryPath, std::ios::out | std::ios::binary);
+    MappedFile file;
+    MeshFileData fileData;
+};
 
-    if (!file.is_open())
-    {
-        LOG("Error: Could not open the .mesh file for writing: %s", libraryPath.c_str());
-        return false;
-    }
+bool Mesh::LoadFromLibrary(std::string path)
+{
+    //ALREADY ON THE GPU FOR ANOTHER MESH
+    if (MeshResource* shared = MeshCache::GetInstance().Find(path)) return ShareResource(shared);
 
-    uint32_t num_vertices = vertices.size();
-    uint32_t num_indices = indices.size();
+    MeshUpload upload;
+    if (!PrepareFromLibrary(path, upload)) return false;
 
-    file.write(reinterpret_cast<const char*>(&num_vertices), sizeof(uint32_t));
+    return FinishModel(upload);
+}
 
-    file.write(reinterpret_cast<const char*>(&num_indices), sizeof(uint32_t));
+bool Mesh::PrepareFromLibrary(const std::string& path, MeshUpload& upload, bool verifyHash)
+{
+    std::shared_ptr<LibraryMapping> mapping = std::make_shared<LibraryMapping>();
+    MeshFileData& fileData = mapping->fileData;
+    bool isV2 = false;
 
-    file.write(reinterpret_cast<const char*>(vertices.data()), num_vertices * sizeof(Vertex));
+    if (!OpenLibraryFile(path, mapping->file, fileData, isV2, verifyHash)) return false;
 
-    file.write(reinterpret_cast<const char*>(indices.data()), num_indices * sizeof(unsigned int));
+    //CPU COPY FOR PICKING AND CULLING
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    DecodeLibraryGeometry(fileData, vertices, indices);
 
-    file.close();
+    AABB bounds;
+    bounds.min = fileData.aabbMin;
+    bounds.max = fileData.aabbMax;
 
-    LOG("Mesh saved in Library: %s", libraryPath.c_str());
+    //V1 FULL MESHES DON'T STORE BOUNDS
+    bool hasBounds = isV2 || fileData.vertexFormat == VertexFormat::Packed;
+    SetGeometry(std::move(vertices), std::move(indices), hasBounds ? &bounds : nullptr);
+
+    meshData.vertexFormat = fileData.vertexFormat;
+    meshData.indexFormat = fileData.indexFormat;
+    if (fileData.vertexFormat == VertexFormat::Packed)
+    {
+        meshData.positionOffset = bounds.min;
+        meshData.positionScale = bounds.max - bounds.min;
+    }
+
+    //THE GPU BUFFERS ARE FILLED STRAIGHT FROM THE MAPPING
+    upload.vertexData = fileData.vertexData;
+    upload.indexData = fileData.indexData;
+    upload.librarySaved = true;
+    upload.source = mapping;
+
+    libraryPath = path;
+    contentHash = fileData.contentHash;
+
+    LOG("Mesh loaded from Library (v%d): %s", isV2 ? W16MESH_VERSION : 1, path.c_str());
     return true;
 }
 
-bool Mesh::LoadFromLibrary(std::string path)
+bool Mesh::EnsureGeometryResident()
 {
-    std::ifstream file(path, std::ios::in | std::ios::binary);
+    if (!resource) return true;
 
-    if (!file.is_open())
+    if (resource->geometryResident)
     {
-        LOG("Error: Could not open the .mesh file for reading: %s", path.c_str());
-        return false;
+        MeshResidency::GetInstance().Touch(resource);
+        return true;
     }
 
-    uint32_t num_vertices = 0;
-    uint32_t num_indices = 0;
+    MappedFile file;
+    MeshFileData fileData;
+    bool isV2 = false;
 
-    file.read(reinterpret_cast<char*>(&num_vertices), sizeof(uint32_t));
-    file.read(reinterpret_cast<char*>(&num_indices), sizeof(uint32_t));
+    //CHECKED WHEN IT WAS FIRST LOADED
+    if (!OpenLibraryFile(resource->libraryPath, file, fileData, isV2, false)) return false;
 
-    if (num_vertices == 0 || num_indices == 0)
+    if ((int)fileData.numVertices != resource->meshData.numVertices || (int)fileData.numIndices != resource->meshData.numIndices)
     {
-        LOG("Error: Mesh file has 0 vertices or indices: %s", path.c_str());
-        file.close();
+        LOG("Error: Library mesh no longer matches the GPU mesh: %s", resource->libraryPath.c_str());
         return false;
     }
 
-    std::vector<Vertex> vertices;
-    std::vector<unsigned int> indices;
-
-    vertices.resize(num_vertices);
-    indices.resize(num_indices);
-
-    file.read(reinterpret_cast<char*>(vertices.data()), num_vertices * sizeof(Vertex));
-    file.read(reinterpret_cast<char*>(indices.data()), num_indices * sizeof(unsigned int));
-    file.read(reinterpret_cast<char*>(vertices.data()), num_vertices * sizeof(Vertex));
-    file.read(reinterpret_cast<char*>(indices.data()), num_indices * sizeof(unsigned int));
-    file.close();
-
-    LOG("Mesh loaded from Library: %s", path.c_str());
-
-    LoadModel(vertices, indices);
+    DecodeLibraryGeometry(fileData, resource->vertices, resource->indices);
+    resource->geometryResident = true;
+    MeshResidency::GetInstance().Register(resource);
 
+    LOG("Mesh paged in from Library: %s", resource->libraryPath.c_str());
     return true;
 }
 
+void Mesh::EvictGeometry()
+{
+    MeshResidency::GetInstance().Evict(resource);
+}
+
+bool Mesh::IsGeometryResident() const
+{
+    return !resource || resource->geometryResident;
+}
 
 void Mesh::Save(pugi::xml_node componentNode)
 {
@@ -250,12 +516,14 @@ void Mesh::Load(pugi::xml_node componentNode)
 }
 
 
-std::vector<Vertex> Mesh::GetVertices()
+const std::vector<Vertex>& Mesh::GetVertices()
 {
-    return vertices;
+    EnsureGeometryResident();
+    return resource ? resource->vertices : vertices;
 }
 
-std::vector<unsigned int> Mesh::GetIndices()
+const std::vector<unsigned int>& Mesh::GetIndices()
 {
-    return indices;
+    EnsureGeometryResident();
+    return resource ? resource->indices : indices;
 }
\ No newline at end of file
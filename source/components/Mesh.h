@@ -1,12 +1,19 @@
 #pragma once
 #include "Component.h"
+#include "../utils/Meshlet.h"
 #include <glm/glm.hpp>
 #include <vector>
 #include <array>
 #include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "../utils/Span.h"
 
 class AABB;
 class GameObject;
+struct MeshResource;
 
 struct aiMesh;
 
@@ -24,6 +31,25 @@ struct Vertex
     glm::vec2 texCoords;
 };
 
+struct PackedVertex
+{
+    uint16_t position[4];
+    int16_t normal[2];
+    uint16_t texCoords[2];
+};
+
+enum class VertexFormat
+{
+    Full,
+    Packed
+};
+
+enum class IndexFormat
+{
+    UInt16,
+    UInt32
+};
+
 
 struct MeshData
 {
@@ -32,20 +58,34 @@ struct MeshData
     unsigned int EBO = 0;
     int numIndices = 0;
     int numVertices = 0;
+
+    VertexFormat vertexFormat = VertexFormat::Full;
+    IndexFormat indexFormat = IndexFormat::UInt32;
+    glm::vec3 positionOffset = glm::vec3(0.0f);
+    glm::vec3 positionScale = glm::vec3(1.0f);
 };
 
-struct NormalData
+//WHAT PrepareModel LEFT FOR FinishModel
+struct MeshUpload
 {
-    unsigned int VAO = 0;
-    unsigned int VBO = 0;
-    int numVertices = 0; 
+    const void* vertexData = nullptr;
+    const void* indexData = nullptr;
+    bool librarySaved = false;
+
+    //SET BY THE CALLER BEFORE PrepareModel, FROM THE LOADER SETTINGS
+    bool compressLibrary = true;
+
+    //THE LIBRARY FILE THE POINTERS GO INTO, WHEN PREPARED BY PrepareFromLibrary
+    std::shared_ptr<void> source;
 };
 
 struct StencilData
 {
     unsigned int VAO = 0;
     unsigned int VBO = 0;
+    unsigned int EBO = 0;
     int numVertices = 0;
+    int numIndices = 0;
 };
 
 
@@ -66,33 +106,82 @@ public:
     void Save(pugi::xml_node componentNode) override;
     void Load(pugi::xml_node componentNode) override;
 
-    bool SaveToLibrary(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
+    void SetSelected(bool selected) override;
+
+    bool SaveToLibrary(const void* vertexData, const void* indexData, bool compress);
     bool LoadFromLibrary(std::string path);
 
-    bool LoadModel(std::vector<Vertex> vertices, std::vector<unsigned int> indices);
+    bool LoadModel(std::vector<Vertex> vertices, std::vector<unsigned int> indices, bool compressLibrary);
+
+    //LOADMODEL IN TWO HALVES. PrepareModel NEVER TOUCHES GL OR THE RESIDENCY LIST, SO IT CAN RUN ON A WORKER: BOUNDS,
+    //MESHLETS, GPU FORMAT AND LIBRARY FILE. PACKED WHEN packedVertices IS GIVEN (ONE PER VERTEX), UINT16 INDICES WHEN
+    //shortIndices IS TOO (ONE PER INDEX). THE STORAGE MUST LIVE UNTIL FinishModel, WHICH UPLOADS ON THE GL THREAD.
+    //PACKED MESHES KEEP THE QUANTIZED VERTICES AS THEIR CPU COPY TOO, THE FULL PRECISION SOURCE ISN'T KEPT ANYWHERE
+    bool PrepareModel(std::vector<Vertex> vertices, std::vector<unsigned int> indices, Span<PackedVertex> packedVertices, Span<uint16_t> shortIndices, MeshUpload& upload);
+    bool FinishModel(const MeshUpload& upload);
+
+    //LOADFROMLIBRARY SPLIT THE SAME WAY: READ, DECODE AND MESHLETS ON A WORKER, THEN FinishModel UPLOADS FROM THE MAPPING.
+    //verifyHash ONLY WHEN THE FILE WASN'T CHECKED YET, THE HASH READS THE WHOLE FILE
+    bool PrepareFromLibrary(const std::string& path, MeshUpload& upload, bool verifyHash = true);
+
+    //USES THE GPU BUFFERS OF A FILE SOMEONE ALREADY LOADED. NO FILE ACCESS, THE CPU COPY IS PAGED IN WHEN FIRST NEEDED
+    bool ShareResource(MeshResource* shared);
+
+    const std::vector<Meshlet>& GetMeshlets() const;
 
-    std::vector<Vertex> GetVertices();
-    std::vector<unsigned int> GetIndices();
+    //A REFERENCE TO THE RESOURCE OF A LIBRARY FILE WITHOUT KEEPING A COMPONENT, LOADING IT IF NEEDED. nullptr ON ERROR
+    static MeshResource* LoadResource(const std::string& path);
+    static void UnloadResource(MeshResource* shared);
+
+    //PAGES THE GEOMETRY BACK IN FROM THE LIBRARY IF IT WAS EVICTED. VALID UNTIL THE END OF THE FRAME. FOR PACKED MESHES
+    //THESE ARE THE QUANTIZED VERTICES THE GPU DRAWS, THE SAME BEFORE AND AFTER AN EVICTION. LIBRARY MESHES READ THE
+    //COPY OF THEIR RESOURCE, SHARED WITH EVERY INSTANCE OF THE FILE
+    const std::vector<Vertex>& GetVertices();
+    const std::vector<unsigned int>& GetIndices();
+
+    bool EnsureGeometryResident();
+    //DROPS THE SHARED COPY FOR ALL THE INSTANCES. MESHES WITHOUT A RESOURCE CAN'T PAGE IT BACK IN AND KEEP THEIRS
+    void EvictGeometry();
+    bool IsGeometryResident() const;
+
+    //THE OUTLINE MESH IS ONLY BUILT WHILE THE MESH IS SELECTED
+    const StencilData& GetStencilData();
+    void ReleaseStencilData();
 
 private:
-    bool LoadToGpu(std::vector<Vertex> vertices, std::vector<unsigned int> indices);
-    bool LoadNormalsToGpu(std::vector<Vertex> vertices, std::vector<unsigned int> indices);
-    bool LoadSmothedNormalsToGpu(std::vector<Vertex> vertices, std::vector<unsigned int> indices);
+    void SetGeometry(std::vector<Vertex> vertices, std::vector<unsigned int> indices, const AABB* bounds);
+    bool UploadGeometry(const void* vertexData, const void* indexData);
+    bool LoadToGpu(const void* vertexData, const void* indexData);
+    bool LoadSmothedNormalsToGpu(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices);
+
+    //THE GPU BUFFERS ARE ONLY FREED BY THE LAST MESH USING THEM
+    void ReleaseResource();
 
 
 public:
     MeshData meshData;
-    NormalData normalData;
     StencilData stencilData;
     AABB* aabb;
+    std::vector<Meshlet> meshlets;
 
     bool hasUVs = false;
     bool drawNormals = false;
     bool drawStencil = false;
+    bool staticBatched = false;
 
     std::string libraryPath;
 
+    //OF THE LIBRARY FILE, CHANGES WHEN THE FILE IS WRITTEN AGAIN WITH OTHER GEOMETRY. 0 FOR OLD V1 FILES
+    uint64_t contentHash = 0;
+
+    //SET FOR MESHES LOADED FROM A LIBRARY FILE, meshData AND THE BOUNDS ARE COPIES OF ITS OWN
+    MeshResource* resource = nullptr;
+
 private:
+    //ONLY FOR MESHES WITHOUT A RESOURCE, AND UNTIL FinishModel HANDS THEM TO THE ONE IT CREATES
     std::vector<Vertex> vertices;
     std::vector<unsigned int> indices;
+
+    //THE OUTLINE COULDN'T BE BUILT FROM THIS GEOMETRY, NOT RETRIED UNTIL IT CHANGES
+    bool stencilFailed = false;
 };
\ No newline at end of file
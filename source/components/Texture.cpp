@@ -5,7 +5,7 @@
 #include <assimp/scene.h>
 #include "../Engine.h"
 #include "../Render.h"
-#include <IL/il.h>
+#include "../utils/TextureCache.h"
 
 Texture::Texture(GameObject* owner, bool enabled) : Component(owner, enabled)
 {
@@ -19,13 +19,9 @@ Texture::~Texture()
 
 void Texture::CleanUp()
 {
-    if (textureID != 0)
-    {
-        Engine::GetInstance().render->DeleteTextureFromGPU(textureID);
-        textureID = 0;
-    }
-
-    UnloadFromCPU();
+    //SHARED TEXTURES ARE ONLY FREED BY THEIR LAST USER
+    TextureCache::GetInstance().Release(resource);
+    resource = nullptr;
 }
 
 void Texture::Save(pugi::xml_node componentNode)
@@ -46,67 +42,44 @@ void Texture::Load(pugi::xml_node componentNode)
 
 bool Texture::LoadTexture(const std::string& path)
 {
-    bool ret = true;
-
     this->path = path;
 
-    ilGenImages(1, &ilImageID);
-    ilBindImage(ilImageID);
-
-    if (ilLoadImage(path.c_str()))
-    {
-        if (!ilConvertImage(IL_RGBA, IL_UNSIGNED_BYTE))
-        {
-            LOG("Error converting image to RGBA: %s", path.c_str());
-            ilDeleteImages(1, &ilImageID);
-            return false;
-        }
-
-        width = ilGetInteger(IL_IMAGE_WIDTH);
-        height = ilGetInteger(IL_IMAGE_HEIGHT);
+    //TRANSPARENT TEXTURES KEEP THEIR ALPHA WHEN BLOCK COMPRESSED
+    const TextureResource* newResource = TextureCache::GetInstance().Acquire(path, transparent ? TextureUsage::ColorAlpha : TextureUsage::Color);
+    if (!newResource) return false;
 
-        LOG("Texture loaded into CPU from: %s (Width: %d, Height: %d)", path.c_str(), width, height);
+    //THE OLD IMAGE IS RELEASED AFTER THE NEW ONE IS ACQUIRED, SO RELOADING THE SAME FILE DOESN'T UPLOAD IT AGAIN
+    TextureCache::GetInstance().Release(resource);
+    resource = newResource;
 
-        UploadToGPU();
-        return true;
-    }
-    else
-    {
-        ilDeleteImages(1, &ilImageID);
-        return false;
-    }
-
-  
-    return ret;
+    return true;
 }
 
-void Texture::UploadToGPU()
+void Texture::ShareTexture(const std::string& path, const TextureResource* shared)
 {
-    if (ilImageID == 0)
-    {
-        LOG("Error: An attempt was made to upload a texture to the GPU without first loading it to the CPU.");
-        return;
-    }
+    this->path = path;
 
-    ilBindImage(ilImageID);
-    unsigned char* data = ilGetData();
+    const TextureResource* newResource = TextureCache::GetInstance().AddReference(shared);
+    TextureCache::GetInstance().Release(resource);
+    resource = newResource;
+}
 
-    textureID = Engine::GetInstance().render->UploadTextureToGPU(
-        data,
-        width,
-        height
-    );
+unsigned int Texture::GetTextureID() const
+{
+    return resource ? resource->textureID : 0;
+}
 
-    ilBindImage(0);
+int Texture::GetWidth() const
+{
+    return resource ? resource->width : 0;
+}
 
-    UnloadFromCPU();
+int Texture::GetHeight() const
+{
+    return resource ? resource->height : 0;
 }
 
-void Texture::UnloadFromCPU()
+bool Texture::IsLoading() const
 {
-    if (ilImageID != 0)
-    {
-        ilDeleteImages(1, &ilImageID);
-        ilImageID = 0;
-    }
-}
\ No newline at end of file
+    return resource && resource->loading;
+}
@@ -3,6 +3,7 @@
 #include <string>
 
 struct aiMaterial;
+struct TextureResource;
 
 class Texture : public Component
 {
@@ -21,21 +22,21 @@ public:
     void Save(pugi::xml_node componentNode) override;
     void Load(pugi::xml_node componentNode) override;
 
+    //Returns false if the file doesn't exist. The image itself is decoded in the background, the checker is drawn until then.
     bool LoadTexture(const std::string& path);
 
-    void UploadToGPU();
+    //Uses a resource someone else already acquired for the same path, no file access.
+    void ShareTexture(const std::string& path, const TextureResource* shared);
 
-    void UnloadFromCPU();
-
-    unsigned int GetTextureID() const { return textureID; }
+    unsigned int GetTextureID() const;
+    int GetWidth() const;
+    int GetHeight() const;
+    bool IsLoading() const;
 
 public:
 
     std::string path;
-    unsigned int textureID = 0;
-    unsigned int ilImageID = 0;
-    int width = 0;
-    int height = 0;
+    const TextureResource* resource = nullptr;
     bool use_checker = false;
     bool transparent = false;
 };
\ No newline at end of file
@@ -198,6 +198,15 @@ void Transform::SetScale(glm::vec3 _scale)
     OnTransformChanged();
 }
 
+void Transform::SetLocalTransform(glm::vec3 _position, glm::quat _rotation, glm::vec3 _scale)
+{
+    dirtyLocalMatrix = true;
+    position = _position;
+    rotation = _rotation;
+    scale = _scale;
+    InvalidateGlobalMatrix();
+}
+
 void Transform::OnTransformChanged()
 {
     InvalidateGlobalMatrix();
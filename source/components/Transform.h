@@ -27,6 +27,9 @@ public:
     void SetPosition(glm::vec3 _position);
     void SetScale(glm::vec3 _position);
 
+    //All at once and without TransformChanged, for objects that aren't in the scene yet
+    void SetLocalTransform(glm::vec3 _position, glm::quat _rotation, glm::vec3 _scale);
+
     void OnTransformChanged();
 
     glm::vec3 GetPosition();
@@ -0,0 +1,965 @@
+#include "../components/Mesh.h"
+#include "../utils/Meshlet.h"
+#include "../utils/Frustum.h"
+#include "../utils/VertexWeld.h"
+#include "../utils/VertexPacking.h"
+#include "../utils/MeshCodec.h"
+#include "../utils/AABB.h"
+#include "../utils/BlockCompression.h"
+#include "../utils/AssimpMesh.h"
+#include "../utils/AllocationCounter.h"
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+//Headless checks of engine code that can't be verified in the editor alone, without windows or GL. Each check prints
+//what it covered and the process fails if any of them finds a mismatch. With no arguments every check runs.
+//
+//  w16check [meshlets] [weld] [codec] [blocks] [allocations] [--model <path>]
+
+#define CHECK_CAMERAS_PER_MESH 64
+#define CHECK_CODEC_REPEATS 8
+
+//HEAP ALLOCATIONS ACCEPTED PER STREAM OF AN IMPORTED MESH, FROM CONVERSION TO THE COMPONENT
+#define CHECK_MAX_STREAM_ALLOCATIONS 1
+
+//LOWEST PSNR ACCEPTED ON ANY TEST IMAGE, OVER THE CHANNELS THE FORMAT STORES
+#define BLOCK_CHECK_MIN_PSNR_BC1 28.0
+#define BLOCK_CHECK_MIN_PSNR_BC3 29.0
+#define BLOCK_CHECK_MIN_PSNR_BC5 35.0
+#define BLOCK_CHECK_MIN_PSNR_BC7 33.0
+
+//MODEL FILES GIVEN WITH --model
+static std::vector<std::string> modelPaths;
+
+static void PrintUsage()
+{
+    printf("usage: w16check [meshlets] [weld] [codec] [blocks] [allocations] [--model <path>]\n");
+    printf("  meshlets        cluster culling against brute force per triangle culling\n");
+    printf("  weld            parallel vertex welding against brute force welding\n");
+    printf("  codec           library mesh codec round trips and throughput\n");
+    printf("  blocks          BC1/BC3/BC5/BC7 compression against the source image, decoded here\n");
+    printf("  allocations     heap allocations per mesh stream of an editor import, at most one each\n");
+    printf("  --model <path>  also run the meshlets, codec and allocations checks on every mesh of a model file\n");
+}
+
+//GENERATED MESHES
+
+struct TestMesh
+{
+    std::string name;
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+};
+
+static void MakeSphere(int rings, int segments, std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+    for (int r = 0; r <= rings; r++)
+    {
+        float phi = glm::pi<float>() * r / rings;
+
+        for (int s = 0; s <= segments; s++)
+        {
+            float theta = glm::two_pi<float>() * s / segments;
+            glm::vec3 normal = glm::vec3(std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta));
+            vertices.push_back({ normal, normal, glm::vec2((float)s / segments, (float)r / rings) });
+        }
+    }
+
+    for (int r = 0; r < rings; r++)
+    {
+        for (int s = 0; s < segments; s++)
+        {
+            unsigned int a = r * (segments + 1) + s;
+            unsigned int b = a + segments + 1;
+            indices.insert(indices.end(), { a, a + 1, b, b, a + 1, b + 1 });
+        }
+    }
+}
+
+static void MakeTerrain(int size, std::mt19937& random, std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+    std::uniform_real_distribution<float> height(-0.05f, 0.05f);
+
+    for (int z = 0; z <= size; z++)
+    {
+        for (int x = 0; x <= size; x++)
+        {
+            glm::vec3 position = glm::vec3((float)x / size - 0.5f, height(random), (float)z / size - 0.5f);
+            vertices.push_back({ position, glm::vec3(0.0f, 1.0f, 0.0f), glm::vec2((float)x / size, (float)z / size) });
+        }
+    }
+
+    for (int z = 0; z < size; z++)
+    {
+        for (int x = 0; x < size; x++)
+        {
+            unsigned int a = z * (size + 1) + x;
+            unsigned int b = a + size + 1;
+            indices.insert(indices.end(), { a, b, a + 1, a + 1, b, b + 1 });
+        }
+    }
+}
+
+//UNRELATED TRIANGLES, SO CLUSTERS ARE LARGE AND THEIR CONES DISABLED
+static void MakeSoup(int numTriangles, std::mt19937& random, std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+    std::uniform_real_distribution<float> position(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> offset(-0.05f, 0.05f);
+
+    for (int t = 0; t < numTriangles; t++)
+    {
+        glm::vec3 center = glm::vec3(position(random), position(random), position(random));
+
+        for (int i = 0; i < 3; i++)
+        {
+            glm::vec3 corner = center + glm::vec3(offset(random), offset(random), offset(random));
+            indices.push_back((unsigned int)vertices.size());
+            vertices.push_back({ corner, glm::vec3(0.0f, 1.0f, 0.0f), glm::vec2(0.0f) });
+        }
+    }
+}
+
+static void MakeTestMeshes(std::mt19937& random, std::vector<TestMesh>& meshes)
+{
+    meshes.resize(3);
+
+    meshes[0].name = "sphere";
+    MakeSphere(96, 192, meshes[0].vertices, meshes[0].indices);
+    meshes[1].name = "terrain";
+    MakeTerrain(160, random, meshes[1].vertices, meshes[1].indices);
+    meshes[2].name = "soup";
+    MakeSoup(20000, random, meshes[2].vertices, meshes[2].indices);
+}
+
+//EVERY MESH OF THE MODEL, TRIANGULATED AND WITH ITS DUPLICATED VERTICES JOINED LIKE AN EDITOR IMPORT
+static bool ReadModelMeshes(const std::string& path, std::vector<TestMesh>& meshes)
+{
+    Assimp::Importer importer;
+    const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_GenNormals);
+
+    if (!scene)
+    {
+        printf("\nw16check: could not read %s: %s\n", path.c_str(), importer.GetErrorString());
+        return false;
+    }
+
+    for (unsigned int m = 0; m < scene->mNumMeshes; m++)
+    {
+        const aiMesh* assimpMesh = scene->mMeshes[m];
+        if (assimpMesh->mNumVertices == 0 || assimpMesh->mNumFaces == 0) continue;
+
+        TestMesh mesh;
+        mesh.name = assimpMesh->mName.length > 0 ? assimpMesh->mName.C_Str() : "mesh" + std::to_string(m);
+
+        for (unsigned int i = 0; i < assimpMesh->mNumVertices; i++)
+        {
+            const aiVector3D& position = assimpMesh->mVertices[i];
+            const aiVector3D& normal = assimpMesh->mNormals[i];
+            glm::vec2 texCoords = assimpMesh->HasTextureCoords(0) ? glm::vec2(assimpMesh->mTextureCoords[0][i].x, assimpMesh->mTextureCoords[0][i].y) : glm::vec2(0.0f);
+            mesh.vertices.push_back({ glm::vec3(position.x, position.y, position.z), glm::vec3(normal.x, normal.y, normal.z), texCoords });
+        }
+
+        for (unsigned int f = 0; f < assimpMesh->mNumFaces; f++)
+        {
+            const aiFace& face = assimpMesh->mFaces[f];
+            if (face.mNumIndices == 3) mesh.indices.insert(mesh.indices.end(), face.mIndices, face.mIndices + 3);
+        }
+
+        if (!mesh.indices.empty()) meshes.push_back(std::move(mesh));
+    }
+
+    return true;
+}
+
+//CHECKS
+
+static bool CheckMeshlets()
+{
+    std::mt19937 random(16);
+    std::vector<TestMesh> meshes;
+    MakeTestMeshes(random, meshes);
+
+    bool modelsRead = true;
+    for (const std::string& path : modelPaths) modelsRead &= ReadModelMeshes(path, meshes);
+
+    //IDENTITY, ROTATED AND SCALED, NON UNIFORM, AND MIRRORED, WHICH DISABLES CONE CULLING
+    glm::mat4 rotated = glm::scale(glm::rotate(glm::translate(glm::mat4(1.0f), glm::vec3(0.5f, -0.25f, 1.0f)), 0.7f, glm::normalize(glm::vec3(1.0f, 2.0f, 0.5f))), glm::vec3(2.0f));
+    glm::mat4 transforms[] = {
+        glm::mat4(1.0f),
+        rotated,
+        glm::scale(glm::mat4(1.0f), glm::vec3(3.0f, 0.5f, 1.5f)),
+        glm::scale(glm::mat4(1.0f), glm::vec3(-1.0f, 1.0f, 1.0f))
+    };
+
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> distance(0.2f, 6.0f);
+    glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+
+    int failures = 0;
+
+    for (const TestMesh& mesh : meshes)
+    {
+        std::vector<Meshlet> meshlets;
+        BuildMeshlets(mesh.vertices, mesh.indices, meshlets);
+
+        size_t totalIndices = 0;
+        size_t keptIndices = 0;
+        int meshFailures = 0;
+
+        for (const glm::mat4& model : transforms)
+        {
+            for (int c = 0; c < CHECK_CAMERAS_PER_MESH; c++)
+            {
+                //AROUND THE MESH, SOME CAMERAS INSIDE IT, LOOKING AT A POINT NEAR ITS CENTER
+                glm::vec3 direction = glm::vec3(unit(random), unit(random), unit(random));
+                if (glm::length(direction) < 0.01f) direction = glm::vec3(0.0f, 0.0f, 1.0f);
+
+                glm::vec3 center = glm::vec3(model * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+                glm::vec3 eye = center + glm::normalize(direction) * distance(random);
+                glm::vec3 target = center + glm::vec3(unit(random), unit(random), unit(random)) * 0.75f;
+                glm::vec3 up = std::abs(glm::normalize(target - eye).y) > 0.99f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+
+                Frustum frustum;
+                frustum.Update(projection * glm::lookAt(eye, target, up));
+
+                std::vector<IndexRange> ranges;
+                CullMeshlets(meshlets, frustum, model, eye, ranges);
+
+                if (!ValidateMeshletCulling(mesh.vertices, mesh.indices, frustum, model, eye, ranges)) meshFailures++;
+
+                totalIndices += mesh.indices.size();
+                for (const IndexRange& range : ranges) keptIndices += range.count;
+            }
+        }
+
+        printf("\nmeshlets: %-8s %6d triangles, %4d meshlets, %.1f%% of the triangles drawn, %d failures\n", mesh.name.c_str(), (int)(mesh.indices.size() / 3), (int)meshlets.size(), 100.0 * keptIndices / totalIndices, meshFailures);
+        failures += meshFailures;
+    }
+
+    return failures == 0 && modelsRead;
+}
+
+//VERTEX WELDING
+
+//Same rule as WeldPositions, every vertex points at the lowest vertex within epsilon, but comparing every pair
+static void BruteForceWeld(const std::vector<Vertex>& vertices, float epsilon, std::vector<unsigned int>& remap)
+{
+    std::vector<unsigned int> representative(vertices.size());
+
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        representative[i] = (unsigned int)i;
+        for (size_t j = 0; j < i; j++)
+        {
+            glm::vec3 delta = vertices[j].position - vertices[i].position;
+            if (glm::dot(delta, delta) <= epsilon * epsilon)
+            {
+                representative[i] = (unsigned int)j;
+                break;
+            }
+        }
+    }
+
+    std::vector<unsigned int> compactId(vertices.size(), 0);
+    unsigned int numUnique = 0;
+    remap.resize(vertices.size());
+
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        unsigned int root = representative[i];
+        while (representative[root] != root) root = representative[root];
+        if (root == i) compactId[i] = numUnique++;
+        remap[i] = compactId[root];
+    }
+}
+
+static bool CheckWeld()
+{
+    struct WeldCase {
+        const char* name;
+        std::vector<Vertex> vertices;
+        float epsilon;
+    };
+
+    std::mt19937 random(16);
+    std::vector<unsigned int> unusedIndices;
+    WeldCase cases[3] = { { "sphere", {}, 1e-4f }, { "clusters", {}, 0.01f }, { "stacked", {}, 0.01f } };
+
+    //UV SEAMS AND POLES, BIT IDENTICAL DUPLICATES
+    MakeSphere(48, 96, cases[0].vertices, unusedIndices);
+
+    //MANY VERTICES PER CELL, SOME OF THEM FURTHER THAN EPSILON FROM THE LOWEST ONE OF THE CELL
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    for (int c = 0; c < 400; c++)
+    {
+        glm::vec3 center = glm::vec3(unit(random), unit(random), unit(random));
+        for (int v = 0; v < 12; v++)
+        {
+            glm::vec3 jitter = glm::vec3(unit(random), unit(random), unit(random)) * cases[1].epsilon * 1.5f;
+            cases[1].vertices.push_back({ center + jitter, glm::vec3(0.0f, 1.0f, 0.0f), glm::vec2(0.0f) });
+        }
+    }
+
+    //THE SAME POSITIONS REPEATED IN A SHUFFLED ORDER
+    for (int r = 0; r < 8; r++)
+    {
+        std::vector<Vertex> copy = cases[1].vertices;
+        std::shuffle(copy.begin(), copy.end(), random);
+        cases[2].vertices.insert(cases[2].vertices.end(), copy.begin(), copy.begin() + 600);
+    }
+
+    int failures = 0;
+
+    for (const WeldCase& weldCase : cases)
+    {
+        std::vector<unsigned int> remap;
+        std::vector<unsigned int> uniqueVertices;
+        size_t numUnique = WeldPositions(weldCase.vertices, weldCase.epsilon, remap, uniqueVertices);
+
+        std::vector<unsigned int> expected;
+        BruteForceWeld(weldCase.vertices, weldCase.epsilon, expected);
+
+        int mismatches = 0;
+        for (size_t i = 0; i < remap.size(); i++)
+        {
+            if (remap[i] != expected[i]) mismatches++;
+        }
+
+        printf("\nweld: %-8s %6d vertices, %6d unique, %d mismatches\n", weldCase.name, (int)weldCase.vertices.size(), (int)numUnique, mismatches);
+        if (mismatches > 0) failures++;
+    }
+
+    return failures == 0;
+}
+
+//LIBRARY MESH CODEC
+
+struct CodecStats
+{
+    size_t rawBytes = 0;
+    size_t encodedBytes = 0;
+    double encodeSeconds = 0.0;
+    double decodeSeconds = 0.0;
+};
+
+static double SecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+//Encodes and decodes the stream, the decoded copy must be byte identical. A truncated stream must be rejected
+static bool RoundTripStream(const void* data, size_t count, size_t elementSize, bool indices, CodecStats& stats)
+{
+    std::vector<uint8_t> encoded;
+    std::vector<uint8_t> decoded(count * elementSize);
+    bool decodedOk = true;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < CHECK_CODEC_REPEATS; r++)
+    {
+        if (indices) EncodeIndexStream(data, count, elementSize, encoded);
+        else EncodeVertexStream(data, count, elementSize, encoded);
+    }
+    stats.encodeSeconds += SecondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < CHECK_CODEC_REPEATS; r++)
+    {
+        if (indices) decodedOk &= DecodeIndexStream(encoded.data(), encoded.size(), count, elementSize, decoded.data());
+        else decodedOk &= DecodeVertexStream(encoded.data(), encoded.size(), count, elementSize, decoded.data());
+    }
+    stats.decodeSeconds += SecondsSince(start);
+
+    stats.rawBytes += count * elementSize * CHECK_CODEC_REPEATS;
+    stats.encodedBytes += encoded.size() * CHECK_CODEC_REPEATS;
+
+    if (!decodedOk || (count > 0 && memcmp(decoded.data(), data, decoded.size()) != 0)) return false;
+
+    if (encoded.empty()) return true;
+
+    bool truncatedOk = indices ? DecodeIndexStream(encoded.data(), encoded.size() - 1, count, elementSize, decoded.data())
+                               : DecodeVertexStream(encoded.data(), encoded.size() - 1, count, elementSize, decoded.data());
+    return !truncatedOk;
+}
+
+static bool RoundTripLZ(const std::vector<uint8_t>& input)
+{
+    std::vector<uint8_t> compressed(GetCompressLZBound(input.size()));
+    size_t compressedSize = CompressLZ(input.data(), input.size(), compressed.data());
+    if (compressedSize > compressed.size()) return false;
+
+    std::vector<uint8_t> decompressed(input.size());
+    if (!DecompressLZ(compressed.data(), compressedSize, decompressed.data(), decompressed.size())) return false;
+
+    return decompressed == input;
+}
+
+static bool CheckCodec()
+{
+    std::mt19937 random(16);
+    std::vector<TestMesh> meshes;
+    MakeTestMeshes(random, meshes);
+
+    bool modelsRead = true;
+    for (const std::string& path : modelPaths) modelsRead &= ReadModelMeshes(path, meshes);
+
+    //ONE ELEMENT PAST A CHUNK
+    TestMesh edges;
+    edges.name = "edges";
+    MakeSoup(MESH_CODEC_VERTEX_CHUNK / 3 + 1, random, edges.vertices, edges.indices);
+    edges.vertices.resize(MESH_CODEC_VERTEX_CHUNK + 1);
+    edges.indices.resize(MESH_CODEC_INDEX_CHUNK + 1, 0);
+    meshes.push_back(std::move(edges));
+
+    int failures = 0;
+    CodecStats vertexStats;
+    CodecStats indexStats;
+
+    //EMPTY STREAMS
+    failures += !RoundTripStream(nullptr, 0, sizeof(Vertex), false, vertexStats);
+    failures += !RoundTripStream(nullptr, 0, sizeof(unsigned int), true, indexStats);
+
+    for (const TestMesh& mesh : meshes)
+    {
+        AABB bounds;
+        bounds.min = glm::vec3(INFINITY);
+        bounds.max = glm::vec3(-INFINITY);
+        for (const Vertex& vertex : mesh.vertices)
+        {
+            bounds.min = glm::min(bounds.min, vertex.position);
+            bounds.max = glm::max(bounds.max, vertex.position);
+        }
+
+        std::vector<PackedVertex> packed(mesh.vertices.size());
+        PackVertices(mesh.vertices, bounds, packed);
+
+        int meshFailures = 0;
+        meshFailures += !RoundTripStream(mesh.vertices.data(), mesh.vertices.size(), sizeof(Vertex), false, vertexStats);
+        meshFailures += !RoundTripStream(packed.data(), packed.size(), sizeof(PackedVertex), false, vertexStats);
+        meshFailures += !RoundTripStream(mesh.indices.data(), mesh.indices.size(), sizeof(unsigned int), true, indexStats);
+
+        if (CanUseShortIndices(mesh.vertices.size()))
+        {
+            std::vector<uint16_t> shortIndices(mesh.indices.size());
+            PackIndices(mesh.indices, shortIndices);
+            meshFailures += !RoundTripStream(shortIndices.data(), shortIndices.size(), sizeof(uint16_t), true, indexStats);
+        }
+
+        printf("\ncodec: %-12s %7d vertices, %7d indices, %d failures\n", mesh.name.c_str(), (int)mesh.vertices.size(), (int)mesh.indices.size(), meshFailures);
+        failures += meshFailures;
+    }
+
+    //THE RAW LZ STAGE: NOTHING, ONE BYTE, INCOMPRESSIBLE, ALL ZEROS AND A SHORT REPEATING PATTERN
+    std::vector<std::vector<uint8_t>> buffers(5);
+    buffers[1].push_back(0x16);
+    buffers[2].resize(100000);
+    for (uint8_t& byte : buffers[2]) byte = (uint8_t)random();
+    buffers[3].assign(1 << 20, 0);
+    for (int i = 0; i < 100000; i++) buffers[4].push_back((uint8_t)"W16Engine"[i % 9]);
+
+    int lzFailures = 0;
+    for (const std::vector<uint8_t>& buffer : buffers) lzFailures += !RoundTripLZ(buffer);
+
+    printf("\ncodec: lz           %d buffers, %d failures\n", (int)buffers.size(), lzFailures);
+    failures += lzFailures;
+
+    printf("\ncodec: vertices %.1f%% of the raw size, encode %.0f MB/s, decode %.0f MB/s\n", 100.0 * vertexStats.encodedBytes / vertexStats.rawBytes,
+        vertexStats.rawBytes / (1024.0 * 1024.0) / vertexStats.encodeSeconds, vertexStats.rawBytes / (1024.0 * 1024.0) / vertexStats.decodeSeconds);
+    printf("\ncodec: indices  %.1f%% of the raw size, encode %.0f MB/s, decode %.0f MB/s\n", 100.0 * indexStats.encodedBytes / indexStats.rawBytes,
+        indexStats.rawBytes / (1024.0 * 1024.0) / indexStats.encodeSeconds, indexStats.rawBytes / (1024.0 * 1024.0) / indexStats.decodeSeconds);
+
+    return failures == 0 && modelsRead;
+}
+
+//BLOCK COMPRESSION. REFERENCE DECODERS WRITTEN FROM THE FORMAT SPECS, NOT FROM THE ENCODER
+
+static void Decode565(uint16_t color, int* out)
+{
+    int r = (color >> 11) & 31;
+    int g = (color >> 5) & 63;
+    int b = color & 31;
+    out[0] = (r << 3) | (r >> 2);
+    out[1] = (g << 2) | (g >> 4);
+    out[2] = (b << 3) | (b >> 2);
+    out[3] = 255;
+}
+
+//Colour block of BC1, and of BC3 where it is always in four colour mode
+static void DecodeBC1(const uint8_t* block, bool alwaysFourColors, uint8_t texels[16][4])
+{
+    uint16_t color0 = (uint16_t)(block[0] | (block[1] << 8));
+    uint16_t color1 = (uint16_t)(block[2] | (block[3] << 8));
+
+    int palette[4][4];
+    Decode565(color0, palette[0]);
+    Decode565(color1, palette[1]);
+
+    bool fourColors = alwaysFourColors || color0 > color1;
+    for (int c = 0; c < 4; c++)
+    {
+        if (fourColors)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        else
+        {
+            //THREE COLOURS AND TRANSPARENT BLACK
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+    }
+
+    uint32_t indices = block[4] | (block[5] << 8) | (block[6] << 16) | ((uint32_t)block[7] << 24);
+    for (int i = 0; i < 16; i++)
+    {
+        int index = (indices >> (i * 2)) & 3;
+        for (int c = 0; c < 4; c++) texels[i][c] = (uint8_t)palette[index][c];
+    }
+}
+
+static void DecodeBC4(const uint8_t* block, int channel, uint8_t texels[16][4])
+{
+    int a0 = block[0];
+    int a1 = block[1];
+
+    int palette[8] = { a0, a1 };
+    for (int i = 2; i < 8; i++)
+    {
+        if (a0 > a1) palette[i] = ((8 - i) * a0 + (i - 1) * a1) / 7;
+        else palette[i] = i < 6 ? ((6 - i) * a0 + (i - 1) * a1) / 5 : (i == 6 ? 0 : 255);
+    }
+
+    uint64_t indices = 0;
+    for (int i = 0; i < 6; i++) indices |= (uint64_t)block[2 + i] << (i * 8);
+
+    for (int i = 0; i < 16; i++) texels[i][channel] = (uint8_t)palette[(indices >> (i * 3)) & 7];
+}
+
+static uint32_t ReadBits(const uint8_t* block, int& position, int count)
+{
+    uint32_t value = 0;
+    for (int i = 0; i < count; i++, position++)
+    {
+        value |= (uint32_t)((block[position / 8] >> (position % 8)) & 1) << i;
+    }
+    return value;
+}
+
+//Mode 6 only, the one the encoder writes. False for any other mode. swapped is set when the first endpoint is the
+//brighter one, which the encoder only writes when the anchor index needed the endpoints swapped
+static bool DecodeBC7(const uint8_t* block, uint8_t texels[16][4], bool& swapped)
+{
+    int position = 0;
+    if (ReadBits(block, position, 7) != (1u << 6)) return false;
+
+    int endpoints[2][4];
+    for (int c = 0; c < 4; c++)
+    {
+        endpoints[0][c] = (int)ReadBits(block, position, 7) << 1;
+        endpoints[1][c] = (int)ReadBits(block, position, 7) << 1;
+    }
+
+    int pBit0 = (int)ReadBits(block, position, 1);
+    int pBit1 = (int)ReadBits(block, position, 1);
+    for (int c = 0; c < 4; c++)
+    {
+        endpoints[0][c] |= pBit0;
+        endpoints[1][c] |= pBit1;
+    }
+
+    static const int WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    for (int i = 0; i < 16; i++)
+    {
+        int index = (int)ReadBits(block, position, i == 0 ? 3 : 4);
+        for (int c = 0; c < 4; c++)
+        {
+            texels[i][c] = (uint8_t)(((64 - WEIGHTS[index]) * endpoints[0][c] + WEIGHTS[index] * endpoints[1][c] + 32) >> 6);
+        }
+    }
+
+    swapped = endpoints[0][0] + endpoints[0][1] + endpoints[0][2] > endpoints[1][0] + endpoints[1][1] + endpoints[1][2];
+    return true;
+}
+
+struct TestImage
+{
+    const char* name;
+    uint32_t width;
+    uint32_t height;
+    std::vector<uint8_t> rgba;
+};
+
+static void MakeTestImages(std::mt19937& random, std::vector<TestImage>& images)
+{
+    //ODD SIZES, SO THE EDGE BLOCKS REPEAT THEIR LAST TEXEL
+    const uint32_t width = 130;
+    const uint32_t height = 67;
+    std::uniform_int_distribution<int> noise(-6, 6);
+
+    images = { { "smooth", width, height }, { "flat", width, height }, { "edges", width, height }, { "reversed", width, height } };
+    for (TestImage& image : images) image.rgba.resize((size_t)width * height * 4);
+
+    for (uint32_t y = 0; y < height; y++)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            size_t texel = ((size_t)y * width + x) * 4;
+
+            //PHOTO LIKE: SMOOTH WAVES, A LITTLE NOISE AND A VARYING ALPHA
+            float u = (float)x / width;
+            float v = (float)y / height;
+            int smooth[4] = {
+                (int)(128 + 100 * std::sin(u * 7.0f + v * 2.0f)),
+                (int)(128 + 90 * std::cos(v * 5.0f - u * 3.0f)),
+                (int)(128 + 80 * std::sin((u + v) * 4.0f)),
+                (int)(255 * v)
+            };
+            for (int c = 0; c < 4; c++) images[0].rgba[texel + c] = (uint8_t)std::min(std::max(smooth[c] + (c < 3 ? noise(random) : 0), 0), 255);
+
+            //LARGE REGIONS OF ONE COLOUR. EVERY BC1 BLOCK INSIDE THEM HAS EQUAL ENDPOINTS
+            int region = (x / 24 + y / 16) % 3;
+            const uint8_t flat[3][4] = { { 200, 40, 90, 255 }, { 33, 120, 250, 128 }, { 250, 250, 250, 0 } };
+            for (int c = 0; c < 4; c++) images[1].rgba[texel + c] = flat[region][c];
+
+            //HARD TWO COLOUR EDGES THROUGH THE BLOCKS
+            bool inside = (x * 3 + y * 5) % 11 < 5;
+            for (int c = 0; c < 4; c++) images[2].rgba[texel + c] = inside ? (uint8_t)(30 + c * 40) : (uint8_t)(230 - c * 30);
+
+            //BRIGHTEST AT THE FIRST TEXEL OF EVERY BLOCK, SO THE BC7 ANCHOR INDEX STARTS AT THE HIGH END AND IS SWAPPED
+            int ramp = 255 - (int)((x % 4) + (y % 4)) * 10;
+            for (int c = 0; c < 4; c++) images[3].rgba[texel + c] = (uint8_t)std::max(ramp - c * 10, 0);
+        }
+    }
+}
+
+static bool CheckBlocks()
+{
+    struct FormatCase {
+        TextureFormat format;
+        const char* name;
+        int numChannels;
+        double minPSNR;
+    };
+
+    //ONLY THE CHANNELS THE FORMAT STORES ARE COMPARED: BC1 IS OPAQUE AND BC5 ONLY HAS RED AND GREEN
+    const FormatCase formats[] = {
+        { TextureFormat::BC1, "BC1", 3, BLOCK_CHECK_MIN_PSNR_BC1 },
+        { TextureFormat::BC3, "BC3", 4, BLOCK_CHECK_MIN_PSNR_BC3 },
+        { TextureFormat::BC5, "BC5", 2, BLOCK_CHECK_MIN_PSNR_BC5 },
+        { TextureFormat::BC7, "BC7", 4, BLOCK_CHECK_MIN_PSNR_BC7 },
+    };
+
+    std::mt19937 random(16);
+    std::vector<TestImage> images;
+    MakeTestImages(random, images);
+
+    int failures = 0;
+    int equalEndpointBlocks = 0;
+    int swappedAnchorBlocks = 0;
+
+    for (const FormatCase& formatCase : formats)
+    {
+        for (BlockQuality quality : { BlockQuality::Fast, BlockQuality::High })
+        {
+            for (const TestImage& image : images)
+            {
+                uint32_t blocksX = (image.width + 3) / 4;
+                uint32_t blocksY = (image.height + 3) / 4;
+                size_t blockBytes = GetBlockBytes(formatCase.format);
+
+                std::vector<uint8_t> blocks(blocksX * blocksY * blockBytes);
+                CompressBlocks(formatCase.format, image.rgba.data(), image.width, image.height, quality, blocks.data());
+
+                double squaredError = 0.0;
+                bool decoded = true;
+
+                for (uint32_t by = 0; by < blocksY; by++)
+                {
+                    for (uint32_t bx = 0; bx < blocksX; bx++)
+                    {
+                        const uint8_t* block = blocks.data() + ((size_t)by * blocksX + bx) * blockBytes;
+                        uint8_t texels[16][4] = {};
+                        bool swapped = false;
+
+                        switch (formatCase.format)
+                        {
+                        case TextureFormat::BC1:
+                            DecodeBC1(block, false, texels);
+                            equalEndpointBlocks += block[0] == block[2] && block[1] == block[3];
+                            break;
+                        case TextureFormat::BC3:
+                            DecodeBC1(block + 8, true, texels);
+                            DecodeBC4(block, 3, texels);
+                            break;
+                        case TextureFormat::BC5:
+                            DecodeBC4(block, 0, texels);
+                            DecodeBC4(block + 8, 1, texels);
+                            break;
+                        case TextureFormat::BC7:
+                            decoded &= DecodeBC7(block, texels, swapped);
+                            swappedAnchorBlocks += swapped;
+                            break;
+                        default:
+                            break;
+                        }
+
+                        for (uint32_t i = 0; i < 16; i++)
+                        {
+                            uint32_t x = bx * 4 + i % 4;
+                            uint32_t y = by * 4 + i / 4;
+                            if (x >= image.width || y >= image.height) continue;
+
+                            const uint8_t* source = &image.rgba[((size_t)y * image.width + x) * 4];
+                            for (int c = 0; c < formatCase.numChannels; c++)
+                            {
+                                double diff = (double)texels[i][c] - source[c];
+                                squaredError += diff * diff;
+                            }
+                        }
+                    }
+                }
+
+                double meanSquaredError = squaredError / ((double)image.width * image.height * formatCase.numChannels);
+                double psnr = meanSquaredError > 0.0 ? 10.0 * std::log10(255.0 * 255.0 / meanSquaredError) : 99.0;
+                bool passed = decoded && psnr >= formatCase.minPSNR;
+
+                printf("\nblocks: %s %-4s %-8s %5.1f dB%s\n", formatCase.name, quality == BlockQuality::High ? "high" : "fast", image.name, psnr, passed ? "" : " FAILED");
+                failures += !passed;
+            }
+        }
+    }
+
+    //THE EDGE CASES MUST HAVE BEEN HIT, OTHERWISE THE IMAGES NO LONGER COVER THEM
+    printf("\nblocks: %d BC1 blocks with equal endpoints, %d BC7 blocks with swapped endpoints\n", equalEndpointBlocks, swappedAnchorBlocks);
+    if (equalEndpointBlocks == 0 || swappedAnchorBlocks == 0) failures++;
+
+    return failures == 0;
+}
+
+//IMPORT ALLOCATIONS
+
+struct StreamAllocations
+{
+    size_t vertices = 0;
+    size_t indices = 0;
+    size_t packedVertices = 0;
+    size_t shortIndices = 0;
+};
+
+//THE SAME TRIANGLES AS AN ASSIMP MESH, WHAT THE IMPORTER CONVERTS
+static aiMesh* MakeAssimpMesh(const TestMesh& mesh)
+{
+    aiMesh* assimpMesh = new aiMesh();
+    assimpMesh->mNumVertices = (unsigned int)mesh.vertices.size();
+    assimpMesh->mVertices = new aiVector3D[mesh.vertices.size()];
+    assimpMesh->mNormals = new aiVector3D[mesh.vertices.size()];
+    assimpMesh->mTextureCoords[0] = new aiVector3D[mesh.vertices.size()];
+    assimpMesh->mNumUVComponents[0] = 2;
+
+    for (size_t i = 0; i < mesh.vertices.size(); i++)
+    {
+        const Vertex& vertex = mesh.vertices[i];
+        assimpMesh->mVertices[i] = aiVector3D(vertex.position.x, vertex.position.y, vertex.position.z);
+        assimpMesh->mNormals[i] = aiVector3D(vertex.normal.x, vertex.normal.y, vertex.normal.z);
+        assimpMesh->mTextureCoords[0][i] = aiVector3D(vertex.texCoords.x, vertex.texCoords.y, 0.0f);
+    }
+
+    assimpMesh->mNumFaces = (unsigned int)(mesh.indices.size() / 3);
+    assimpMesh->mFaces = new aiFace[assimpMesh->mNumFaces];
+
+    for (unsigned int f = 0; f < assimpMesh->mNumFaces; f++)
+    {
+        aiFace& face = assimpMesh->mFaces[f];
+        face.mNumIndices = 3;
+        face.mIndices = new unsigned int[3];
+        std::copy(mesh.indices.begin() + f * 3, mesh.indices.begin() + f * 3 + 3, face.mIndices);
+    }
+
+    return assimpMesh;
+}
+
+//WHAT Mesh::PrepareModel DOES WITH THE STREAMS, WHICH CAN'T BE LINKED WITHOUT GL: TAKES THEM BY VALUE AND MOVES THEM
+//INTO THE COMPONENT
+static void TakeGeometry(std::vector<Vertex> vertices, std::vector<unsigned int> indices, TestMesh& component)
+{
+    component.vertices = std::move(vertices);
+    component.indices = std::move(indices);
+}
+
+//THE PACKED EDITOR IMPORT OF ONE MESH, Loader::ImportMeshes AND Mesh::PrepareModel, STAGE BY STAGE. CONVERSION FILLS
+//BOTH STREAMS IN ONE CALL, SO EACH IS COUNTED BY CONVERTING WITH THE STORAGE OF THE OTHER ONE ALREADY RESERVED
+static StreamAllocations CountImportAllocations(const aiMesh* assimpMesh)
+{
+    StreamAllocations counts;
+
+    size_t numIndices = 0;
+    for (unsigned int f = 0; f < assimpMesh->mNumFaces; f++) numIndices += assimpMesh->mFaces[f].mNumIndices;
+
+    {
+        std::vector<Vertex> vertices;
+        std::vector<unsigned int> indices;
+        indices.reserve(numIndices);
+
+        size_t before = GetAllocationCount();
+        ConvertAssimpMesh(assimpMesh, vertices, indices);
+        counts.vertices += GetAllocationCount() - before;
+    }
+
+    {
+        std::vector<Vertex> vertices;
+        std::vector<unsigned int> indices;
+        vertices.reserve(assimpMesh->mNumVertices);
+
+        size_t before = GetAllocationCount();
+        ConvertAssimpMesh(assimpMesh, vertices, indices);
+        counts.indices += GetAllocationCount() - before;
+    }
+
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    ConvertAssimpMesh(assimpMesh, vertices, indices);
+
+    AABB bounds;
+    bounds.min = glm::vec3(INFINITY);
+    bounds.max = glm::vec3(-INFINITY);
+
+    for (const Vertex& vertex : vertices)
+    {
+        bounds.min = glm::min(bounds.min, vertex.position);
+        bounds.max = glm::max(bounds.max, vertex.position);
+    }
+
+    size_t before = GetAllocationCount();
+    std::vector<PackedVertex> packedVertices(vertices.size());
+    PackVertices(vertices, bounds, packedVertices);
+    counts.packedVertices += GetAllocationCount() - before;
+
+    //THE CPU COPY IS DECODED BACK FROM THE PACKED VERTICES, IN PLACE
+    before = GetAllocationCount();
+    UnpackVertices(packedVertices.data(), packedVertices.size(), bounds, vertices);
+    counts.vertices += GetAllocationCount() - before;
+
+    before = GetAllocationCount();
+    std::vector<uint16_t> shortIndices;
+    if (CanUseShortIndices(vertices.size()))
+    {
+        shortIndices.resize(indices.size());
+        PackIndices(indices, shortIndices);
+    }
+    counts.shortIndices += GetAllocationCount() - before;
+
+    //A COPY OF EITHER STREAM COUNTS AGAINST BOTH
+    TestMesh component;
+    before = GetAllocationCount();
+    TakeGeometry(std::move(vertices), std::move(indices), component);
+    size_t handed = GetAllocationCount() - before;
+    counts.vertices += handed;
+    counts.indices += handed;
+
+    return counts;
+}
+
+static bool CheckAllocations()
+{
+    std::mt19937 random(16);
+    std::vector<TestMesh> meshes;
+    MakeTestMeshes(random, meshes);
+
+    bool modelsRead = true;
+    for (const std::string& path : modelPaths) modelsRead &= ReadModelMeshes(path, meshes);
+
+    int failures = 0;
+
+    for (const TestMesh& mesh : meshes)
+    {
+        aiMesh* assimpMesh = MakeAssimpMesh(mesh);
+        StreamAllocations counts = CountImportAllocations(assimpMesh);
+        delete assimpMesh;
+
+        bool passed = counts.vertices <= CHECK_MAX_STREAM_ALLOCATIONS && counts.indices <= CHECK_MAX_STREAM_ALLOCATIONS &&
+            counts.packedVertices <= CHECK_MAX_STREAM_ALLOCATIONS && counts.shortIndices <= CHECK_MAX_STREAM_ALLOCATIONS;
+
+        printf("\nallocations: %-8s vertices %zu, indices %zu, packed vertices %zu, short indices %zu%s\n", mesh.name.c_str(),
+            counts.vertices, counts.indices, counts.packedVertices, counts.shortIndices, passed ? "" : " FAILED");
+        failures += !passed;
+    }
+
+    return failures == 0 && modelsRead;
+}
+
+int main(int argc, char* argv[])
+{
+    struct Check {
+        const char* name;
+        bool (*run)();
+    };
+
+    const Check checks[] = {
+        { "meshlets", CheckMeshlets },
+        { "weld", CheckWeld },
+        { "codec", CheckCodec },
+        { "blocks", CheckBlocks },
+        { "allocations", CheckAllocations },
+    };
+
+    std::vector<std::string> selected;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--model") == 0 && i + 1 < argc) modelPaths.push_back(argv[++i]);
+        else if (argv[i][0] == '-')
+        {
+            PrintUsage();
+            return EXIT_FAILURE;
+        }
+        else selected.push_back(argv[i]);
+    }
+
+    for (const std::string& name : selected)
+    {
+        bool known = false;
+        for (const Check& check : checks) known |= name == check.name;
+
+        if (!known)
+        {
+            PrintUsage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    int run = 0;
+    int failed = 0;
+
+    for (const Check& check : checks)
+    {
+        if (!selected.empty() && std::find(selected.begin(), selected.end(), check.name) == selected.end()) continue;
+
+        run++;
+        if (!check.run())
+        {
+            printf("\nw16check: %s FAILED\n", check.name);
+            failed++;
+        }
+    }
+
+    printf("\nw16check: %d checks, %d failed\n", run, failed);
+    return failed > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
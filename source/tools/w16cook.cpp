@@ -0,0 +1,192 @@
+#include "../utils/ModelCook.h"
+#include "../utils/TextureCook.h"
+#include "../utils/ImportDatabase.h"
+#include "../utils/FilePath.h"
+#include "../utils/JobSystem.h"
+#include "../utils/Timer.h"
+#include "../utils/ProcessMemory.h"
+#include "../components/Component.h"
+
+#include <IL/il.h>
+#include "SDL3/SDL_filesystem.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <set>
+#include <utility>
+
+//Offline cook of an Assets directory into the Library, without windows or GL. Runs from the directory the editor
+//runs from, so both share Library/ and its import database. Models still valid in the database are skipped.
+//Loose textures are cooked as colour, plus colour with alpha for the ones a saved scene marks transparent. The cooked
+//formats match an editor on a driver with BC support, for one without it cook with --raw-textures.
+//
+//  w16cook [assets directory] [--force] [--full-vertices] [--raw-meshes] [--raw-textures] [--high-quality] [--low-memory] [--profile <name>]
+
+static void PrintUsage()
+{
+    printf("usage: w16cook [assets directory] [--force] [--full-vertices] [--raw-meshes] [--raw-textures] [--high-quality] [--low-memory] [--profile <name>]\n");
+    printf("  --force           cook everything again, ignoring the import database\n");
+    printf("  --full-vertices   write full float vertices instead of the packed format\n");
+    printf("  --raw-meshes      don't compress the Library meshes\n");
+    printf("  --raw-textures    cook textures as RGBA8 instead of block compressed\n");
+    printf("  --high-quality    slower, higher quality block compression\n");
+    printf("  --low-memory      one model and one mesh at a time, for models that don't fit in memory otherwise\n");
+    printf("  --profile <name>  Assimp post processing: editable (default) or runtime-optimized\n");
+}
+
+//EVERY FILE UNDER THE DIRECTORY, SUBDIRECTORIES INCLUDED
+static void CollectFiles(const std::string& directory, std::vector<std::string>& files)
+{
+    struct CollectData {
+        const std::string* directory;
+        std::vector<std::string>* files;
+    } data{ &directory, &files };
+
+    SDL_EnumerateDirectory(
+        directory.c_str(),
+        [](void* userdata, const char*, const char* fname) -> SDL_EnumerationResult {
+            auto* d = static_cast<CollectData*>(userdata);
+            std::string path = *d->directory + "/" + fname;
+
+            SDL_PathInfo info;
+            if (SDL_GetPathInfo(path.c_str(), &info))
+            {
+                if (info.type == SDL_PATHTYPE_DIRECTORY) CollectFiles(path, *d->files);
+                else if (info.type == SDL_PATHTYPE_FILE) d->files->push_back(path);
+            }
+
+            return SDL_ENUM_CONTINUE;
+        },
+        &data
+    );
+}
+
+//TEXTURES THE SCENE SAMPLES WITH ALPHA, THE EDITOR ASKS FOR THEM AS ColorAlpha
+static void CollectSceneTextures(pugi::xml_node gameObjectNode, std::set<std::pair<std::string, TextureUsage>>& requests)
+{
+    for (pugi::xml_node componentNode = gameObjectNode.child("Components").child("Component"); componentNode; componentNode = componentNode.next_sibling("Component"))
+    {
+        if (componentNode.attribute("type").as_int() != (int)ComponentType::Texture || !componentNode.attribute("transparent").as_bool()) continue;
+
+        //A MISSING IMAGE IS DRAWN AS THE CHECKER, NOTHING TO COOK
+        std::string path = componentNode.attribute("path").as_string();
+        if (!path.empty() && SDL_GetPathInfo(path.c_str(), nullptr)) requests.emplace(CanonicalPath(path), TextureUsage::ColorAlpha);
+    }
+
+    for (pugi::xml_node childNode = gameObjectNode.child("Childs").child("GameObject"); childNode; childNode = childNode.next_sibling("GameObject"))
+    {
+        CollectSceneTextures(childNode, requests);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::string assetsDirectory = "Assets";
+    ModelCookSettings settings;
+    bool force = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--force") == 0) force = true;
+        else if (strcmp(argv[i], "--full-vertices") == 0) settings.packedVertexFormat = false;
+        else if (strcmp(argv[i], "--raw-meshes") == 0) settings.compressMeshes = false;
+        else if (strcmp(argv[i], "--raw-textures") == 0) settings.compressTextures = false;
+        else if (strcmp(argv[i], "--high-quality") == 0) settings.textureQuality = BlockQuality::High;
+        else if (strcmp(argv[i], "--low-memory") == 0) settings.lowMemory = true;
+        else if (strcmp(argv[i], "--profile") == 0 && i + 1 < argc)
+        {
+            if (!FindImportProfile(argv[++i], settings.profile))
+            {
+                PrintUsage();
+                return EXIT_FAILURE;
+            }
+        }
+        else if (argv[i][0] == '-')
+        {
+            PrintUsage();
+            return EXIT_FAILURE;
+        }
+        else assetsDirectory = argv[i];
+    }
+
+    //SAME IMAGE ORIGIN AS THE EDITOR, OTHERWISE THE COOKED LEVELS WOULD BE FLIPPED
+    ilInit();
+    ilEnable(IL_ORIGIN_SET);
+    ilOriginFunc(IL_ORIGIN_LOWER_LEFT);
+
+    std::vector<std::string> files;
+    CollectFiles(assetsDirectory, files);
+
+    std::vector<std::string> models;
+    std::set<std::pair<std::string, TextureUsage>> textureRequests;
+    int numScenes = 0;
+
+    for (const std::string& file : files)
+    {
+        std::string extension = GetFileExtension(file);
+
+        if (extension == "fbx" || extension == "obj") models.push_back(file);
+        else if (extension == "png" || extension == "dds" || extension == "jpg" || extension == "tga") textureRequests.emplace(CanonicalPath(file), TextureUsage::Color);
+        else if (extension == "w16scene")
+        {
+            pugi::xml_document doc;
+            if (!doc.load_file(file.c_str())) continue;
+
+            pugi::xml_node gameObjectsNode = doc.child("Scene").child("GameObjects");
+            for (pugi::xml_node gameObjectNode = gameObjectsNode.child("GameObject"); gameObjectNode; gameObjectNode = gameObjectNode.next_sibling("GameObject"))
+            {
+                CollectSceneTextures(gameObjectNode, textureRequests);
+            }
+            numScenes++;
+        }
+    }
+
+    std::vector<std::pair<std::string, TextureUsage>> textures(textureRequests.begin(), textureRequests.end());
+
+    printf("Cooking %d models and %d textures (%d scenes) from %s\n", (int)models.size(), (int)textures.size(), numScenes, assetsDirectory.c_str());
+
+    //ONE SAVE AT THE END INSTEAD OF ONE PER ASSET
+    ImportDatabase& database = ImportDatabase::GetInstance();
+    database.autoSave = false;
+
+    Timer timer;
+    std::atomic<int> cooked{ 0 };
+    std::atomic<int> skipped{ 0 };
+    std::atomic<int> failed{ 0 };
+
+    //MODELS IN PARALLEL, EACH ONE SPREADS ITS MESHES AND TEXTURES OVER THE SAME WORKERS. ONE BY ONE IN LOW MEMORY
+    size_t modelBatchSize = settings.lowMemory ? models.size() : 1;
+
+    JobSystem::GetInstance().ParallelFor(models.size(), modelBatchSize, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            if (force) database.Forget(models[i]);
+
+            bool upToDate = false;
+            if (!CookModel(models[i], settings, upToDate)) failed++;
+            else if (upToDate) skipped++;
+            else cooked++;
+        }
+    });
+
+    //TEXTURES ALREADY COOKED FROM THE SAME CONTENTS ARE ONLY MAPPED AND CHECKED
+    JobSystem::GetInstance().ParallelFor(textures.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            TextureFormat textureFormat = GetCookFormat(textures[i].second, settings.compressTextures, settings.textureQuality);
+
+            CookedTexture texture;
+            if (!CookTexture(textures[i].first, textureFormat, settings.textureQuality, texture)) failed++;
+        }
+    });
+
+    database.Save();
+
+    printf("\nw16cook: %d models cooked, %d up to date, %d failures in %.2f s, peak memory %.1f MB\n", cooked.load(), skipped.load(), failed.load(), timer.ReadSec(), GetPeakResidentBytes() / (1024.0f * 1024.0f));
+
+    return failed > 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
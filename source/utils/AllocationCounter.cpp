@@ -0,0 +1,55 @@
+#include "AllocationCounter.h"
+
+#ifdef W16_COUNT_ALLOCATIONS
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<size_t> allocationCount(0);
+
+size_t GetAllocationCount()
+{
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+void* operator new(size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+#else
+
+size_t GetAllocationCount()
+{
+    return 0;
+}
+
+#endif
@@ -0,0 +1,7 @@
+#pragma once
+#include <cstddef>
+
+//Global heap allocation counter, only compiled in with W16_COUNT_ALLOCATIONS (CMake option W16_ALLOCATION_BENCHMARK,
+//always on for w16check). Without it the counter always reads 0. It counts every thread, so the importer and the cook run one mesh at a time
+//while it is on.
+size_t GetAllocationCount();
@@ -0,0 +1,117 @@
+#include "AssetWatcher.h"
+#include "JobSystem.h"
+
+#include "SDL3/SDL_filesystem.h"
+#include <thread>
+
+//SAME LIMIT AS THE FILE INDEX, A LINK LOOP CAN'T RECURSE FOREVER
+#define ASSET_WATCHER_MAX_DEPTH 16
+
+AssetWatcher::AssetWatcher(const std::string& directory) : directory(directory)
+{
+}
+
+AssetWatcher::~AssetWatcher()
+{
+    while (scanning) std::this_thread::yield();
+}
+
+void AssetWatcher::Poll(std::vector<std::string>& changed)
+{
+    {
+        std::lock_guard<std::mutex> lock(foundMutex);
+        changed.insert(changed.end(), found.begin(), found.end());
+        found.clear();
+    }
+
+    if (scanning || (primed && timer.ReadSec() < intervalSec)) return;
+
+    timer.Start();
+    scanning = true;
+
+    JobSystem::GetInstance().Submit([this]() {
+        Scan();
+        scanning = false;
+    });
+}
+
+void AssetWatcher::Scan()
+{
+    std::unordered_map<std::string, FileState> current;
+    current.reserve(files.size());
+    CollectFiles(directory, 0, current);
+
+    std::vector<std::string> changed;
+
+    for (const auto& pair : current)
+    {
+        auto known = files.find(pair.first);
+        if (known == files.end() || known->second == pair.second)
+        {
+            settling.erase(pair.first);
+            continue;
+        }
+
+        //STILL BEING WRITTEN IF IT CHANGED AGAIN SINCE THE LAST SCAN
+        auto previous = settling.find(pair.first);
+        if (previous == settling.end() || previous->second != pair.second)
+        {
+            settling[pair.first] = pair.second;
+            continue;
+        }
+
+        settling.erase(previous);
+        changed.push_back(pair.first);
+        known->second = pair.second;
+    }
+
+    //NEW FILES ARE TAKEN AS THEY ARE, DELETED ONES FORGOTTEN
+    for (const auto& pair : current)
+    {
+        if (files.find(pair.first) == files.end()) files.emplace(pair.first, pair.second);
+    }
+
+    for (auto it = files.begin(); it != files.end();)
+    {
+        if (current.find(it->first) == current.end()) it = files.erase(it);
+        else ++it;
+    }
+
+    numFiles = files.size();
+    primed = true;
+
+    if (changed.empty()) return;
+
+    std::lock_guard<std::mutex> lock(foundMutex);
+    found.insert(found.end(), changed.begin(), changed.end());
+}
+
+void AssetWatcher::CollectFiles(const std::string& directoryPath, int depth, std::unordered_map<std::string, FileState>& current)
+{
+    if (depth > ASSET_WATCHER_MAX_DEPTH) return;
+
+    struct CollectData {
+        AssetWatcher* watcher;
+        const std::string* directoryPath;
+        int depth;
+        std::unordered_map<std::string, FileState>* current;
+    } data{ this, &directoryPath, depth, &current };
+
+    SDL_EnumerateDirectory(
+        directoryPath.c_str(),
+        [](void* userdata, const char*, const char* fname) -> SDL_EnumerationResult {
+            auto* d = static_cast<CollectData*>(userdata);
+            std::string path = *d->directoryPath + "/" + fname;
+
+            SDL_PathInfo info;
+            if (SDL_GetPathInfo(path.c_str(), &info))
+            {
+                if (info.type == SDL_PATHTYPE_DIRECTORY) d->watcher->CollectFiles(path, d->depth + 1, *d->current);
+                else if (info.type == SDL_PATHTYPE_FILE) (*d->current)[path] = { info.modify_time, info.size };
+            }
+
+            return SDL_ENUM_CONTINUE;
+        },
+        &data
+    );
+}
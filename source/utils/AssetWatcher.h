@@ -0,0 +1,57 @@
+#pragma once
+#include "Timer.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+//Finds the files under a directory whose modification time or size changed, by scanning it on the job system every
+//intervalSec. A change is only reported once two scans in a row see the same state, so a file still being written
+//is never picked up half way. New and deleted files aren't reported, nothing can be using them.
+class AssetWatcher
+{
+public:
+    explicit AssetWatcher(const std::string& directory);
+
+    //Waits for the scan in flight
+    ~AssetWatcher();
+
+    //Starts a scan when the interval has passed and hands over what the finished ones found. The first scan only
+    //records what is there.
+    void Poll(std::vector<std::string>& changed);
+
+    size_t GetNumFiles() const { return numFiles; }
+
+public:
+    float intervalSec = 1.0f;
+
+private:
+    struct FileState
+    {
+        int64_t modifyTime = 0;
+        uint64_t size = 0;
+
+        bool operator==(const FileState& other) const { return modifyTime == other.modifyTime && size == other.size; }
+        bool operator!=(const FileState& other) const { return !(*this == other); }
+    };
+
+    //ON A WORKER, ONLY ONE AT A TIME
+    void Scan();
+    void CollectFiles(const std::string& directoryPath, int depth, std::unordered_map<std::string, FileState>& current);
+
+private:
+    std::string directory;
+    Timer timer;
+
+    //ONLY TOUCHED BY THE SCAN
+    std::unordered_map<std::string, FileState> files;
+    std::unordered_map<std::string, FileState> settling;
+    bool primed = false;
+
+    std::vector<std::string> found;
+    std::mutex foundMutex;
+    std::atomic<bool> scanning{ false };
+    std::atomic<size_t> numFiles{ 0 };
+};
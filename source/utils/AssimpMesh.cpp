@@ -0,0 +1,69 @@
+#include "AssimpMesh.h"
+#include "../components/Mesh.h"
+#include <assimp/mesh.h>
+#include <algorithm>
+
+void ConvertAssimpMesh(const aiMesh* assimpMesh, std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+    //EXACT SIZES FIRST, SO EVERY STREAM IS ALLOCATED ONCE
+    size_t numIndices = 0;
+    for (unsigned int i = 0; i < assimpMesh->mNumFaces; i++)
+    {
+        numIndices += assimpMesh->mFaces[i].mNumIndices;
+    }
+
+    vertices.resize(assimpMesh->mNumVertices);
+    indices.resize(numIndices);
+
+    bool hasNormals = assimpMesh->HasNormals();
+    bool hasUVs = assimpMesh->HasTextureCoords(0);
+
+    //FILL VERTEXS
+    for (unsigned int i = 0; i < assimpMesh->mNumVertices; i++)
+    {
+        Vertex& vertex = vertices[i];
+
+        vertex.position = glm::vec3(assimpMesh->mVertices[i].x, assimpMesh->mVertices[i].y, assimpMesh->mVertices[i].z);
+        vertex.normal = hasNormals ? glm::vec3(assimpMesh->mNormals[i].x, assimpMesh->mNormals[i].y, assimpMesh->mNormals[i].z) : glm::vec3(0.0f);
+        vertex.texCoords = hasUVs ? glm::vec2(assimpMesh->mTextureCoords[0][i].x, assimpMesh->mTextureCoords[0][i].y) : glm::vec2(0.0f);
+    }
+
+    //FILL INDEX
+    unsigned int* index = indices.data();
+    for (unsigned int i = 0; i < assimpMesh->mNumFaces; i++)
+    {
+        const aiFace& face = assimpMesh->mFaces[i];
+        std::copy(face.mIndices, face.mIndices + face.mNumIndices, index);
+        index += face.mNumIndices;
+    }
+}
+
+void ReleaseAssimpMeshData(aiMesh* assimpMesh)
+{
+    delete[] assimpMesh->mVertices;
+    delete[] assimpMesh->mNormals;
+    delete[] assimpMesh->mTangents;
+    delete[] assimpMesh->mBitangents;
+    delete[] assimpMesh->mFaces;
+
+    assimpMesh->mVertices = nullptr;
+    assimpMesh->mNormals = nullptr;
+    assimpMesh->mTangents = nullptr;
+    assimpMesh->mBitangents = nullptr;
+    assimpMesh->mFaces = nullptr;
+
+    for (unsigned int i = 0; i < AI_MAX_NUMBER_OF_TEXTURECOORDS; i++)
+    {
+        delete[] assimpMesh->mTextureCoords[i];
+        assimpMesh->mTextureCoords[i] = nullptr;
+    }
+
+    for (unsigned int i = 0; i < AI_MAX_NUMBER_OF_COLOR_SETS; i++)
+    {
+        delete[] assimpMesh->mColors[i];
+        assimpMesh->mColors[i] = nullptr;
+    }
+
+    assimpMesh->mNumVertices = 0;
+    assimpMesh->mNumFaces = 0;
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include <vector>
+
+struct aiMesh;
+struct Vertex;
+
+//Assimp mesh to engine vertices and indices. Both streams are sized exactly up front, one heap allocation each
+//(w16check allocations verifies it).
+void ConvertAssimpMesh(const aiMesh* assimpMesh, std::vector<Vertex>& vertices, std::vector<unsigned int>& indices);
+
+//Frees the vertex streams and faces of a mesh that was already converted, so Assimp's copy of a big model goes away
+//mesh by mesh instead of at the end. Name and material stay, the mesh reads as empty afterwards.
+void ReleaseAssimpMeshData(aiMesh* assimpMesh);
@@ -0,0 +1,527 @@
+#include "BlockCompression.h"
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BLOCK_COMPRESSION_SSE2
+#include <emmintrin.h>
+#endif
+
+#define BLOCK_ROWS_PER_JOB 4
+#define REFINE_PASSES 2
+#define POWER_ITERATIONS 8
+
+struct Block
+{
+    float pixels[16][4];
+};
+
+//STRUCTURE OF ARRAYS SO FOUR ENTRIES ARE COMPARED AT ONCE
+struct Palette
+{
+    alignas(16) float channels[4][16];
+    int count;
+};
+
+static const int BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+bool IsBlockCompressed(TextureFormat format)
+{
+    return format != TextureFormat::RGBA8;
+}
+
+size_t GetBlockBytes(TextureFormat format)
+{
+    return format == TextureFormat::BC1 ? 8 : 16;
+}
+
+static void FetchBlock(const uint8_t* rgba, uint32_t width, uint32_t height, uint32_t blockX, uint32_t blockY, Block& block)
+{
+    for (uint32_t y = 0; y < 4; y++)
+    {
+        uint32_t sourceY = std::min(blockY * 4 + y, height - 1);
+
+        for (uint32_t x = 0; x < 4; x++)
+        {
+            uint32_t sourceX = std::min(blockX * 4 + x, width - 1);
+            const uint8_t* texel = rgba + ((size_t)sourceY * width + sourceX) * 4;
+
+            for (int channel = 0; channel < 4; channel++)
+            {
+                block.pixels[y * 4 + x][channel] = texel[channel];
+            }
+        }
+    }
+}
+
+//Returns the closest palette entry and adds its squared distance to error. Ties keep the lowest index.
+static int FindNearest(const float* pixel, const Palette& palette, const float* weights, float& error)
+{
+#ifdef BLOCK_COMPRESSION_SSE2
+    __m128 best = _mm_set1_ps(FLT_MAX);
+    __m128i bestIndex = _mm_setzero_si128();
+
+    for (int i = 0; i < palette.count; i += 4)
+    {
+        __m128 distance = _mm_setzero_ps();
+
+        for (int channel = 0; channel < 4; channel++)
+        {
+            __m128 diff = _mm_sub_ps(_mm_load_ps(&palette.channels[channel][i]), _mm_set1_ps(pixel[channel]));
+            distance = _mm_add_ps(distance, _mm_mul_ps(_mm_mul_ps(diff, diff), _mm_set1_ps(weights[channel])));
+        }
+
+        __m128i less = _mm_castps_si128(_mm_cmplt_ps(distance, best));
+        __m128i index = _mm_setr_epi32(i, i + 1, i + 2, i + 3);
+        best = _mm_min_ps(distance, best);
+        bestIndex = _mm_or_si128(_mm_and_si128(less, index), _mm_andnot_si128(less, bestIndex));
+    }
+
+    alignas(16) float distances[4];
+    alignas(16) int indices[4];
+    _mm_store_ps(distances, best);
+    _mm_store_si128((__m128i*)indices, bestIndex);
+
+    int lane = 0;
+    for (int i = 1; i < 4; i++)
+    {
+        if (distances[i] < distances[lane] || (distances[i] == distances[lane] && indices[i] < indices[lane])) lane = i;
+    }
+
+    error += distances[lane];
+    return indices[lane];
+#else
+    int bestIndex = 0;
+    float best = FLT_MAX;
+
+    for (int i = 0; i < palette.count; i++)
+    {
+        float distance = 0.0f;
+        for (int channel = 0; channel < 4; channel++)
+        {
+            float diff = palette.channels[channel][i] - pixel[channel];
+            distance += diff * diff * weights[channel];
+        }
+
+        if (distance < best)
+        {
+            best = distance;
+            bestIndex = i;
+        }
+    }
+
+    error += best;
+    return bestIndex;
+#endif
+}
+
+//Endpoints at the extremes of the block projected on its principal axis.
+static void FitPrincipalAxis(const Block& block, int channels, float* low, float* high)
+{
+    float mean[4] = {};
+    float minimum[4] = { FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX };
+    float maximum[4] = { -FLT_MAX, -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+    for (int i = 0; i < 16; i++)
+    {
+        for (int c = 0; c < channels; c++)
+        {
+            mean[c] += block.pixels[i][c] / 16.0f;
+            minimum[c] = std::min(minimum[c], block.pixels[i][c]);
+            maximum[c] = std::max(maximum[c], block.pixels[i][c]);
+        }
+    }
+
+    float covariance[4][4] = {};
+    for (int i = 0; i < 16; i++)
+    {
+        for (int a = 0; a < channels; a++)
+        {
+            for (int b = 0; b < channels; b++)
+            {
+                covariance[a][b] += (block.pixels[i][a] - mean[a]) * (block.pixels[i][b] - mean[b]);
+            }
+        }
+    }
+
+    //POWER ITERATION FROM THE BOUNDING BOX DIAGONAL
+    float axis[4] = {};
+    for (int c = 0; c < channels; c++) axis[c] = maximum[c] - minimum[c];
+
+    for (int iteration = 0; iteration < POWER_ITERATIONS; iteration++)
+    {
+        float next[4] = {};
+        float length = 0.0f;
+
+        for (int a = 0; a < channels; a++)
+        {
+            for (int b = 0; b < channels; b++) next[a] += covariance[a][b] * axis[b];
+            length = std::max(length, std::fabs(next[a]));
+        }
+
+        if (length <= 0.0f) break;
+        for (int c = 0; c < channels; c++) axis[c] = next[c] / length;
+    }
+
+    float lengthSquared = 0.0f;
+    for (int c = 0; c < channels; c++) lengthSquared += axis[c] * axis[c];
+
+    for (int c = 0; c < 4; c++)
+    {
+        low[c] = c < channels ? mean[c] : 255.0f;
+        high[c] = low[c];
+    }
+
+    //FLAT BLOCK
+    if (lengthSquared <= 0.0f) return;
+
+    float minT = FLT_MAX;
+    float maxT = -FLT_MAX;
+    for (int i = 0; i < 16; i++)
+    {
+        float t = 0.0f;
+        for (int c = 0; c < channels; c++) t += (block.pixels[i][c] - mean[c]) * axis[c];
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+
+    for (int c = 0; c < channels; c++)
+    {
+        low[c] = std::min(std::max(mean[c] + axis[c] * minT / lengthSquared, 0.0f), 255.0f);
+        high[c] = std::min(std::max(mean[c] + axis[c] * maxT / lengthSquared, 0.0f), 255.0f);
+    }
+}
+
+//Least squares endpoints for fixed indices, weight[i] is how much of endpoint b pixel i takes.
+static bool RefineEndpoints(const Block& block, int channels, const float* weight, float* a, float* b)
+{
+    float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+    float ax[4] = {}, bx[4] = {};
+
+    for (int i = 0; i < 16; i++)
+    {
+        float wb = weight[i];
+        float wa = 1.0f - wb;
+        aa += wa * wa;
+        ab += wa * wb;
+        bb += wb * wb;
+
+        for (int c = 0; c < channels; c++)
+        {
+            ax[c] += wa * block.pixels[i][c];
+            bx[c] += wb * block.pixels[i][c];
+        }
+    }
+
+    float determinant = aa * bb - ab * ab;
+    if (std::fabs(determinant) < 1e-6f) return false;
+
+    for (int c = 0; c < channels; c++)
+    {
+        a[c] = std::min(std::max((bb * ax[c] - ab * bx[c]) / determinant, 0.0f), 255.0f);
+        b[c] = std::min(std::max((aa * bx[c] - ab * ax[c]) / determinant, 0.0f), 255.0f);
+    }
+
+    return true;
+}
+
+static uint16_t To565(const float* color)
+{
+    uint16_t r = (uint16_t)std::lround(color[0] * 31.0f / 255.0f);
+    uint16_t g = (uint16_t)std::lround(color[1] * 63.0f / 255.0f);
+    uint16_t b = (uint16_t)std::lround(color[2] * 31.0f / 255.0f);
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+static void From565(uint16_t color, float* out)
+{
+    uint32_t r = (color >> 11) & 31;
+    uint32_t g = (color >> 5) & 63;
+    uint32_t b = color & 31;
+    out[0] = (float)((r << 3) | (r >> 2));
+    out[1] = (float)((g << 2) | (g >> 4));
+    out[2] = (float)((b << 3) | (b >> 2));
+    out[3] = 255.0f;
+}
+
+static void EncodeBC1(const Block& block, BlockQuality quality, uint8_t* out)
+{
+    static const float WEIGHTS[4] = { 1.0f, 1.0f, 1.0f, 0.0f };
+    static const float ENDPOINT_WEIGHT[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+    float high[4], low[4];
+    FitPrincipalAxis(block, 3, low, high);
+
+    uint16_t bestColors[2] = { 0, 0 };
+    uint32_t bestIndices = 0;
+    float bestError = FLT_MAX;
+    int passes = quality == BlockQuality::High ? REFINE_PASSES : 0;
+
+    for (int pass = 0; pass <= passes; pass++)
+    {
+        uint16_t color0 = To565(high);
+        uint16_t color1 = To565(low);
+
+        //FOUR COLOUR MODE NEEDS color0 > color1. EQUAL ENDPOINTS MAKE EVERY ENTRY TIE, SO ALL INDICES STAY 0
+        if (color0 < color1) std::swap(color0, color1);
+
+        float endpoints[2][4];
+        From565(color0, endpoints[0]);
+        From565(color1, endpoints[1]);
+
+        Palette palette;
+        palette.count = 4;
+        for (int c = 0; c < 4; c++)
+        {
+            palette.channels[c][0] = endpoints[0][c];
+            palette.channels[c][1] = endpoints[1][c];
+            palette.channels[c][2] = (2.0f * endpoints[0][c] + endpoints[1][c]) / 3.0f;
+            palette.channels[c][3] = (endpoints[0][c] + 2.0f * endpoints[1][c]) / 3.0f;
+        }
+
+        uint32_t indices = 0;
+        float error = 0.0f;
+        float weight[16];
+
+        for (int i = 0; i < 16; i++)
+        {
+            int index = FindNearest(block.pixels[i], palette, WEIGHTS, error);
+            indices |= (uint32_t)index << (i * 2);
+            weight[i] = ENDPOINT_WEIGHT[index];
+        }
+
+        if (error < bestError)
+        {
+            bestError = error;
+            bestColors[0] = color0;
+            bestColors[1] = color1;
+            bestIndices = indices;
+        }
+
+        if (pass == passes || color0 == color1 || !RefineEndpoints(block, 3, weight, high, low)) break;
+    }
+
+    out[0] = (uint8_t)(bestColors[0] & 0xFF);
+    out[1] = (uint8_t)(bestColors[0] >> 8);
+    out[2] = (uint8_t)(bestColors[1] & 0xFF);
+    out[3] = (uint8_t)(bestColors[1] >> 8);
+    for (int i = 0; i < 4; i++) out[4 + i] = (uint8_t)(bestIndices >> (i * 8));
+}
+
+static void EncodeBC4(const Block& block, int channel, BlockQuality quality, uint8_t* out)
+{
+    int minimum = 255;
+    int maximum = 0;
+    for (int i = 0; i < 16; i++)
+    {
+        minimum = std::min(minimum, (int)block.pixels[i][channel]);
+        maximum = std::max(maximum, (int)block.pixels[i][channel]);
+    }
+
+    int bestEndpoints[2] = { maximum, minimum };
+    uint64_t bestIndices = 0;
+    int bestError = INT32_MAX;
+
+    //HIGH QUALITY ALSO TRIES ENDPOINTS PULLED INWARDS, THE EXTREMES ARE RARELY THE BEST FIT
+    int numInsets = quality == BlockQuality::High ? 4 : 1;
+
+    for (int inset = 0; inset < numInsets; inset++)
+    {
+        int shrink = (maximum - minimum) * inset / 32;
+        int a0 = maximum - shrink;
+        int a1 = minimum + shrink;
+
+        int palette[8] = { a0, a1 };
+        for (int i = 2; i < 8; i++) palette[i] = ((8 - i) * a0 + (i - 1) * a1 + 3) / 7;
+
+        uint64_t indices = 0;
+        int error = 0;
+
+        for (int i = 0; i < 16; i++)
+        {
+            int value = (int)block.pixels[i][channel];
+            int best = 0;
+            int bestDistance = INT32_MAX;
+
+            for (int p = 0; p < (a0 > a1 ? 8 : 1); p++)
+            {
+                int distance = (palette[p] - value) * (palette[p] - value);
+                if (distance < bestDistance)
+                {
+                    bestDistance = distance;
+                    best = p;
+                }
+            }
+
+            error += bestDistance;
+            indices |= (uint64_t)best << (i * 3);
+        }
+
+        if (error < bestError)
+        {
+            bestError = error;
+            bestEndpoints[0] = a0;
+            bestEndpoints[1] = a1;
+            bestIndices = indices;
+        }
+    }
+
+    out[0] = (uint8_t)bestEndpoints[0];
+    out[1] = (uint8_t)bestEndpoints[1];
+    for (int i = 0; i < 6; i++) out[2 + i] = (uint8_t)(bestIndices >> (i * 8));
+}
+
+//7 bit endpoint plus shared p-bit per endpoint, the p-bit is picked for the lowest quantisation error
+static void QuantizeBC7Endpoint(const float* color, int* quantized, int& pBit)
+{
+    float bestError = FLT_MAX;
+
+    for (int p = 0; p < 2; p++)
+    {
+        int candidate[4];
+        float error = 0.0f;
+
+        for (int c = 0; c < 4; c++)
+        {
+            candidate[c] = std::min(std::max((int)std::lround((color[c] - p) / 2.0f), 0), 127);
+            float diff = (float)(candidate[c] * 2 + p) - color[c];
+            error += diff * diff;
+        }
+
+        if (error < bestError)
+        {
+            bestError = error;
+            pBit = p;
+            for (int c = 0; c < 4; c++) quantized[c] = candidate[c];
+        }
+    }
+}
+
+static void WriteBits(uint64_t* bits, int& position, uint32_t value, int count)
+{
+    for (int i = 0; i < count; i++, position++)
+    {
+        if (value & (1u << i)) bits[position / 64] |= 1ull << (position % 64);
+    }
+}
+
+static void EncodeBC7(const Block& block, BlockQuality quality, uint8_t* out)
+{
+    static const float WEIGHTS[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+    float endpoints[2][4];
+    FitPrincipalAxis(block, 4, endpoints[0], endpoints[1]);
+
+    int bestQuantized[2][4] = {};
+    int bestPBits[2] = {};
+    int bestIndices[16] = {};
+    float bestError = FLT_MAX;
+    int passes = quality == BlockQuality::High ? REFINE_PASSES : 0;
+
+    for (int pass = 0; pass <= passes; pass++)
+    {
+        int quantized[2][4];
+        int pBits[2];
+        QuantizeBC7Endpoint(endpoints[0], quantized[0], pBits[0]);
+        QuantizeBC7Endpoint(endpoints[1], quantized[1], pBits[1]);
+
+        Palette palette;
+        palette.count = 16;
+        for (int c = 0; c < 4; c++)
+        {
+            int e0 = quantized[0][c] * 2 + pBits[0];
+            int e1 = quantized[1][c] * 2 + pBits[1];
+            for (int i = 0; i < 16; i++)
+            {
+                palette.channels[c][i] = (float)(((64 - BC7_WEIGHTS[i]) * e0 + BC7_WEIGHTS[i] * e1 + 32) >> 6);
+            }
+        }
+
+        int indices[16];
+        float weight[16];
+        float error = 0.0f;
+
+        for (int i = 0; i < 16; i++)
+        {
+            indices[i] = FindNearest(block.pixels[i], palette, WEIGHTS, error);
+            weight[i] = BC7_WEIGHTS[indices[i]] / 64.0f;
+        }
+
+        if (error < bestError)
+        {
+            bestError = error;
+            std::copy(&quantized[0][0], &quantized[0][0] + 8, &bestQuantized[0][0]);
+            bestPBits[0] = pBits[0];
+            bestPBits[1] = pBits[1];
+            std::copy(indices, indices + 16, bestIndices);
+        }
+
+        if (pass == passes || !RefineEndpoints(block, 4, weight, endpoints[0], endpoints[1])) break;
+    }
+
+    //THE ANCHOR INDEX DROPS ITS HIGH BIT, SO IT MUST BE BELOW 8
+    if (bestIndices[0] >= 8)
+    {
+        for (int c = 0; c < 4; c++) std::swap(bestQuantized[0][c], bestQuantized[1][c]);
+        std::swap(bestPBits[0], bestPBits[1]);
+        for (int i = 0; i < 16; i++) bestIndices[i] = 15 - bestIndices[i];
+    }
+
+    uint64_t bits[2] = { 0, 0 };
+    int position = 0;
+
+    WriteBits(bits, position, 1u << 6, 7);
+    for (int c = 0; c < 4; c++)
+    {
+        WriteBits(bits, position, bestQuantized[0][c], 7);
+        WriteBits(bits, position, bestQuantized[1][c], 7);
+    }
+    WriteBits(bits, position, bestPBits[0], 1);
+    WriteBits(bits, position, bestPBits[1], 1);
+    for (int i = 0; i < 16; i++) WriteBits(bits, position, bestIndices[i], i == 0 ? 3 : 4);
+
+    for (int i = 0; i < 16; i++) out[i] = (uint8_t)(bits[i / 8] >> ((i % 8) * 8));
+}
+
+void CompressBlocks(TextureFormat format, const uint8_t* rgba, uint32_t width, uint32_t height, BlockQuality quality, uint8_t* blocks)
+{
+    uint32_t blocksX = (width + 3) / 4;
+    uint32_t blocksY = (height + 3) / 4;
+    size_t blockBytes = GetBlockBytes(format);
+
+    JobSystem::GetInstance().ParallelFor(blocksY, BLOCK_ROWS_PER_JOB, [&](size_t begin, size_t end) {
+        Block block;
+
+        for (size_t y = begin; y < end; y++)
+        {
+            for (uint32_t x = 0; x < blocksX; x++)
+            {
+                FetchBlock(rgba, width, height, x, (uint32_t)y, block);
+                uint8_t* out = blocks + (y * blocksX + x) * blockBytes;
+
+                switch (format)
+                {
+                case TextureFormat::BC1:
+                    EncodeBC1(block, quality, out);
+                    break;
+                case TextureFormat::BC3:
+                    EncodeBC4(block, 3, quality, out);
+                    EncodeBC1(block, quality, out + 8);
+                    break;
+                case TextureFormat::BC5:
+                    EncodeBC4(block, 0, quality, out);
+                    EncodeBC4(block, 1, quality, out + 8);
+                    break;
+                case TextureFormat::BC7:
+                    EncodeBC7(block, quality, out);
+                    break;
+                default:
+                    break;
+                }
+            }
+        }
+    });
+}
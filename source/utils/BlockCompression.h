@@ -0,0 +1,18 @@
+#pragma once
+#include "TextureFile.h"
+#include <cstdint>
+#include <cstddef>
+
+enum class BlockQuality
+{
+    Fast,
+    High
+};
+
+//Fast fits the endpoints along the principal axis. High adds least squares refinement passes and more BC4 candidates.
+//BC1 is opaque four colour mode, BC3 is BC1 colour plus BC4 alpha, BC5 is BC4 red and green and BC7 uses mode 6 only.
+bool IsBlockCompressed(TextureFormat format);
+size_t GetBlockBytes(TextureFormat format);
+
+//Encodes a width*height RGBA8 image into 4x4 blocks, rows of blocks in parallel. Edges repeat the last texel.
+void CompressBlocks(TextureFormat format, const uint8_t* rgba, uint32_t width, uint32_t height, BlockQuality quality, uint8_t* blocks);
@@ -0,0 +1,114 @@
+#include "FileIndex.h"
+#include "FilePath.h"
+#include "Log.h"
+
+#include "SDL3/SDL_filesystem.h"
+#include <algorithm>
+#include <cctype>
+
+//DEEP ENOUGH FOR ANY TEXTURE LAYOUT, AND A LINK LOOP CAN'T RECURSE FOREVER
+#define FILE_INDEX_MAX_DEPTH 16
+
+static std::string ToKey(const std::string& path)
+{
+    std::string key = CanonicalPath(path);
+    std::transform(key.begin(), key.end(), key.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    return key;
+}
+
+FileIndex::FileIndex(const std::string& directoryPath) : root(directoryPath)
+{
+}
+
+std::string FileIndex::Find(const std::string& fileName)
+{
+    EnsureScanned();
+
+    auto it = byName.find(ToKey(fileName));
+    return it != byName.end() ? it->second.path : "";
+}
+
+std::string FileIndex::FindRelative(const std::string& relativePath)
+{
+    EnsureScanned();
+
+    std::string key = ToKey(relativePath);
+
+    auto it = byRelativePath.find(key);
+    if (it != byRelativePath.end()) return it->second;
+
+    //OUTSIDE THE INDEXED DIRECTORY, ONE PROBE PER PATH
+    bool absolute = (!key.empty() && key[0] == '/') || key.find(':') != std::string::npos;
+    bool outside = absolute || key.compare(0, 3, "../") == 0;
+    if (!outside || misses.count(key) > 0) return "";
+
+    std::string path = absolute ? relativePath : root + relativePath;
+    if (SDL_GetPathInfo(path.c_str(), nullptr))
+    {
+        byRelativePath[key] = path;
+        return path;
+    }
+
+    misses.insert(key);
+    return "";
+}
+
+size_t FileIndex::GetNumFiles()
+{
+    EnsureScanned();
+    return byRelativePath.size();
+}
+
+void FileIndex::EnsureScanned()
+{
+    if (scanned) return;
+    scanned = true;
+
+    Scan("", 0);
+    LOG("Indexed %d files under %s", (int)byName.size(), root.empty() ? "." : root.c_str());
+}
+
+void FileIndex::Scan(const std::string& relativeDirectory, int depth)
+{
+    if (depth > FILE_INDEX_MAX_DEPTH) return;
+
+    struct ScanData {
+        FileIndex* index;
+        const std::string* relativeDirectory;
+        int depth;
+    } data{ this, &relativeDirectory, depth };
+
+    std::string directory = root + relativeDirectory;
+
+    SDL_EnumerateDirectory(
+        directory.empty() ? "." : directory.c_str(),
+        [](void* userdata, const char*, const char* fname) -> SDL_EnumerationResult {
+            auto* d = static_cast<ScanData*>(userdata);
+            std::string relativePath = *d->relativeDirectory + fname;
+            std::string path = d->index->root + relativePath;
+
+            SDL_PathInfo info;
+            if (!SDL_GetPathInfo(path.c_str(), &info)) return SDL_ENUM_CONTINUE;
+
+            if (info.type == SDL_PATHTYPE_DIRECTORY)
+            {
+                d->index->Scan(relativePath + "/", d->depth + 1);
+            }
+            else if (info.type == SDL_PATHTYPE_FILE)
+            {
+                d->index->byRelativePath[ToKey(relativePath)] = path;
+
+                //THE SHALLOWEST FILE WINS, A TEXTURE NEXT TO THE MODEL BEFORE ONE IN A SUBDIRECTORY
+                Entry& entry = d->index->byName[ToKey(fname)];
+                if (entry.path.empty() || d->depth < entry.depth)
+                {
+                    entry.path = path;
+                    entry.depth = d->depth;
+                }
+            }
+
+            return SDL_ENUM_CONTINUE;
+        },
+        &data
+    );
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+//Every file under a directory, by name and by path relative to it, both without case. The directory is scanned once,
+//recursively, on the first lookup, so resolving hundreds of material textures costs one enumeration instead of one
+//per material. Misses are remembered as well. Meant to live for one import, files added later aren't seen.
+class FileIndex
+{
+public:
+    //directoryPath as GetDirectoryFromPath returns it, empty for the working directory
+    explicit FileIndex(const std::string& directoryPath);
+
+    //The file with that name closest to the directory, empty if there is none
+    std::string Find(const std::string& fileName);
+
+    //The file at that path relative to the directory. Absolute paths and paths leaving it are checked on disk.
+    std::string FindRelative(const std::string& relativePath);
+
+    size_t GetNumFiles();
+
+private:
+    void Scan(const std::string& relativeDirectory, int depth);
+    void EnsureScanned();
+
+private:
+    struct Entry
+    {
+        std::string path;
+        int depth = 0;
+    };
+
+    std::string root;
+    bool scanned = false;
+
+    std::unordered_map<std::string, Entry> byName;
+    std::unordered_map<std::string, std::string> byRelativePath;
+    std::unordered_set<std::string> misses;
+};
@@ -0,0 +1,100 @@
+#include "FilePath.h"
+
+#include "SDL3/SDL_filesystem.h"
+#include "SDL3/SDL_timer.h"
+#include <algorithm>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <cstdio>
+#include <cctype>
+
+std::string GetDirectoryFromPath(const std::string& filePath)
+{
+    size_t pos = filePath.find_last_of("\\/");
+    return (std::string::npos == pos) ? "" : filePath.substr(0, pos + 1);
+}
+
+std::string GetFileExtension(const std::string& filePath)
+{
+    size_t pos = filePath.find_last_of(".");
+    if (std::string::npos == pos) return "";
+
+    std::string ext = filePath.substr(pos + 1);
+
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+        [](unsigned char c) { return std::tolower(c); });
+
+    return ext;
+}
+
+std::string GetFileName(const std::string& filePath)
+{
+    size_t pos = filePath.find_last_of("/\\");
+    if (std::string::npos == pos) return filePath;
+    return filePath.substr(pos + 1);
+}
+
+std::string CanonicalPath(const std::string& path)
+{
+    std::string normalized = path;
+    std::replace(normalized.begin(), normalized.end(), '\\', '/');
+
+#ifdef _WIN32
+    std::transform(normalized.begin(), normalized.end(), normalized.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+#endif
+
+    //RESOLVE "." AND ".." SEGMENTS
+    std::vector<std::string> segments;
+    size_t start = 0;
+
+    while (start <= normalized.size())
+    {
+        size_t end = normalized.find('/', start);
+        if (end == std::string::npos) end = normalized.size();
+
+        std::string segment = normalized.substr(start, end - start);
+
+        if (segment == "..")
+        {
+            if (!segments.empty() && segments.back() != ".." && !segments.back().empty()) segments.pop_back();
+            else segments.push_back(segment);
+        }
+        else if (segment != "." && (!segment.empty() || segments.empty()))
+        {
+            segments.push_back(segment);
+        }
+
+        start = end + 1;
+    }
+
+    std::string canonical;
+    for (size_t i = 0; i < segments.size(); i++)
+    {
+        if (i > 0) canonical += '/';
+        canonical += segments[i];
+    }
+
+    return canonical;
+}
+
+std::string GetTemporaryPath(const std::string& path)
+{
+    static std::atomic<unsigned int> counter{ 0 };
+
+    //THE THREAD AND THE TIME TELL WRITERS IN OTHER PROCESSES APART, THE COUNTER THE WRITES OF ONE THREAD
+    size_t thread = std::hash<std::thread::id>()(std::this_thread::get_id());
+    char suffix[64];
+    snprintf(suffix, sizeof(suffix), ".%llx_%llx_%x.tmp", (unsigned long long)thread, (unsigned long long)SDL_GetTicksNS(), counter++);
+
+    return path + suffix;
+}
+
+bool ReplaceWithFile(const std::string& temporaryPath, const std::string& path)
+{
+    if (SDL_RenamePath(temporaryPath.c_str(), path.c_str())) return true;
+
+    SDL_RemovePath(temporaryPath.c_str());
+    return false;
+}
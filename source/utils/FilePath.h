@@ -0,0 +1,18 @@
+#pragma once
+#include <string>
+
+//Directory part including the trailing separator, empty if there is none
+std::string GetDirectoryFromPath(const std::string& filePath);
+
+//Lower case, without the dot
+std::string GetFileExtension(const std::string& filePath);
+std::string GetFileName(const std::string& filePath);
+
+//Forward slashes, "." and ".." resolved and lower case on Windows, so one file has one key
+std::string CanonicalPath(const std::string& path);
+
+//A name next to path no other thread or process writes to, for files that must never be read half written
+std::string GetTemporaryPath(const std::string& path);
+
+//Moves a finished temporary file over path in one step, readers see the old file or the new one. Removes it on failure.
+bool ReplaceWithFile(const std::string& temporaryPath, const std::string& path);
@@ -0,0 +1,15 @@
+#include "Hash.h"
+
+uint64_t HashFNV1a(const void* data, size_t size, uint64_t seed)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint64_t hash = seed;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= FNV1A_PRIME;
+    }
+
+    return hash;
+}
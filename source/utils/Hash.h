@@ -0,0 +1,9 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+
+#define FNV1A_OFFSET_BASIS 0xcbf29ce484222325ull
+#define FNV1A_PRIME 0x100000001b3ull
+
+//64 bit FNV-1a. Pass the previous result as seed to hash several blocks as one stream.
+uint64_t HashFNV1a(const void* data, size_t size, uint64_t seed = FNV1A_OFFSET_BASIS);
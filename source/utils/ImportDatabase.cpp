@@ -0,0 +1,177 @@
+#include "ImportDatabase.h"
+#include "FilePath.h"
+#include "MappedFile.h"
+#include "Hash.h"
+#include "Log.h"
+
+#include "SDL3/SDL_filesystem.h"
+#include "pugixml.hpp"
+
+#define IMPORT_DATABASE_VERSION 1
+
+static bool GetSourceInfo(const std::string& path, int64_t& modifyTime, uint64_t& size)
+{
+    SDL_PathInfo info;
+    if (!SDL_GetPathInfo(path.c_str(), &info) || info.type != SDL_PATHTYPE_FILE) return false;
+
+    modifyTime = info.modify_time;
+    size = info.size;
+    return true;
+}
+
+static bool HashSource(const std::string& path, uint64_t& hash)
+{
+    MappedFile file;
+    if (!file.Open(path)) return false;
+
+    hash = HashFNV1a(file.GetData(), file.GetSize());
+    return true;
+}
+
+bool ImportDatabase::Find(const std::string& sourcePath, uint64_t settingsHash, ImportRecord& found)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!loaded) Load();
+
+    auto it = records.find(CanonicalPath(sourcePath));
+    if (it == records.end()) return false;
+
+    ImportRecord& record = it->second;
+    if (record.settingsHash != settingsHash) return false;
+
+    int64_t modifyTime = 0;
+    uint64_t size = 0;
+    if (!GetSourceInfo(sourcePath, modifyTime, size)) return false;
+
+    //TOUCHED BUT MAYBE NOT CHANGED (A COPY, A CHECKOUT), ONLY THE CONTENTS DECIDE
+    if (modifyTime != record.modifyTime || size != record.size)
+    {
+        uint64_t contentHash = 0;
+        if (size != record.size || !HashSource(sourcePath, contentHash) || contentHash != record.contentHash) return false;
+
+        record.modifyTime = modifyTime;
+        if (autoSave) SaveLocked();
+    }
+
+    if (!SDL_GetPathInfo(record.cookedPath.c_str(), nullptr)) return false;
+
+    for (const std::string& artifact : record.artifacts)
+    {
+        if (!SDL_GetPathInfo(artifact.c_str(), nullptr))
+        {
+            LOG("Import of %s is missing %s", sourcePath.c_str(), artifact.c_str());
+            return false;
+        }
+    }
+
+    found = record;
+    return true;
+}
+
+bool ImportDatabase::Record(const std::string& sourcePath, uint64_t settingsHash, const std::string& cookedPath, const std::vector<std::string>& artifacts)
+{
+    ImportRecord record;
+    record.sourcePath = CanonicalPath(sourcePath);
+    record.settingsHash = settingsHash;
+    record.cookedPath = cookedPath;
+    record.artifacts = artifacts;
+
+    if (!GetSourceInfo(sourcePath, record.modifyTime, record.size) || !HashSource(sourcePath, record.contentHash))
+    {
+        LOG("Error: Could not read %s to record its import", sourcePath.c_str());
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!loaded) Load();
+
+    records[record.sourcePath] = std::move(record);
+    return !autoSave || SaveLocked();
+}
+
+void ImportDatabase::Forget(const std::string& sourcePath)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!loaded) Load();
+
+    if (records.erase(CanonicalPath(sourcePath)) > 0 && autoSave) SaveLocked();
+}
+
+bool ImportDatabase::IsRecorded(const std::string& sourcePath)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!loaded) Load();
+
+    return records.count(CanonicalPath(sourcePath)) > 0;
+}
+
+bool ImportDatabase::Save()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return SaveLocked();
+}
+
+void ImportDatabase::Load()
+{
+    loaded = true;
+
+    pugi::xml_document doc;
+    if (!doc.load_file(IMPORT_DATABASE_PATH)) return;
+
+    //AN OLDER LAYOUT IS DROPPED, EVERYTHING IS IMPORTED AGAIN
+    pugi::xml_node importsNode = doc.child("Imports");
+    if (importsNode.attribute("version").as_int() != IMPORT_DATABASE_VERSION) return;
+
+    for (pugi::xml_node assetNode = importsNode.child("Asset"); assetNode; assetNode = assetNode.next_sibling("Asset"))
+    {
+        ImportRecord record;
+        record.sourcePath = assetNode.attribute("source").as_string();
+        record.modifyTime = assetNode.attribute("modifyTime").as_llong();
+        record.size = assetNode.attribute("size").as_ullong();
+        record.contentHash = assetNode.attribute("contentHash").as_ullong();
+        record.settingsHash = assetNode.attribute("settingsHash").as_ullong();
+        record.cookedPath = assetNode.attribute("cooked").as_string();
+
+        for (pugi::xml_node artifactNode = assetNode.child("Artifact"); artifactNode; artifactNode = artifactNode.next_sibling("Artifact"))
+        {
+            record.artifacts.push_back(artifactNode.attribute("path").as_string());
+        }
+
+        if (!record.sourcePath.empty()) records[record.sourcePath] = std::move(record);
+    }
+
+    LOG("Import database loaded: %d assets", (int)records.size());
+}
+
+bool ImportDatabase::SaveLocked()
+{
+    pugi::xml_document doc;
+    pugi::xml_node importsNode = doc.append_child("Imports");
+    importsNode.append_attribute("version") = IMPORT_DATABASE_VERSION;
+
+    for (const auto& pair : records)
+    {
+        const ImportRecord& record = pair.second;
+
+        pugi::xml_node assetNode = importsNode.append_child("Asset");
+        assetNode.append_attribute("source") = record.sourcePath.c_str();
+        assetNode.append_attribute("modifyTime") = (long long)record.modifyTime;
+        assetNode.append_attribute("size") = (unsigned long long)record.size;
+        assetNode.append_attribute("contentHash") = (unsigned long long)record.contentHash;
+        assetNode.append_attribute("settingsHash") = (unsigned long long)record.settingsHash;
+        assetNode.append_attribute("cooked") = record.cookedPath.c_str();
+
+        for (const std::string& artifact : record.artifacts)
+        {
+            assetNode.append_child("Artifact").append_attribute("path") = artifact.c_str();
+        }
+    }
+
+    if (!doc.save_file(IMPORT_DATABASE_PATH))
+    {
+        LOG("Error: Could not save the import database %s", IMPORT_DATABASE_PATH);
+        return false;
+    }
+
+    return true;
+}
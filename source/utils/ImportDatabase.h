@@ -0,0 +1,60 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+
+#define IMPORT_DATABASE_PATH "Library/Imports.W16DB"
+
+//What one source asset was cooked into and the state of the source when it was
+struct ImportRecord
+{
+    std::string sourcePath;
+    int64_t modifyTime = 0;
+    uint64_t size = 0;
+    uint64_t contentHash = 0;
+    uint64_t settingsHash = 0;
+
+    //THE FILE LOADED INSTEAD OF THE SOURCE, AND EVERYTHING IT NEEDS
+    std::string cookedPath;
+    std::vector<std::string> artifacts;
+};
+
+//Maps source assets to their Library artifacts so they are only imported once. A record stays valid while the source
+//keeps its size and modification time (or, when those change, its content hash), the importer settings match and
+//every artifact is still on disk. Kept in Library/Imports.W16DB, loaded on first use and saved on every change unless
+//autoSave is off. Safe to use from several threads.
+class ImportDatabase
+{
+public:
+    static ImportDatabase& GetInstance() {
+        static ImportDatabase instance;
+        return instance;
+    }
+
+    //False if the source has to be imported again
+    bool Find(const std::string& sourcePath, uint64_t settingsHash, ImportRecord& record);
+
+    bool Record(const std::string& sourcePath, uint64_t settingsHash, const std::string& cookedPath, const std::vector<std::string>& artifacts);
+    void Forget(const std::string& sourcePath);
+
+    //Imported at some point, whether or not the record is still valid
+    bool IsRecorded(const std::string& sourcePath);
+
+    bool Save();
+
+    size_t GetNumRecords() const { return records.size(); }
+
+public:
+    bool autoSave = true;
+
+private:
+    void Load();
+    bool SaveLocked();
+
+private:
+    std::unordered_map<std::string, ImportRecord> records;
+    std::mutex mutex;
+    bool loaded = false;
+};
@@ -0,0 +1,119 @@
+#include "JobSystem.h"
+#include <atomic>
+#include <algorithm>
+#include <memory>
+
+struct ParallelForState
+{
+    std::atomic<size_t> nextBatch{ 0 };
+    std::atomic<size_t> finishedBatches{ 0 };
+    size_t numBatches = 0;
+    size_t count = 0;
+    size_t batchSize = 0;
+    const std::function<void(size_t, size_t)>* job = nullptr;
+    std::mutex mutex;
+    std::condition_variable done;
+};
+
+static void RunBatches(ParallelForState& state)
+{
+    while (true)
+    {
+        size_t batch = state.nextBatch.fetch_add(1);
+        if (batch >= state.numBatches) return;
+
+        size_t begin = batch * state.batchSize;
+        size_t end = std::min(begin + state.batchSize, state.count);
+        (*state.job)(begin, end);
+
+        if (state.finishedBatches.fetch_add(1) + 1 == state.numBatches)
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            state.done.notify_all();
+        }
+    }
+}
+
+JobSystem::JobSystem() : stopping(false)
+{
+    unsigned int numThreads = std::thread::hardware_concurrency();
+    numThreads = numThreads > 1 ? numThreads - 1 : 1;
+
+    for (unsigned int i = 0; i < numThreads; i++)
+    {
+        workers.emplace_back(&JobSystem::WorkerLoop, this);
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    condition.notify_all();
+
+    for (std::thread& worker : workers)
+    {
+        if (worker.joinable()) worker.join();
+    }
+}
+
+void JobSystem::Submit(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push(std::move(job));
+    }
+    condition.notify_one();
+}
+
+void JobSystem::ParallelFor(size_t count, size_t batchSize, const std::function<void(size_t begin, size_t end)>& job)
+{
+    if (count == 0) return;
+    if (batchSize == 0) batchSize = 1;
+
+    size_t numBatches = (count + batchSize - 1) / batchSize;
+
+    if (numBatches == 1)
+    {
+        job(0, count);
+        return;
+    }
+
+    std::shared_ptr<ParallelForState> state = std::make_shared<ParallelForState>();
+    state->numBatches = numBatches;
+    state->count = count;
+    state->batchSize = batchSize;
+    state->job = &job;
+
+    size_t helpers = std::min(numBatches - 1, workers.size());
+    for (size_t i = 0; i < helpers; i++)
+    {
+        Submit([state]() { RunBatches(*state); });
+    }
+
+    //THE CALLING THREAD WORKS TOO, SO NESTED CALLS FROM WORKERS CAN'T DEADLOCK
+    RunBatches(*state);
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done.wait(lock, [&state]() { return state->finishedBatches.load() == state->numBatches; });
+}
+
+void JobSystem::WorkerLoop()
+{
+    while (true)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            condition.wait(lock, [this]() { return stopping || !jobs.empty(); });
+
+            if (stopping && jobs.empty()) return;
+
+            job = std::move(jobs.front());
+            jobs.pop();
+        }
+        job();
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <functional>
+#include <thread>
+#include <vector>
+#include <queue>
+#include <mutex>
+#include <condition_variable>
+
+class JobSystem
+{
+public:
+    static JobSystem& GetInstance() {
+        static JobSystem instance;
+        return instance;
+    }
+
+    void Submit(std::function<void()> job);
+
+    //Splits [0, count) into batches and runs them on the workers and the calling thread. Returns when every batch is done.
+    void ParallelFor(size_t count, size_t batchSize, const std::function<void(size_t begin, size_t end)>& job);
+
+    int GetWorkerCount() const { return (int)workers.size(); }
+
+private:
+    JobSystem();
+    ~JobSystem();
+
+    void WorkerLoop();
+
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool stopping;
+};
@@ -3,12 +3,17 @@
 #include <cstdarg>
 #include <cstdio>
 #include <string>
+#include <mutex>
 
 void Log(const char file[], int line, const char* format, ...)
 {
     static char tmp_string[4096];
     static char tmp_string2[4096];
     static va_list ap;
+    static std::mutex mutex;
+
+    //THE FORMAT BUFFERS ARE SHARED
+    std::lock_guard<std::mutex> lock(mutex);
 
     va_start(ap, format);
     vsprintf_s(tmp_string, 4096, format, ap);
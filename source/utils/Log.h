@@ -6,6 +6,7 @@
 #include <cstdarg>
 #include <string>
 #include <vector>
+#include <mutex>
 
 class LogBuffer
 {
@@ -15,7 +16,9 @@ public:
         return instance;
     }
 
+    //Workers log too, messages are only touched under the lock
     void AddMessage(const std::string& msg) {
+        std::lock_guard<std::mutex> lock(mutex);
         messages.push_back(msg);
 
         if (messages.size() > 500) {
@@ -23,12 +26,14 @@ public:
         }
     }
 
-    const std::vector<std::string>& GetMessages() const {
+    std::vector<std::string> GetMessages() {
+        std::lock_guard<std::mutex> lock(mutex);
         return messages;
     }
 
 private:
     std::vector<std::string> messages;
+    std::mutex mutex;
 };
 
 #define LOG(format, ...) Log(__FILE__, __LINE__, format, ##__VA_ARGS__)
@@ -0,0 +1,125 @@
+#include "MappedFile.h"
+#include "Log.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+{
+}
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::string& path)
+{
+    Close();
+
+    //SHARED FOR DELETE, SO A COOK CAN MOVE A NEW FILE OVER THIS ONE WHILE IT IS STILL MAPPED
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        LOG("Error: Could not open file for mapping: %s", path.c_str());
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+    {
+        LOG("Error: Empty or unreadable file: %s", path.c_str());
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr)
+    {
+        LOG("Error: Could not create file mapping: %s", path.c_str());
+        CloseHandle(file);
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (view == nullptr)
+    {
+        LOG("Error: Could not map view of file: %s", path.c_str());
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    fileHandle = file;
+    mappingHandle = mapping;
+    data = static_cast<const uint8_t*>(view);
+    size = (size_t)fileSize.QuadPart;
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (data) UnmapViewOfFile(data);
+    if (mappingHandle) CloseHandle((HANDLE)mappingHandle);
+    if (fileHandle) CloseHandle((HANDLE)fileHandle);
+
+    data = nullptr;
+    size = 0;
+    fileHandle = nullptr;
+    mappingHandle = nullptr;
+}
+
+#else
+
+bool MappedFile::Open(const std::string& path)
+{
+    Close();
+
+    int file = open(path.c_str(), O_RDONLY);
+    if (file < 0)
+    {
+        LOG("Error: Could not open file for mapping: %s", path.c_str());
+        return false;
+    }
+
+    struct stat fileStat;
+    if (fstat(file, &fileStat) != 0 || fileStat.st_size == 0)
+    {
+        LOG("Error: Empty or unreadable file: %s", path.c_str());
+        close(file);
+        return false;
+    }
+
+    void* view = mmap(nullptr, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    if (view == MAP_FAILED)
+    {
+        LOG("Error: Could not map file: %s", path.c_str());
+        close(file);
+        return false;
+    }
+
+    fileDescriptor = file;
+    data = static_cast<const uint8_t*>(view);
+    size = (size_t)fileStat.st_size;
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if (data) munmap(const_cast<uint8_t*>(data), size);
+    if (fileDescriptor >= 0) close(fileDescriptor);
+
+    data = nullptr;
+    size = 0;
+    fileDescriptor = -1;
+}
+
+#endif
@@ -0,0 +1,33 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+//Read only memory mapping of a whole file. The data stays valid until Close() or destruction.
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool Open(const std::string& path);
+    void Close();
+
+    const uint8_t* GetData() const { return data; }
+    size_t GetSize() const { return size; }
+    bool IsOpen() const { return data != nullptr; }
+
+private:
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#else
+    int fileDescriptor = -1;
+#endif
+};
@@ -0,0 +1,49 @@
+#include "MeshCache.h"
+#include "MeshResidency.h"
+
+MeshResource* MeshCache::Find(const std::string& libraryPath)
+{
+    auto it = byPath.find(libraryPath);
+    return it != byPath.end() ? it->second : nullptr;
+}
+
+MeshResource* MeshCache::Create(const std::string& libraryPath, uint64_t contentHash, const MeshData& meshData, const glm::vec3& aabbMin, const glm::vec3& aabbMax, std::vector<Meshlet> meshlets)
+{
+    MeshResource* resource = new MeshResource();
+    resource->libraryPath = libraryPath;
+    resource->contentHash = contentHash;
+    resource->meshData = meshData;
+    resource->aabbMin = aabbMin;
+    resource->aabbMax = aabbMax;
+    resource->meshlets = std::move(meshlets);
+    resource->references = 1;
+
+    //THE OLD RESOURCE OF THE PATH STAYS WITH ITS USERS, IT IS JUST NO LONGER FOUND
+    byPath[libraryPath] = resource;
+    numResources++;
+
+    return resource;
+}
+
+void MeshCache::AddReference(MeshResource* resource)
+{
+    if (resource) resource->references++;
+}
+
+bool MeshCache::Release(MeshResource* resource)
+{
+    if (!resource || --resource->references > 0) return false;
+
+    auto it = byPath.find(resource->libraryPath);
+    if (it != byPath.end() && it->second == resource) byPath.erase(it);
+
+    MeshResidency::GetInstance().Unregister(resource);
+    delete resource;
+    numResources--;
+    return true;
+}
+
+void MeshCache::Forget(const std::string& libraryPath)
+{
+    byPath.erase(libraryPath);
+}
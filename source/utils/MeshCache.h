@@ -0,0 +1,56 @@
+#pragma once
+#include "../components/Mesh.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <glm/glm.hpp>
+
+//What every Mesh loaded from the same Library file shares: the GPU buffers, the bounds, the meshlets and the CPU copy
+//of the geometry. The CPU copy lives as long as the resource unless MeshResidency evicts it, and is paged in again
+//from the file, once for all the meshes, when one of them asks for it.
+struct MeshResource
+{
+    std::string libraryPath;
+    uint64_t contentHash = 0;
+    MeshData meshData;
+    glm::vec3 aabbMin = glm::vec3(0.0f);
+    glm::vec3 aabbMax = glm::vec3(0.0f);
+    std::vector<Meshlet> meshlets;
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    bool geometryResident = false;
+    int references = 0;
+};
+
+//Library path to the loaded MeshResource, so a model instanced many times is uploaded once. Only the newest load of a
+//path is found: a file written again gets a new resource while the old one lives on with the meshes still using it.
+//GL thread only.
+class MeshCache
+{
+public:
+    static MeshCache& GetInstance() {
+        static MeshCache instance;
+        return instance;
+    }
+
+    //nullptr if the path isn't loaded
+    MeshResource* Find(const std::string& libraryPath);
+
+    //Takes over the GPU buffers of a mesh that was just uploaded from the file, with one reference
+    MeshResource* Create(const std::string& libraryPath, uint64_t contentHash, const MeshData& meshData, const glm::vec3& aabbMin, const glm::vec3& aabbMax, std::vector<Meshlet> meshlets);
+
+    void AddReference(MeshResource* resource);
+
+    //True when it was the last reference. The resource is gone, the caller frees the GPU buffers it copied.
+    bool Release(MeshResource* resource);
+
+    //The next load of the path reads the file again. For files that were rewritten
+    void Forget(const std::string& libraryPath);
+
+    size_t GetNumResources() const { return numResources; }
+    size_t GetNumShared() const { return byPath.size(); }
+
+private:
+    std::unordered_map<std::string, MeshResource*> byPath;
+    size_t numResources = 0;
+};
@@ -0,0 +1,428 @@
+#include "MeshCodec.h"
+#include "JobSystem.h"
+
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+
+#define LZ_MIN_MATCH 4
+#define LZ_MAX_OFFSET 65535
+#define LZ_HASH_BITS 16
+#define LZ_LAST_LITERALS 8
+
+struct CodecChunk
+{
+    uint32_t count;
+    uint32_t filteredSize;
+    uint32_t encodedSize;
+};
+
+//LZ STAGE
+
+static uint32_t Read32(const uint8_t* data)
+{
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+static uint32_t HashSequence(uint32_t sequence)
+{
+    return (sequence * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+static uint8_t* WriteLength(uint8_t* out, size_t length)
+{
+    while (length >= 255)
+    {
+        *out++ = 255;
+        length -= 255;
+    }
+    *out++ = (uint8_t)length;
+    return out;
+}
+
+static uint8_t* WriteSequence(uint8_t* out, const uint8_t* literals, size_t numLiterals, size_t offset, size_t matchLength)
+{
+    uint8_t* token = out++;
+    size_t matchCode = matchLength ? matchLength - LZ_MIN_MATCH : 0;
+
+    *token = (uint8_t)((std::min(numLiterals, (size_t)15) << 4) | std::min(matchCode, (size_t)15));
+    if (numLiterals >= 15) out = WriteLength(out, numLiterals - 15);
+
+    memcpy(out, literals, numLiterals);
+    out += numLiterals;
+
+    //THE LAST SEQUENCE ONLY HAS LITERALS
+    if (matchLength == 0) return out;
+
+    *out++ = (uint8_t)(offset & 0xFF);
+    *out++ = (uint8_t)(offset >> 8);
+    if (matchCode >= 15) out = WriteLength(out, matchCode - 15);
+
+    return out;
+}
+
+size_t GetCompressLZBound(size_t inputSize)
+{
+    return inputSize + inputSize / 255 + 16;
+}
+
+size_t CompressLZ(const uint8_t* input, size_t inputSize, uint8_t* output)
+{
+    std::vector<uint32_t> table((size_t)1 << LZ_HASH_BITS, UINT32_MAX);
+
+    uint8_t* out = output;
+    size_t anchor = 0;
+    size_t position = 0;
+
+    if (inputSize > LZ_LAST_LITERALS + LZ_MIN_MATCH)
+    {
+        size_t matchLimit = inputSize - LZ_LAST_LITERALS;
+
+        while (position + LZ_MIN_MATCH <= matchLimit)
+        {
+            uint32_t sequence = Read32(input + position);
+            uint32_t hash = HashSequence(sequence);
+            uint32_t candidate = table[hash];
+            table[hash] = (uint32_t)position;
+
+            if (candidate == UINT32_MAX || position - candidate > LZ_MAX_OFFSET || Read32(input + candidate) != sequence)
+            {
+                //SKIP FASTER THROUGH DATA THAT DOESN'T COMPRESS
+                position += 1 + ((position - anchor) >> 6);
+                continue;
+            }
+
+            size_t matchLength = LZ_MIN_MATCH;
+            while (position + matchLength < matchLimit && input[candidate + matchLength] == input[position + matchLength]) matchLength++;
+
+            out = WriteSequence(out, input + anchor, position - anchor, position - candidate, matchLength);
+            position += matchLength;
+            anchor = position;
+        }
+    }
+
+    out = WriteSequence(out, input + anchor, inputSize - anchor, 0, 0);
+    return out - output;
+}
+
+static bool ReadLength(const uint8_t*& in, const uint8_t* end, size_t& length)
+{
+    uint8_t value;
+    do
+    {
+        if (in >= end) return false;
+        value = *in++;
+        length += value;
+    } while (value == 255);
+
+    return true;
+}
+
+bool DecompressLZ(const uint8_t* input, size_t inputSize, uint8_t* output, size_t outputSize)
+{
+    const uint8_t* in = input;
+    const uint8_t* inEnd = input + inputSize;
+    uint8_t* out = output;
+    uint8_t* outEnd = output + outputSize;
+
+    while (in < inEnd)
+    {
+        uint8_t token = *in++;
+
+        size_t numLiterals = token >> 4;
+        if (numLiterals == 15 && !ReadLength(in, inEnd, numLiterals)) return false;
+
+        if (numLiterals > (size_t)(inEnd - in) || numLiterals > (size_t)(outEnd - out)) return false;
+        memcpy(out, in, numLiterals);
+        in += numLiterals;
+        out += numLiterals;
+
+        if (in == inEnd) break;
+
+        if (inEnd - in < 2) return false;
+        size_t offset = in[0] | ((size_t)in[1] << 8);
+        in += 2;
+
+        size_t matchLength = token & 15;
+        if (matchLength == 15 && !ReadLength(in, inEnd, matchLength)) return false;
+        matchLength += LZ_MIN_MATCH;
+
+        if (offset == 0 || offset > (size_t)(out - output) || matchLength > (size_t)(outEnd - out)) return false;
+
+        const uint8_t* match = out - offset;
+        if (offset >= matchLength)
+        {
+            memcpy(out, match, matchLength);
+            out += matchLength;
+        }
+        else
+        {
+            //OVERLAPPING MATCH, REPEATS THE LAST offset BYTES
+            for (size_t i = 0; i < matchLength; i++) *out++ = match[i];
+        }
+    }
+
+    return out == outEnd;
+}
+
+//FILTERS
+
+static void FilterVertices(const uint8_t* vertices, size_t count, size_t stride, uint8_t* filtered)
+{
+    for (size_t byte = 0; byte < stride; byte++)
+    {
+        uint8_t* plane = filtered + byte * count;
+        uint8_t previous = 0;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            uint8_t value = vertices[i * stride + byte];
+            plane[i] = value - previous;
+            previous = value;
+        }
+    }
+}
+
+static void UnfilterVertices(const uint8_t* filtered, size_t count, size_t stride, uint8_t* vertices)
+{
+    for (size_t byte = 0; byte < stride; byte++)
+    {
+        const uint8_t* plane = filtered + byte * count;
+        uint8_t value = 0;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            value += plane[i];
+            vertices[i * stride + byte] = value;
+        }
+    }
+}
+
+static uint32_t ReadIndex(const uint8_t* indices, size_t i, size_t indexSize)
+{
+    if (indexSize == sizeof(uint16_t))
+    {
+        uint16_t value;
+        memcpy(&value, indices + i * sizeof(uint16_t), sizeof(value));
+        return value;
+    }
+
+    uint32_t value;
+    memcpy(&value, indices + i * sizeof(uint32_t), sizeof(value));
+    return value;
+}
+
+static void WriteIndex(uint8_t* indices, size_t i, size_t indexSize, uint32_t value)
+{
+    if (indexSize == sizeof(uint16_t))
+    {
+        uint16_t shortValue = (uint16_t)value;
+        memcpy(indices + i * sizeof(uint16_t), &shortValue, sizeof(shortValue));
+    }
+    else
+    {
+        memcpy(indices + i * sizeof(uint32_t), &value, sizeof(value));
+    }
+}
+
+static size_t FilterIndices(const uint8_t* indices, size_t count, size_t indexSize, uint8_t* filtered)
+{
+    uint8_t* out = filtered;
+    uint32_t previous = 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t index = ReadIndex(indices, i, indexSize);
+        int32_t delta = (int32_t)(index - previous);
+        uint32_t zigzag = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+        previous = index;
+
+        while (zigzag >= 0x80)
+        {
+            *out++ = (uint8_t)(zigzag | 0x80);
+            zigzag >>= 7;
+        }
+        *out++ = (uint8_t)zigzag;
+    }
+
+    return out - filtered;
+}
+
+static bool UnfilterIndices(const uint8_t* filtered, size_t filteredSize, size_t count, size_t indexSize, uint8_t* indices)
+{
+    const uint8_t* in = filtered;
+    const uint8_t* end = filtered + filteredSize;
+    uint32_t previous = 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        uint32_t zigzag = 0;
+        int shift = 0;
+
+        while (true)
+        {
+            if (in >= end || shift > 28) return false;
+            uint8_t byte = *in++;
+            zigzag |= (uint32_t)(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) break;
+            shift += 7;
+        }
+
+        int32_t delta = (int32_t)(zigzag >> 1) ^ -(int32_t)(zigzag & 1);
+        previous += (uint32_t)delta;
+        WriteIndex(indices, i, indexSize, previous);
+    }
+
+    return in == end;
+}
+
+//CHUNKED STREAMS
+
+static void EncodeStream(const uint8_t* data, size_t count, size_t elementSize, size_t chunkElements, bool indices, std::vector<uint8_t>& encoded)
+{
+    size_t numChunks = (count + chunkElements - 1) / chunkElements;
+    std::vector<CodecChunk> chunks(numChunks);
+    std::vector<std::vector<uint8_t>> payloads(numChunks);
+
+    JobSystem::GetInstance().ParallelFor(numChunks, 1, [&](size_t begin, size_t end) {
+        std::vector<uint8_t> filtered;
+
+        for (size_t c = begin; c < end; c++)
+        {
+            size_t first = c * chunkElements;
+            size_t chunkCount = std::min(chunkElements, count - first);
+            const uint8_t* chunkData = data + first * elementSize;
+
+            //A VARINT TAKES AT MOST 5 BYTES
+            filtered.resize(chunkCount * (indices ? 5 : elementSize));
+            size_t filteredSize = chunkCount * elementSize;
+
+            if (indices) filteredSize = FilterIndices(chunkData, chunkCount, elementSize, filtered.data());
+            else FilterVertices(chunkData, chunkCount, elementSize, filtered.data());
+
+            std::vector<uint8_t>& payload = payloads[c];
+            payload.resize(GetCompressLZBound(filteredSize));
+            size_t compressedSize = CompressLZ(filtered.data(), filteredSize, payload.data());
+
+            //STORE THE FILTERED BYTES WHEN LZ DOESN'T HELP. THE DECODER SPOTS IT BY encodedSize == filteredSize
+            if (compressedSize >= filteredSize)
+            {
+                payload.assign(filtered.begin(), filtered.begin() + filteredSize);
+                compressedSize = filteredSize;
+            }
+            payload.resize(compressedSize);
+
+            chunks[c] = { (uint32_t)chunkCount, (uint32_t)filteredSize, (uint32_t)compressedSize };
+        }
+    });
+
+    size_t totalSize = sizeof(uint32_t) + numChunks * sizeof(CodecChunk);
+    for (const std::vector<uint8_t>& payload : payloads) totalSize += payload.size();
+
+    encoded.resize(totalSize);
+    uint8_t* out = encoded.data();
+
+    uint32_t header = (uint32_t)numChunks;
+    memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+
+    memcpy(out, chunks.data(), numChunks * sizeof(CodecChunk));
+    out += numChunks * sizeof(CodecChunk);
+
+    for (const std::vector<uint8_t>& payload : payloads)
+    {
+        memcpy(out, payload.data(), payload.size());
+        out += payload.size();
+    }
+}
+
+static bool DecodeStream(const uint8_t* encoded, size_t encodedSize, size_t count, size_t elementSize, size_t chunkElements, bool indices, uint8_t* data)
+{
+    if (encodedSize < sizeof(uint32_t)) return false;
+
+    uint32_t numChunks;
+    memcpy(&numChunks, encoded, sizeof(numChunks));
+
+    if (numChunks != (count + chunkElements - 1) / chunkElements) return false;
+    if ((encodedSize - sizeof(uint32_t)) / sizeof(CodecChunk) < numChunks) return false;
+
+    std::vector<CodecChunk> chunks(numChunks);
+    memcpy(chunks.data(), encoded + sizeof(uint32_t), numChunks * sizeof(CodecChunk));
+
+    //PAYLOAD OFFSETS, SO EVERY CHUNK CAN BE DECODED ON ITS OWN
+    std::vector<size_t> offsets(numChunks);
+    size_t offset = sizeof(uint32_t) + numChunks * sizeof(CodecChunk);
+
+    for (uint32_t c = 0; c < numChunks; c++)
+    {
+        size_t expected = std::min(chunkElements, count - (size_t)c * chunkElements);
+        if (chunks[c].count != expected || chunks[c].encodedSize > encodedSize - offset) return false;
+
+        offsets[c] = offset;
+        offset += chunks[c].encodedSize;
+    }
+
+    std::atomic<bool> valid(true);
+
+    JobSystem::GetInstance().ParallelFor(numChunks, 1, [&](size_t begin, size_t end) {
+        std::vector<uint8_t> filtered;
+
+        for (size_t c = begin; c < end; c++)
+        {
+            const CodecChunk& chunk = chunks[c];
+            const uint8_t* payload = encoded + offsets[c];
+            uint8_t* chunkData = data + c * chunkElements * elementSize;
+
+            if (!indices && chunk.filteredSize != chunk.count * elementSize)
+            {
+                valid = false;
+                return;
+            }
+
+            const uint8_t* source = payload;
+            if (chunk.encodedSize != chunk.filteredSize)
+            {
+                filtered.resize(chunk.filteredSize);
+                if (!DecompressLZ(payload, chunk.encodedSize, filtered.data(), chunk.filteredSize))
+                {
+                    valid = false;
+                    return;
+                }
+                source = filtered.data();
+            }
+
+            if (indices)
+            {
+                if (!UnfilterIndices(source, chunk.filteredSize, chunk.count, elementSize, chunkData)) valid = false;
+            }
+            else
+            {
+                UnfilterVertices(source, chunk.count, elementSize, chunkData);
+            }
+        }
+    });
+
+    return valid;
+}
+
+void EncodeVertexStream(const void* vertices, size_t count, size_t stride, std::vector<uint8_t>& encoded)
+{
+    EncodeStream(static_cast<const uint8_t*>(vertices), count, stride, MESH_CODEC_VERTEX_CHUNK, false, encoded);
+}
+
+bool DecodeVertexStream(const uint8_t* encoded, size_t encodedSize, size_t count, size_t stride, void* vertices)
+{
+    return DecodeStream(encoded, encodedSize, count, stride, MESH_CODEC_VERTEX_CHUNK, false, static_cast<uint8_t*>(vertices));
+}
+
+void EncodeIndexStream(const void* indices, size_t count, size_t indexSize, std::vector<uint8_t>& encoded)
+{
+    EncodeStream(static_cast<const uint8_t*>(indices), count, indexSize, MESH_CODEC_INDEX_CHUNK, true, encoded);
+}
+
+bool DecodeIndexStream(const uint8_t* encoded, size_t encodedSize, size_t count, size_t indexSize, void* indices)
+{
+    return DecodeStream(encoded, encodedSize, count, indexSize, MESH_CODEC_INDEX_CHUNK, true, static_cast<uint8_t*>(indices));
+}
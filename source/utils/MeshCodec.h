@@ -0,0 +1,22 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+//Lossless codec for library mesh streams. Streams are split in chunks that are coded independently:
+//vertices are transposed into byte planes and delta coded per plane, indices are delta + zigzag + varint coded,
+//and every chunk then goes through a small LZ77 stage. Chunks are encoded and decoded in parallel.
+#define MESH_CODEC_VERTEX_CHUNK 16384
+#define MESH_CODEC_INDEX_CHUNK 65536
+
+void EncodeVertexStream(const void* vertices, size_t count, size_t stride, std::vector<uint8_t>& encoded);
+bool DecodeVertexStream(const uint8_t* encoded, size_t encodedSize, size_t count, size_t stride, void* vertices);
+
+//indexSize is 2 or 4 bytes
+void EncodeIndexStream(const void* indices, size_t count, size_t indexSize, std::vector<uint8_t>& encoded);
+bool DecodeIndexStream(const uint8_t* encoded, size_t encodedSize, size_t count, size_t indexSize, void* indices);
+
+//Raw LZ stage, exposed for other library assets
+size_t CompressLZ(const uint8_t* input, size_t inputSize, uint8_t* output);
+bool DecompressLZ(const uint8_t* input, size_t inputSize, uint8_t* output, size_t outputSize);
+size_t GetCompressLZBound(size_t inputSize);
@@ -0,0 +1,323 @@
+#include "MeshFile.h"
+#include "MappedFile.h"
+#include "VertexPacking.h"
+#include "MeshCodec.h"
+#include "JobSystem.h"
+#include "Hash.h"
+#include "FilePath.h"
+#include "Log.h"
+
+#include "SDL3/SDL_filesystem.h"
+#include <fstream>
+#include <cstring>
+
+#define W16MESH_V1_PACKED_FLAG 0x80000000u
+
+static uint64_t AlignOffset(uint64_t offset)
+{
+    return (offset + W16MESH_ALIGNMENT - 1) & ~(uint64_t)(W16MESH_ALIGNMENT - 1);
+}
+
+static uint64_t HashMeshFile(const MeshFileHeader& header, const MeshFileSection* sections, const void* const* streams)
+{
+    MeshFileHeader hashedHeader = header;
+    hashedHeader.contentHash = 0;
+
+    uint64_t hash = HashFNV1a(&hashedHeader, sizeof(MeshFileHeader));
+    hash = HashFNV1a(sections, sizeof(MeshFileSection) * header.numSections, hash);
+
+    for (uint32_t i = 0; i < header.numSections; i++)
+    {
+        hash = HashFNV1a(streams[i], (size_t)sections[i].size, hash);
+    }
+
+    return hash;
+}
+
+bool WriteMeshFile(const std::string& path, const MeshFileData& mesh, bool compress, uint64_t* contentHash)
+{
+    const uint32_t NUM_SECTIONS = 2;
+
+    MeshFileHeader header = {};
+    header.magic = W16MESH_MAGIC;
+    header.version = W16MESH_VERSION;
+    header.vertexFormat = (uint32_t)mesh.vertexFormat;
+    header.indexFormat = (uint32_t)mesh.indexFormat;
+    header.numVertices = mesh.numVertices;
+    header.numIndices = mesh.numIndices;
+    header.numSections = NUM_SECTIONS;
+    memcpy(header.aabbMin, &mesh.aabbMin, sizeof(header.aabbMin));
+    memcpy(header.aabbMax, &mesh.aabbMax, sizeof(header.aabbMax));
+
+    //SECTION TABLE
+    MeshFileSection sections[NUM_SECTIONS] = {};
+    const void* streams[NUM_SECTIONS] = { mesh.vertexData, mesh.indexData };
+
+    sections[0].type = (uint32_t)MeshSectionType::Vertices;
+    sections[0].rawSize = (uint64_t)mesh.numVertices * GetVertexStride(mesh.vertexFormat);
+    sections[1].type = (uint32_t)MeshSectionType::Indices;
+    sections[1].rawSize = (uint64_t)mesh.numIndices * GetIndexSize(mesh.indexFormat);
+
+    std::vector<uint8_t> encodedVertices;
+    std::vector<uint8_t> encodedIndices;
+
+    if (compress)
+    {
+        JobSystem::GetInstance().ParallelFor(NUM_SECTIONS, 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                if (i == 0) EncodeVertexStream(mesh.vertexData, mesh.numVertices, GetVertexStride(mesh.vertexFormat), encodedVertices);
+                else EncodeIndexStream(mesh.indexData, mesh.numIndices, GetIndexSize(mesh.indexFormat), encodedIndices);
+            }
+        });
+
+        streams[0] = encodedVertices.data();
+        streams[1] = encodedIndices.data();
+    }
+
+    uint64_t offset = sizeof(MeshFileHeader) + sizeof(sections);
+    for (uint32_t i = 0; i < NUM_SECTIONS; i++)
+    {
+        MeshFileSection& section = sections[i];
+        section.encoding = (uint32_t)(compress ? MeshSectionEncoding::Compressed : MeshSectionEncoding::Raw);
+        section.size = compress ? (i == 0 ? encodedVertices.size() : encodedIndices.size()) : section.rawSize;
+        section.offset = AlignOffset(offset);
+        offset = section.offset + section.size;
+    }
+
+    header.contentHash = HashMeshFile(header, sections, streams);
+
+    //A RELOAD COOKS OVER A FILE THAT MAY BE MAPPED, SO IT IS WRITTEN ASIDE AND MOVED INTO PLACE
+    std::string temporaryPath = GetTemporaryPath(path);
+    std::ofstream file(temporaryPath, std::ios::out | std::ios::binary);
+    if (!file.is_open())
+    {
+        LOG("Error: Could not open the .mesh file for writing: %s", path.c_str());
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(sections), sizeof(sections));
+
+    const char padding[W16MESH_ALIGNMENT] = {};
+    uint64_t written = sizeof(header) + sizeof(sections);
+
+    for (uint32_t i = 0; i < NUM_SECTIONS; i++)
+    {
+        file.write(padding, (std::streamsize)(sections[i].offset - written));
+        file.write(reinterpret_cast<const char*>(streams[i]), (std::streamsize)sections[i].size);
+        written = sections[i].offset + sections[i].size;
+    }
+
+    file.close();
+    if (!file.good())
+    {
+        LOG("Error: Failed writing the .mesh file: %s", path.c_str());
+        SDL_RemovePath(temporaryPath.c_str());
+        return false;
+    }
+
+    if (!ReplaceWithFile(temporaryPath, path))
+    {
+        LOG("Error: Could not move the .mesh file into place: %s", path.c_str());
+        return false;
+    }
+
+    if (contentHash) *contentHash = header.contentHash;
+    return true;
+}
+
+bool IsMeshFileV2(const MappedFile& file)
+{
+    uint32_t magic = 0;
+    if (file.GetSize() < sizeof(MeshFileHeader)) return false;
+
+    memcpy(&magic, file.GetData(), sizeof(magic));
+    return magic == W16MESH_MAGIC;
+}
+
+bool ReadMeshFile(const MappedFile& file, MeshFileData& mesh, bool verifyHash)
+{
+    if (!IsMeshFileV2(file))
+    {
+        LOG("Error: Not a W16Mesh v2 file");
+        return false;
+    }
+
+    const uint8_t* data = file.GetData();
+    size_t size = file.GetSize();
+
+    MeshFileHeader header;
+    memcpy(&header, data, sizeof(header));
+
+    if (header.version != W16MESH_VERSION)
+    {
+        LOG("Error: Unsupported W16Mesh version %u", header.version);
+        return false;
+    }
+
+    if (header.vertexFormat > (uint32_t)VertexFormat::Packed || header.indexFormat > (uint32_t)IndexFormat::UInt32)
+    {
+        LOG("Error: Unknown W16Mesh vertex or index format");
+        return false;
+    }
+
+    if (header.numSections == 0 || sizeof(MeshFileHeader) + (uint64_t)header.numSections * sizeof(MeshFileSection) > size)
+    {
+        LOG("Error: W16Mesh section table out of bounds");
+        return false;
+    }
+
+    const MeshFileSection* sections = reinterpret_cast<const MeshFileSection*>(data + sizeof(MeshFileHeader));
+    std::vector<const void*> streams(header.numSections);
+    const MeshFileSection* vertexSection = nullptr;
+    const MeshFileSection* indexSection = nullptr;
+
+    mesh = MeshFileData();
+    mesh.vertexFormat = (VertexFormat)header.vertexFormat;
+    mesh.indexFormat = (IndexFormat)header.indexFormat;
+    mesh.numVertices = header.numVertices;
+    mesh.numIndices = header.numIndices;
+    mesh.contentHash = header.contentHash;
+    memcpy(&mesh.aabbMin, header.aabbMin, sizeof(header.aabbMin));
+    memcpy(&mesh.aabbMax, header.aabbMax, sizeof(header.aabbMax));
+
+    for (uint32_t i = 0; i < header.numSections; i++)
+    {
+        const MeshFileSection& section = sections[i];
+
+        if (section.offset % W16MESH_ALIGNMENT != 0 || section.offset > size || section.size > size - section.offset)
+        {
+            LOG("Error: W16Mesh section %u out of bounds", i);
+            return false;
+        }
+
+        bool raw = section.encoding == (uint32_t)MeshSectionEncoding::Raw;
+        if ((!raw && section.encoding != (uint32_t)MeshSectionEncoding::Compressed) || (raw && section.rawSize != section.size))
+        {
+            LOG("Error: W16Mesh section %u has an unsupported encoding", i);
+            return false;
+        }
+
+        streams[i] = data + section.offset;
+
+        if (section.type == (uint32_t)MeshSectionType::Vertices)
+        {
+            if (section.rawSize != (uint64_t)header.numVertices * GetVertexStride(mesh.vertexFormat))
+            {
+                LOG("Error: W16Mesh vertex section %u doesn't match the header counts", i);
+                return false;
+            }
+            vertexSection = &section;
+        }
+        else if (section.type == (uint32_t)MeshSectionType::Indices)
+        {
+            if (section.rawSize != (uint64_t)header.numIndices * GetIndexSize(mesh.indexFormat))
+            {
+                LOG("Error: W16Mesh index section %u doesn't match the header counts", i);
+                return false;
+            }
+            indexSection = &section;
+        }
+    }
+
+    if (!vertexSection || !indexSection)
+    {
+        LOG("Error: W16Mesh is missing its vertex or index stream");
+        return false;
+    }
+
+    if (verifyHash && HashMeshFile(header, sections, streams.data()) != header.contentHash)
+    {
+        LOG("Error: W16Mesh hash mismatch, the file is corrupted");
+        return false;
+    }
+
+    mesh.vertexData = data + vertexSection->offset;
+    mesh.indexData = data + indexSection->offset;
+
+    bool compressedVertices = vertexSection->encoding == (uint32_t)MeshSectionEncoding::Compressed;
+    bool compressedIndices = indexSection->encoding == (uint32_t)MeshSectionEncoding::Compressed;
+    if (!compressedVertices && !compressedIndices) return true;
+
+    //BOTH STREAMS DECODE AT THE SAME TIME, AND EVERY STREAM DECODES ITS CHUNKS IN PARALLEL
+    if (compressedVertices) mesh.decodedVertices.resize((size_t)vertexSection->rawSize);
+    if (compressedIndices) mesh.decodedIndices.resize((size_t)indexSection->rawSize);
+
+    bool decoded[2] = { true, true };
+
+    JobSystem::GetInstance().ParallelFor(2, 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            if (i == 0 && compressedVertices)
+            {
+                decoded[0] = DecodeVertexStream(data + vertexSection->offset, (size_t)vertexSection->size, mesh.numVertices, GetVertexStride(mesh.vertexFormat), mesh.decodedVertices.data());
+            }
+            else if (i == 1 && compressedIndices)
+            {
+                decoded[1] = DecodeIndexStream(data + indexSection->offset, (size_t)indexSection->size, mesh.numIndices, GetIndexSize(mesh.indexFormat), mesh.decodedIndices.data());
+            }
+        }
+    });
+
+    if (!decoded[0] || !decoded[1])
+    {
+        LOG("Error: W16Mesh stream failed to decode");
+        return false;
+    }
+
+    if (compressedVertices) mesh.vertexData = mesh.decodedVertices.data();
+    if (compressedIndices) mesh.indexData = mesh.decodedIndices.data();
+
+    return true;
+}
+
+bool ReadMeshFileV1(const MappedFile& file, MeshFileData& mesh)
+{
+    const uint8_t* data = file.GetData();
+    size_t size = file.GetSize();
+    size_t offset = 2 * sizeof(uint32_t);
+
+    if (size < offset)
+    {
+        LOG("Error: Mesh file too small");
+        return false;
+    }
+
+    uint32_t numVertices = 0;
+    uint32_t numIndices = 0;
+    memcpy(&numVertices, data, sizeof(uint32_t));
+    memcpy(&numIndices, data + sizeof(uint32_t), sizeof(uint32_t));
+
+    bool packed = (numVertices & W16MESH_V1_PACKED_FLAG) != 0;
+    numVertices &= ~W16MESH_V1_PACKED_FLAG;
+
+    mesh = MeshFileData();
+    mesh.numVertices = numVertices;
+    mesh.numIndices = numIndices;
+
+    if (packed)
+    {
+        if (size < offset + 2 * sizeof(glm::vec3)) return false;
+
+        memcpy(&mesh.aabbMin, data + offset, sizeof(glm::vec3));
+        memcpy(&mesh.aabbMax, data + offset + sizeof(glm::vec3), sizeof(glm::vec3));
+        offset += 2 * sizeof(glm::vec3);
+
+        mesh.vertexFormat = VertexFormat::Packed;
+        mesh.indexFormat = CanUseShortIndices(numVertices) ? IndexFormat::UInt16 : IndexFormat::UInt32;
+    }
+
+    uint64_t vertexBytes = (uint64_t)numVertices * GetVertexStride(mesh.vertexFormat);
+    uint64_t indexBytes = (uint64_t)numIndices * GetIndexSize(mesh.indexFormat);
+
+    if (offset + vertexBytes + indexBytes > size)
+    {
+        LOG("Error: Mesh file is truncated");
+        return false;
+    }
+
+    mesh.vertexData = data + offset;
+    mesh.indexData = data + offset + vertexBytes;
+    return true;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include "../components/Mesh.h"
+#include <string>
+#include <cstdint>
+#include <vector>
+
+class MappedFile;
+
+//W16Mesh v2 layout: MeshFileHeader, numSections MeshFileSection entries and then every stream, each one starting at a
+//64 byte boundary so it can be uploaded straight from the mapping. The hash covers the header (with the hash zeroed),
+//the section table and every stream as stored. Compressed streams use the MeshCodec and are decoded into MeshFileData.
+#define W16MESH_MAGIC 0x4D363157u //"W16M"
+#define W16MESH_VERSION 2
+#define W16MESH_ALIGNMENT 64
+
+enum class MeshSectionType : uint32_t
+{
+    Vertices = 1,
+    Indices = 2
+};
+
+enum class MeshSectionEncoding : uint32_t
+{
+    Raw = 0,
+    Compressed = 1
+};
+
+struct MeshFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t vertexFormat;
+    uint32_t indexFormat;
+    uint32_t numVertices;
+    uint32_t numIndices;
+    uint32_t numSections;
+    uint32_t flags;
+    float aabbMin[3];
+    float aabbMax[3];
+    uint64_t contentHash;
+};
+
+struct MeshFileSection
+{
+    uint32_t type;
+    uint32_t encoding;
+    uint64_t offset;
+    uint64_t size;
+    uint64_t rawSize;
+};
+
+static_assert(sizeof(MeshFileHeader) == 64, "W16Mesh header must stay 64 bytes");
+static_assert(sizeof(MeshFileSection) == 32, "W16Mesh section entry must stay 32 bytes");
+
+//Geometry as stored in a mesh file. When read from a mapping the pointers point inside it.
+struct MeshFileData
+{
+    VertexFormat vertexFormat = VertexFormat::Full;
+    IndexFormat indexFormat = IndexFormat::UInt32;
+    uint32_t numVertices = 0;
+    uint32_t numIndices = 0;
+    glm::vec3 aabbMin = glm::vec3(0.0f);
+    glm::vec3 aabbMax = glm::vec3(0.0f);
+    const void* vertexData = nullptr;
+    const void* indexData = nullptr;
+
+    //HASH OF THE FILE AS STORED, SET BY ReadMeshFile. 0 FOR V1 FILES
+    uint64_t contentHash = 0;
+
+    //ONLY USED WHEN THE STREAMS WERE COMPRESSED, OTHERWISE THE POINTERS GO STRAIGHT INTO THE MAPPING
+    std::vector<uint8_t> decodedVertices;
+    std::vector<uint8_t> decodedIndices;
+};
+
+//contentHash, when given, gets the hash of the file written
+bool WriteMeshFile(const std::string& path, const MeshFileData& mesh, bool compress, uint64_t* contentHash = nullptr);
+
+bool IsMeshFileV2(const MappedFile& file);
+
+//Validates the header, the section table bounds and the hash. Page-ins and reloads of a file already checked skip the hash.
+bool ReadMeshFile(const MappedFile& file, MeshFileData& mesh, bool verifyHash = true);
+
+//Old headerless files: vertex count (high bit set when packed), index count, packed AABB and the raw blobs.
+bool ReadMeshFileV1(const MappedFile& file, MeshFileData& mesh);
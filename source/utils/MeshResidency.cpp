@@ -0,0 +1,49 @@
+#include "MeshResidency.h"
+#include "MeshCache.h"
+
+void MeshResidency::Register(MeshResource* resource)
+{
+    Unregister(resource);
+
+    size_t bytes = resource->vertices.size() * sizeof(Vertex) + resource->indices.size() * sizeof(unsigned int);
+
+    lru.push_front(resource);
+    entries[resource] = { lru.begin(), bytes };
+    residentBytes += bytes;
+}
+
+void MeshResidency::Unregister(MeshResource* resource)
+{
+    auto it = entries.find(resource);
+    if (it == entries.end()) return;
+
+    residentBytes -= it->second.bytes;
+    lru.erase(it->second.position);
+    entries.erase(it);
+}
+
+void MeshResidency::Touch(MeshResource* resource)
+{
+    auto it = entries.find(resource);
+    if (it == entries.end()) return;
+
+    lru.splice(lru.begin(), lru, it->second.position);
+}
+
+void MeshResidency::Evict(MeshResource* resource)
+{
+    if (!resource) return;
+
+    Unregister(resource);
+    std::vector<Vertex>().swap(resource->vertices);
+    std::vector<unsigned int>().swap(resource->indices);
+    resource->geometryResident = false;
+}
+
+void MeshResidency::Enforce()
+{
+    if (!enabled) return;
+
+    //THE MOST RECENTLY USED RESOURCE IS ALWAYS KEPT
+    while (residentBytes > budgetBytes && lru.size() > 1) Evict(lru.back());
+}
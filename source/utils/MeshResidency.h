@@ -0,0 +1,48 @@
+#pragma once
+#include <list>
+#include <unordered_map>
+#include <cstddef>
+
+struct MeshResource;
+
+#define MESH_RESIDENCY_DEFAULT_BUDGET (512ull * 1024 * 1024)
+
+//Tracks the CPU copies of Library meshes, one per MeshResource however many instances read it, and evicts the least
+//recently used ones when they go over the budget. Eviction only happens in Enforce(), once per frame, so geometry references
+//taken during a frame stay valid until it ends.
+class MeshResidency
+{
+public:
+    static MeshResidency& GetInstance() {
+        static MeshResidency instance;
+        return instance;
+    }
+
+    //Takes the size of the copy the resource holds now
+    void Register(MeshResource* resource);
+    void Unregister(MeshResource* resource);
+    void Touch(MeshResource* resource);
+
+    //Drops the CPU copy of the resource right away, for every mesh sharing it
+    void Evict(MeshResource* resource);
+
+    void Enforce();
+
+    size_t GetResidentBytes() const { return residentBytes; }
+    size_t GetNumResident() const { return lru.size(); }
+
+public:
+    bool enabled = false;
+    size_t budgetBytes = MESH_RESIDENCY_DEFAULT_BUDGET;
+
+private:
+    struct Entry
+    {
+        std::list<MeshResource*>::iterator position;
+        size_t bytes;
+    };
+
+    std::list<MeshResource*> lru;
+    std::unordered_map<MeshResource*, Entry> entries;
+    size_t residentBytes = 0;
+};
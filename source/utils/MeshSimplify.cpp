@@ -0,0 +1,128 @@
+#include "MeshSimplify.h"
+#include "AABB.h"
+#include "JobSystem.h"
+#include "../components/Mesh.h"
+
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <cstdint>
+#include <cmath>
+
+#define CLUSTER_BATCH 16384
+#define CLUSTER_INDEX_BITS 21
+
+struct ClusterSum
+{
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::vec3 normal = glm::vec3(0.0f);
+    glm::vec2 texCoords = glm::vec2(0.0f);
+    unsigned int count = 0;
+};
+
+void SimplifyByClustering(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, const AABB& bounds, int resolution,
+    std::vector<Vertex>& outVertices, std::vector<unsigned int>& outIndices)
+{
+    outVertices.clear();
+    outIndices.clear();
+
+    if (vertices.empty() || indices.empty()) return;
+
+    resolution = std::min(std::max(resolution, CLUSTER_MIN_RESOLUTION), CLUSTER_MAX_RESOLUTION);
+
+    glm::vec3 extent = bounds.max - bounds.min;
+    glm::vec3 invCellSize = glm::vec3(
+        extent.x > 0.0f ? resolution / extent.x : 0.0f,
+        extent.y > 0.0f ? resolution / extent.y : 0.0f,
+        extent.z > 0.0f ? resolution / extent.z : 0.0f);
+
+    //GRID CELL PER VERTEX
+    std::vector<uint32_t> cells(vertices.size());
+
+    JobSystem::GetInstance().ParallelFor(vertices.size(), CLUSTER_BATCH, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            glm::vec3 cell = glm::floor((vertices[i].position - bounds.min) * invCellSize);
+            uint32_t x = (uint32_t)std::min(std::max((int)cell.x, 0), resolution - 1);
+            uint32_t y = (uint32_t)std::min(std::max((int)cell.y, 0), resolution - 1);
+            uint32_t z = (uint32_t)std::min(std::max((int)cell.z, 0), resolution - 1);
+            cells[i] = (z * resolution + y) * resolution + x;
+        }
+    });
+
+    //ONE OUTPUT VERTEX PER OCCUPIED CELL, IN FIRST USE ORDER
+    std::unordered_map<uint32_t, uint32_t> cellToVertex;
+    cellToVertex.reserve(std::min(vertices.size(), (size_t)resolution * resolution * resolution));
+    std::vector<uint32_t> remap(vertices.size());
+    std::vector<ClusterSum> sums;
+
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        auto inserted = cellToVertex.emplace(cells[i], (uint32_t)sums.size());
+        if (inserted.second) sums.emplace_back();
+
+        uint32_t cluster = inserted.first->second;
+        ClusterSum& sum = sums[cluster];
+        sum.position += vertices[i].position;
+        sum.normal += vertices[i].normal;
+        sum.texCoords += vertices[i].texCoords;
+        sum.count++;
+        remap[i] = cluster;
+    }
+
+    outVertices.resize(sums.size());
+    for (size_t i = 0; i < sums.size(); i++)
+    {
+        const ClusterSum& sum = sums[i];
+        float length = glm::length(sum.normal);
+
+        outVertices[i].position = sum.position / (float)sum.count;
+        outVertices[i].normal = length > 0.0f ? sum.normal / length : glm::vec3(0.0f, 1.0f, 0.0f);
+        outVertices[i].texCoords = sum.texCoords / (float)sum.count;
+    }
+
+    //DROP COLLAPSED TRIANGLES AND DUPLICATES. THE KEY STARTS AT THE LOWEST INDEX SO THE WINDING IS KEPT
+    std::unordered_set<uint64_t> triangles;
+    outIndices.reserve(indices.size());
+
+    for (size_t t = 0; t + 2 < indices.size(); t += 3)
+    {
+        uint32_t a = remap[indices[t]];
+        uint32_t b = remap[indices[t + 1]];
+        uint32_t c = remap[indices[t + 2]];
+
+        if (a == b || b == c || a == c) continue;
+
+        while (a > b || a > c)
+        {
+            uint32_t first = a;
+            a = b;
+            b = c;
+            c = first;
+        }
+
+        uint64_t key = ((uint64_t)a << (CLUSTER_INDEX_BITS * 2)) | ((uint64_t)b << CLUSTER_INDEX_BITS) | (uint64_t)c;
+        if (!triangles.insert(key).second) continue;
+
+        outIndices.push_back(a);
+        outIndices.push_back(b);
+        outIndices.push_back(c);
+    }
+
+    //CELLS ONLY USED BY DROPPED TRIANGLES ARE REMOVED
+    std::vector<uint32_t> compact(outVertices.size(), UINT32_MAX);
+    std::vector<Vertex> usedVertices;
+    usedVertices.reserve(outVertices.size());
+
+    for (unsigned int& index : outIndices)
+    {
+        if (compact[index] == UINT32_MAX)
+        {
+            compact[index] = (uint32_t)usedVertices.size();
+            usedVertices.push_back(outVertices[index]);
+        }
+        index = compact[index];
+    }
+
+    outVertices = std::move(usedVertices);
+}
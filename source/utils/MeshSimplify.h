@@ -0,0 +1,13 @@
+#pragma once
+#include <vector>
+
+struct Vertex;
+class AABB;
+
+#define CLUSTER_MIN_RESOLUTION 2
+#define CLUSTER_MAX_RESOLUTION 128
+
+//Vertex clustering: every vertex snaps to a resolution^3 grid over bounds, each cell becomes the average of its vertices
+//and the triangles that collapse or repeat are dropped. Fast and robust on any input, meant for distant proxies.
+void SimplifyByClustering(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, const AABB& bounds, int resolution,
+    std::vector<Vertex>& outVertices, std::vector<unsigned int>& outIndices);
@@ -0,0 +1,283 @@
+#include "Meshlet.h"
+#include "Frustum.h"
+#include "JobSystem.h"
+#include "Log.h"
+#include "../components/Mesh.h"
+
+#include <algorithm>
+#include <cmath>
+
+#define MESHLET_CULL_BATCH 256
+
+static void ComputeMeshletBounds(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, Meshlet& meshlet)
+{
+    //SPHERE AROUND THE CLUSTER AABB CENTER
+    glm::vec3 min = glm::vec3(INFINITY);
+    glm::vec3 max = glm::vec3(-INFINITY);
+
+    for (uint32_t i = meshlet.indexOffset; i < meshlet.indexOffset + meshlet.indexCount; i++)
+    {
+        min = glm::min(min, vertices[indices[i]].position);
+        max = glm::max(max, vertices[indices[i]].position);
+    }
+
+    meshlet.center = (min + max) * 0.5f;
+    meshlet.radius = 0.0f;
+
+    for (uint32_t i = meshlet.indexOffset; i < meshlet.indexOffset + meshlet.indexCount; i++)
+    {
+        meshlet.radius = std::max(meshlet.radius, glm::distance(meshlet.center, vertices[indices[i]].position));
+    }
+
+    //NORMAL CONE FROM THE FACE NORMALS
+    std::vector<glm::vec3> faceNormals;
+    faceNormals.reserve(meshlet.indexCount / 3);
+    glm::vec3 normalSum = glm::vec3(0.0f);
+
+    for (uint32_t i = meshlet.indexOffset; i < meshlet.indexOffset + meshlet.indexCount; i += 3)
+    {
+        const glm::vec3& p0 = vertices[indices[i]].position;
+        const glm::vec3& p1 = vertices[indices[i + 1]].position;
+        const glm::vec3& p2 = vertices[indices[i + 2]].position;
+
+        glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+        float area = glm::length(normal);
+
+        //DEGENERATE TRIANGLES ARE NEVER RASTERIZED, THEY DON'T CONSTRAIN THE CONE
+        if (area <= 0.0f) continue;
+
+        normal /= area;
+        faceNormals.push_back(normal);
+        normalSum += normal;
+    }
+
+    meshlet.coneApex = meshlet.center;
+    meshlet.coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+    meshlet.coneCutoff = 2.0f;
+
+    float sumLength = glm::length(normalSum);
+    if (faceNormals.empty() || sumLength <= 0.0f) return;
+
+    glm::vec3 axis = normalSum / sumLength;
+    float minDot = 1.0f;
+
+    for (const glm::vec3& normal : faceNormals)
+    {
+        minDot = std::min(minDot, glm::dot(axis, normal));
+    }
+
+    //CONES WIDER THAN ~84 DEGREES ALMOST NEVER CULL, KEEP THEM DISABLED
+    if (minDot <= 0.1f) return;
+
+    float maxT = 0.0f;
+    size_t faceIndex = 0;
+
+    for (uint32_t i = meshlet.indexOffset; i < meshlet.indexOffset + meshlet.indexCount; i += 3)
+    {
+        const glm::vec3& p0 = vertices[indices[i]].position;
+        const glm::vec3& p1 = vertices[indices[i + 1]].position;
+        const glm::vec3& p2 = vertices[indices[i + 2]].position;
+
+        if (glm::length(glm::cross(p1 - p0, p2 - p0)) <= 0.0f) continue;
+
+        const glm::vec3& normal = faceNormals[faceIndex++];
+        float t = glm::dot(meshlet.center - p0, normal) / glm::dot(axis, normal);
+        maxT = std::max(maxT, t);
+    }
+
+    meshlet.coneApex = meshlet.center - axis * maxT;
+    meshlet.coneAxis = axis;
+    meshlet.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+}
+
+void BuildMeshlets(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, std::vector<Meshlet>& meshlets)
+{
+    meshlets.clear();
+
+    size_t numTriangles = indices.size() / 3;
+    if (numTriangles == 0) return;
+
+    meshlets.reserve(numTriangles / MESHLET_MAX_TRIANGLES + 1);
+
+    //VERTEX -> LAST MESHLET THAT USED IT, AVOIDS CLEARING A SET PER MESHLET
+    std::vector<uint32_t> usedBy(vertices.size(), UINT32_MAX);
+
+    Meshlet current = {};
+    uint32_t currentVertices = 0;
+    uint32_t meshletId = 0;
+
+    for (size_t t = 0; t < numTriangles; t++)
+    {
+        unsigned int a = indices[t * 3];
+        unsigned int b = indices[t * 3 + 1];
+        unsigned int c = indices[t * 3 + 2];
+
+        uint32_t newVertices = (usedBy[a] != meshletId) + (usedBy[b] != meshletId && b != a) + (usedBy[c] != meshletId && c != a && c != b);
+
+        if (currentVertices + newVertices > MESHLET_MAX_VERTICES || current.indexCount / 3 >= MESHLET_MAX_TRIANGLES)
+        {
+            meshlets.push_back(current);
+            current = {};
+            current.indexOffset = (uint32_t)(t * 3);
+            currentVertices = 0;
+            meshletId++;
+            newVertices = 1 + (b != a) + (c != a && c != b);
+        }
+
+        usedBy[a] = meshletId;
+        usedBy[b] = meshletId;
+        usedBy[c] = meshletId;
+        currentVertices += newVertices;
+        current.indexCount += 3;
+    }
+
+    meshlets.push_back(current);
+
+    JobSystem::GetInstance().ParallelFor(meshlets.size(), 64, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            ComputeMeshletBounds(vertices, indices, meshlets[i]);
+        }
+    });
+}
+
+void CullMeshlets(const std::vector<Meshlet>& meshlets, const Frustum& frustum, const glm::mat4& modelMatrix, const glm::vec3& cameraPosition, std::vector<IndexRange>& ranges)
+{
+    ranges.clear();
+    if (meshlets.empty()) return;
+
+    //BACKFACING IS AFFINE INVARIANT, SO THE CONE IS TESTED WITH THE CAMERA IN MODEL SPACE
+    glm::vec3 localCamera = glm::vec3(glm::inverse(modelMatrix) * glm::vec4(cameraPosition, 1.0f));
+
+    glm::vec3 axisX = glm::vec3(modelMatrix[0]);
+    glm::vec3 axisY = glm::vec3(modelMatrix[1]);
+    glm::vec3 axisZ = glm::vec3(modelMatrix[2]);
+    float maxScale = std::max(glm::length(axisX), std::max(glm::length(axisY), glm::length(axisZ)));
+
+    //MIRRORED TRANSFORMS FLIP THE WINDING, SKIP CONE CULLING FOR THEM
+    bool coneCulling = glm::dot(glm::cross(axisX, axisY), axisZ) > 0.0f;
+
+    std::vector<uint8_t> visible(meshlets.size());
+
+    JobSystem::GetInstance().ParallelFor(meshlets.size(), MESHLET_CULL_BATCH, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            const Meshlet& meshlet = meshlets[i];
+            visible[i] = 1;
+
+            if (coneCulling)
+            {
+                glm::vec3 toApex = meshlet.coneApex - localCamera;
+                float distance = glm::length(toApex);
+                if (distance > 0.0f && glm::dot(toApex, meshlet.coneAxis) >= meshlet.coneCutoff * distance)
+                {
+                    visible[i] = 0;
+                    continue;
+                }
+            }
+
+            glm::vec3 worldCenter = glm::vec3(modelMatrix * glm::vec4(meshlet.center, 1.0f));
+            float worldRadius = meshlet.radius * maxScale;
+
+            for (const Plane& plane : frustum.planes)
+            {
+                if (plane.GetDistanceToPoint(worldCenter) < -worldRadius)
+                {
+                    visible[i] = 0;
+                    break;
+                }
+            }
+        }
+    });
+
+    //COMPACT CONSECUTIVE VISIBLE MESHLETS INTO SINGLE RANGES
+    for (size_t i = 0; i < meshlets.size(); i++)
+    {
+        if (!visible[i]) continue;
+
+        if (!ranges.empty() && ranges.back().offset + ranges.back().count == meshlets[i].indexOffset)
+        {
+            ranges.back().count += meshlets[i].indexCount;
+        }
+        else
+        {
+            ranges.push_back({ meshlets[i].indexOffset, meshlets[i].indexCount });
+        }
+    }
+}
+
+bool ValidateMeshletCulling(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, const Frustum& frustum, const glm::mat4& modelMatrix, const glm::vec3& cameraPosition, const std::vector<IndexRange>& ranges)
+{
+    const float EDGE_ON_TOLERANCE = 1e-4f;
+    size_t numTriangles = indices.size() / 3;
+    std::vector<uint8_t> emitted(numTriangles, 0);
+
+    for (const IndexRange& range : ranges)
+    {
+        if (range.offset % 3 != 0 || range.count % 3 != 0 || range.offset + range.count > indices.size())
+        {
+            LOG("Meshlet validation: range [%u, %u) is out of bounds", range.offset, range.offset + range.count);
+            return false;
+        }
+
+        for (uint32_t t = range.offset / 3; t < (range.offset + range.count) / 3; t++)
+        {
+            if (emitted[t])
+            {
+                LOG("Meshlet validation: triangle %u emitted twice", t);
+                return false;
+            }
+            emitted[t] = 1;
+        }
+    }
+
+    glm::vec3 localCamera = glm::vec3(glm::inverse(modelMatrix) * glm::vec4(cameraPosition, 1.0f));
+    glm::vec3 axisX = glm::vec3(modelMatrix[0]);
+    glm::vec3 axisY = glm::vec3(modelMatrix[1]);
+    glm::vec3 axisZ = glm::vec3(modelMatrix[2]);
+    bool mirrored = glm::dot(glm::cross(axisX, axisY), axisZ) <= 0.0f;
+    size_t missing = 0;
+
+    for (size_t t = 0; t < numTriangles; t++)
+    {
+        if (emitted[t]) continue;
+
+        const glm::vec3& p0 = vertices[indices[t * 3]].position;
+        const glm::vec3& p1 = vertices[indices[t * 3 + 1]].position;
+        const glm::vec3& p2 = vertices[indices[t * 3 + 2]].position;
+
+        glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+        glm::vec3 toTriangle = p0 - localCamera;
+        float facing = glm::dot(normal, toTriangle);
+        float tolerance = EDGE_ON_TOLERANCE * glm::length(normal) * glm::length(toTriangle);
+
+        //BACKFACING, DEGENERATE AND EDGE-ON TRIANGLES MAY BE CULLED
+        if (!mirrored && facing >= -tolerance) continue;
+
+        glm::vec3 world[3] = {
+            glm::vec3(modelMatrix * glm::vec4(p0, 1.0f)),
+            glm::vec3(modelMatrix * glm::vec4(p1, 1.0f)),
+            glm::vec3(modelMatrix * glm::vec4(p2, 1.0f))
+        };
+
+        bool outside = false;
+        for (const Plane& plane : frustum.planes)
+        {
+            if (plane.GetDistanceToPoint(world[0]) < 0.0f && plane.GetDistanceToPoint(world[1]) < 0.0f && plane.GetDistanceToPoint(world[2]) < 0.0f)
+            {
+                outside = true;
+                break;
+            }
+        }
+
+        if (!outside) missing++;
+    }
+
+    if (missing > 0)
+    {
+        LOG("Meshlet validation: %zu visible triangles were culled", missing);
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+#include <cstdint>
+
+struct Vertex;
+class Frustum;
+
+#define MESHLET_MAX_VERTICES 64
+#define MESHLET_MAX_TRIANGLES 124
+#define MESHLET_MIN_MESH_TRIANGLES (MESHLET_MAX_TRIANGLES * 8)
+
+struct Meshlet
+{
+    uint32_t indexOffset;
+    uint32_t indexCount;
+
+    //BOUNDING SPHERE
+    glm::vec3 center;
+    float radius;
+
+    //NORMAL CONE. THE WHOLE CLUSTER IS BACKFACING WHEN dot(normalize(apex - camera), axis) >= cutoff
+    glm::vec3 coneApex;
+    glm::vec3 coneAxis;
+    float coneCutoff;
+};
+
+struct IndexRange
+{
+    uint32_t offset;
+    uint32_t count;
+};
+
+//Splits the index buffer into contiguous clusters, so every meshlet is a plain range of the existing EBO.
+void BuildMeshlets(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, std::vector<Meshlet>& meshlets);
+
+//Frustum (world space) and backface cone culling. Visible meshlets are merged into the fewest possible index ranges.
+void CullMeshlets(const std::vector<Meshlet>& meshlets, const Frustum& frustum, const glm::mat4& modelMatrix, const glm::vec3& cameraPosition, std::vector<IndexRange>& ranges);
+
+//Brute force per triangle reference. Checks the ranges are in bounds, don't overlap and keep every visible triangle.
+bool ValidateMeshletCulling(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, const Frustum& frustum, const glm::mat4& modelMatrix, const glm::vec3& cameraPosition, const std::vector<IndexRange>& ranges);
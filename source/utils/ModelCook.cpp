@@ -0,0 +1,516 @@
+#include "ModelCook.h"
+#include "ImportDatabase.h"
+#include "TextureCook.h"
+#include "MeshFile.h"
+#include "VertexPacking.h"
+#include "AssimpMesh.h"
+#include "FilePath.h"
+#include "FileIndex.h"
+#include "JobSystem.h"
+#include "AllocationCounter.h"
+#include "AABB.h"
+#include "Hash.h"
+#include "Log.h"
+#include "../components/Component.h"
+#include "../components/Mesh.h"
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+#include <assimp/config.h>
+#include "SDL3/SDL_filesystem.h"
+#include "pugixml.hpp"
+
+#include <algorithm>
+#include <unordered_set>
+#include <mutex>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+
+//BUMPED WHEN THE IMPORTER CHANGES WHAT IT WRITES, SO OLD COOKED MODELS ARE IMPORTED AGAIN
+#define MODEL_IMPORT_VERSION 1
+
+const char* GetImportProfileName(ModelImportProfile profile)
+{
+    switch (profile)
+    {
+    case ModelImportProfile::Editable: return "editable";
+    case ModelImportProfile::RuntimeOptimized: return "runtime-optimized";
+    default: return "unknown";
+    }
+}
+
+bool FindImportProfile(const std::string& name, ModelImportProfile& profile)
+{
+    for (int i = 0; i < (int)ModelImportProfile::Count; i++)
+    {
+        if (name == GetImportProfileName((ModelImportProfile)i))
+        {
+            profile = (ModelImportProfile)i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+unsigned int GetModelImportFlags(ModelImportProfile profile)
+{
+    unsigned int flags = aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_GlobalScale | aiProcess_JoinIdenticalVertices;
+
+    //FEWER NODES AND DRAWS, BUT THE FILE HIERARCHY IS LOST
+    if (profile == ModelImportProfile::RuntimeOptimized)
+    {
+        flags |= aiProcess_SortByPType | aiProcess_OptimizeMeshes | aiProcess_OptimizeGraph | aiProcess_ImproveCacheLocality;
+    }
+
+    return flags;
+}
+
+struct ModelSceneStats
+{
+    unsigned int nodes = 0;
+    unsigned int meshes = 0;
+    size_t vertices = 0;
+    size_t faces = 0;
+};
+
+static unsigned int CountNodes(const aiNode* node)
+{
+    unsigned int count = 1;
+    for (unsigned int i = 0; i < node->mNumChildren; i++) count += CountNodes(node->mChildren[i]);
+
+    return count;
+}
+
+static ModelSceneStats GetSceneStats(const aiScene* scene)
+{
+    ModelSceneStats stats;
+    stats.nodes = CountNodes(scene->mRootNode);
+    stats.meshes = scene->mNumMeshes;
+
+    for (unsigned int i = 0; i < scene->mNumMeshes; i++)
+    {
+        stats.vertices += scene->mMeshes[i]->mNumVertices;
+        stats.faces += scene->mMeshes[i]->mNumFaces;
+    }
+
+    return stats;
+}
+
+const aiScene* ReadModel(Assimp::Importer& importer, const std::string& path, ModelImportProfile profile)
+{
+    //THE RENDER ONLY DRAWS TRIANGLES, SortByPType DROPS THE POINT AND LINE MESHES
+    importer.SetPropertyInteger(AI_CONFIG_PP_SBP_REMOVE, aiPrimitiveType_POINT | aiPrimitiveType_LINE);
+
+    //NO POST PROCESSING YET, SO THE REPORT HAS THE COUNTS OF THE FILE ITSELF
+    const aiScene* scene = importer.ReadFile(path, 0);
+
+    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+    {
+        LOG("Error loading model with Assimp: %s", importer.GetErrorString());
+        return nullptr;
+    }
+
+    ModelSceneStats before = GetSceneStats(scene);
+    scene = importer.ApplyPostProcessing(GetModelImportFlags(profile));
+
+    if (!scene || !scene->mRootNode)
+    {
+        LOG("Error post processing model with Assimp: %s", importer.GetErrorString());
+        return nullptr;
+    }
+
+    ModelSceneStats after = GetSceneStats(scene);
+
+    LOG("Import profile %s for %s: nodes %u -> %u, meshes %u -> %u, vertices %zu -> %zu, faces %zu -> %zu",
+        GetImportProfileName(profile), path.c_str(), before.nodes, after.nodes, before.meshes, after.meshes,
+        before.vertices, after.vertices, before.faces, after.faces);
+
+    return scene;
+}
+
+uint64_t GetModelSettingsHash(const ModelCookSettings& settings)
+{
+    uint32_t values[] = {
+        MODEL_IMPORT_VERSION,
+        GetModelImportFlags(settings.profile),
+        W16MESH_VERSION,
+        (uint32_t)settings.packedVertexFormat,
+        (uint32_t)settings.compressMeshes
+    };
+
+    return HashFNV1a(values, sizeof(values));
+}
+
+static std::string HashToHex(uint64_t hash)
+{
+    char text[32];
+    snprintf(text, sizeof(text), "%016llx", (unsigned long long)hash);
+    return text;
+}
+
+std::string GetCookedModelPath(const std::string& sourcePath)
+{
+    std::string canonicalPath = CanonicalPath(sourcePath);
+    uint64_t pathHash = HashFNV1a(canonicalPath.data(), canonicalPath.size());
+
+    return std::string(MODEL_LIBRARY_DIRECTORY) + "/" + GetFileName(sourcePath) + "_" + HashToHex(pathHash) + ".W16Model";
+}
+
+std::string FindMaterialTexture(const aiMaterial* material, FileIndex& files)
+{
+    if (material->GetTextureCount(aiTextureType_DIFFUSE) == 0) return "";
+
+    aiString aiPath;
+    material->GetTexture(aiTextureType_DIFFUSE, 0, &aiPath);
+
+    std::string texPath = files.FindRelative(aiPath.C_Str());
+    if (!texPath.empty()) return texPath;
+
+    return files.Find(GetFileName(aiPath.C_Str()));
+}
+
+//MODELS COOKED IN PARALLEL OFTEN SHARE TEXTURES, EACH ONE IS COOKED BY THE FIRST MODEL THAT GETS TO IT
+static std::mutex claimedTexturesMutex;
+static std::unordered_set<std::string> claimedTextures;
+
+static bool ClaimTexture(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(claimedTexturesMutex);
+    return claimedTextures.insert(CanonicalPath(path)).second;
+}
+
+//ONE GAMEOBJECT OF THE COOKED HIERARCHY
+struct CookedNode
+{
+    std::string name;
+    uint32_t uid = 0;
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::vec4 rotation = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    glm::vec3 scale = glm::vec3(1.0f);
+    int mesh = -1;
+    bool meshChild = false;
+    std::vector<CookedNode> childs;
+};
+
+struct CookedMesh
+{
+    const aiMesh* assimpMesh = nullptr;
+    unsigned int assimpIndex = 0;
+    std::string libraryPath;
+    std::string texturePath;
+    bool hasMaterial = false;
+    bool written = false;
+};
+
+struct ModelCookState
+{
+    const aiScene* scene = nullptr;
+    FileIndex* textureFiles = nullptr;
+    uint64_t pathHash = 0;
+    uint32_t nextNode = 0;
+    std::vector<CookedMesh> meshes;
+
+    //COOKED MESHES STILL TO CONVERT EACH ASSIMP MESH, THE LAST ONE FREES IT
+    std::vector<std::atomic<int>> assimpUses;
+};
+
+//SAME RENAMING AS GameObject::AddChild, SO THE NAMES MATCH AN EDITOR IMPORT
+static void AddCookedChild(CookedNode& parent, CookedNode child)
+{
+    std::string baseName = child.name;
+    int counter = 1;
+
+    while (std::any_of(parent.childs.begin(), parent.childs.end(), [&child](const CookedNode& other) { return other.name == child.name; }))
+    {
+        child.name = baseName + " (" + std::to_string(counter++) + ")";
+    }
+
+    parent.childs.push_back(std::move(child));
+}
+
+static CookedNode CreateCookedNode(ModelCookState& state, const std::string& name)
+{
+    //STABLE BETWEEN COOKS OF THE SAME FILE, EVERY INSTANCE GETS FRESH ONES WHEN IT IS LOADED
+    uint32_t index = state.nextNode++;
+    uint32_t uid = (uint32_t)HashFNV1a(&index, sizeof(index), state.pathHash);
+
+    CookedNode node;
+    node.name = name;
+    node.uid = uid != 0 ? uid : 1;
+    return node;
+}
+
+static void AttachCookedMesh(ModelCookState& state, CookedNode& node, unsigned int assimpIndex)
+{
+    const aiMesh* assimpMesh = state.scene->mMeshes[assimpIndex];
+
+    CookedMesh mesh;
+    mesh.assimpMesh = assimpMesh;
+    mesh.assimpIndex = assimpIndex;
+
+    if (state.scene->HasMaterials())
+    {
+        mesh.hasMaterial = true;
+        mesh.texturePath = FindMaterialTexture(state.scene->mMaterials[assimpMesh->mMaterialIndex], *state.textureFiles);
+    }
+
+    node.mesh = (int)state.meshes.size();
+    state.meshes.push_back(mesh);
+}
+
+static CookedNode BuildCookedNode(ModelCookState& state, const aiNode* node)
+{
+    CookedNode cookedNode = CreateCookedNode(state, node->mName.C_Str());
+
+    aiVector3D position;
+    aiQuaternion rotation;
+    aiVector3D scaling;
+    node->mTransformation.Decompose(scaling, rotation, position);
+
+    cookedNode.position = glm::vec3(position.x, position.y, position.z);
+    cookedNode.rotation = glm::vec4(rotation.x, rotation.y, rotation.z, rotation.w);
+    cookedNode.scale = glm::vec3(scaling.x, scaling.y, scaling.z);
+
+    //ONE MESH GOES ON THE NODE ITSELF, SEVERAL GET A CHILD EACH
+    for (unsigned int i = 0; i < node->mNumMeshes; i++)
+    {
+        const aiMesh* assimpMesh = state.scene->mMeshes[node->mMeshes[i]];
+
+        if (node->mNumMeshes == 1)
+        {
+            AttachCookedMesh(state, cookedNode, node->mMeshes[i]);
+            continue;
+        }
+
+        CookedNode meshNode = CreateCookedNode(state, assimpMesh->mName.C_Str());
+        meshNode.meshChild = true;
+        AttachCookedMesh(state, meshNode, node->mMeshes[i]);
+        AddCookedChild(cookedNode, std::move(meshNode));
+    }
+
+    for (unsigned int i = 0; i < node->mNumChildren; i++)
+    {
+        AddCookedChild(cookedNode, BuildCookedNode(state, node->mChildren[i]));
+    }
+
+    return cookedNode;
+}
+
+//FINAL NAMES ARE ONLY KNOWN ONCE THE TREE IS BUILT
+static void AssignMeshPaths(ModelCookState& state, const CookedNode& node)
+{
+    if (node.mesh >= 0)
+    {
+        state.meshes[node.mesh].libraryPath = std::string(MESH_LIBRARY_DIRECTORY) + "/" + node.name + "_" + std::to_string(node.uid) + ".W16Mesh";
+    }
+
+    for (const CookedNode& child : node.childs) AssignMeshPaths(state, child);
+}
+
+static bool WriteCookedMesh(ModelCookState& state, const CookedMesh& mesh, const ModelCookSettings& settings)
+{
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    ConvertAssimpMesh(mesh.assimpMesh, vertices, indices);
+
+    //FROM HERE ONLY THE CONVERTED COPY IS NEEDED
+    if (--state.assimpUses[mesh.assimpIndex] == 0) ReleaseAssimpMeshData(state.scene->mMeshes[mesh.assimpIndex]);
+
+    if (vertices.empty() || indices.empty())
+    {
+        LOG("Error: Assimp mesh read but empty vectors.");
+        return false;
+    }
+
+    AABB bounds;
+    bounds.min = glm::vec3(INFINITY);
+    bounds.max = glm::vec3(-INFINITY);
+
+    for (const Vertex& vertex : vertices)
+    {
+        bounds.min = glm::min(bounds.min, vertex.position);
+        bounds.max = glm::max(bounds.max, vertex.position);
+    }
+
+    MeshFileData fileData;
+    fileData.numVertices = (uint32_t)vertices.size();
+    fileData.numIndices = (uint32_t)indices.size();
+    fileData.aabbMin = bounds.min;
+    fileData.aabbMax = bounds.max;
+    fileData.vertexData = vertices.data();
+    fileData.indexData = indices.data();
+
+    std::vector<PackedVertex> packedVertices;
+    std::vector<uint16_t> shortIndices;
+
+    if (settings.packedVertexFormat)
+    {
+        packedVertices.resize(vertices.size());
+        PackVertices(vertices, bounds, packedVertices);
+        fileData.vertexFormat = VertexFormat::Packed;
+        fileData.vertexData = packedVertices.data();
+
+        if (CanUseShortIndices(vertices.size()))
+        {
+            shortIndices.resize(indices.size());
+            PackIndices(indices, shortIndices);
+            fileData.indexFormat = IndexFormat::UInt16;
+            fileData.indexData = shortIndices.data();
+        }
+    }
+
+    return WriteMeshFile(mesh.libraryPath, fileData, settings.compressMeshes);
+}
+
+static void SaveCookedNode(pugi::xml_node gameObjectNode, const CookedNode& node, uint32_t parentUID, const std::vector<CookedMesh>& meshes)
+{
+    gameObjectNode.append_attribute("Name") = node.name.c_str();
+    gameObjectNode.append_attribute("UID") = node.uid;
+    gameObjectNode.append_attribute("ParentUID") = parentUID;
+    gameObjectNode.append_attribute("Enabled") = true;
+
+    pugi::xml_node componentsNode = gameObjectNode.append_child("Components");
+
+    pugi::xml_node transformNode = componentsNode.append_child("Component");
+    transformNode.append_attribute("type") = (int)ComponentType::Transform;
+
+    pugi::xml_node positionNode = transformNode.append_child("Position");
+    positionNode.append_attribute("x") = node.position.x;
+    positionNode.append_attribute("y") = node.position.y;
+    positionNode.append_attribute("z") = node.position.z;
+
+    pugi::xml_node rotationNode = transformNode.append_child("Rotation");
+    rotationNode.append_attribute("x") = node.rotation.x;
+    rotationNode.append_attribute("y") = node.rotation.y;
+    rotationNode.append_attribute("z") = node.rotation.z;
+    rotationNode.append_attribute("w") = node.rotation.w;
+
+    pugi::xml_node scaleNode = transformNode.append_child("Scale");
+    scaleNode.append_attribute("x") = node.scale.x;
+    scaleNode.append_attribute("y") = node.scale.y;
+    scaleNode.append_attribute("z") = node.scale.z;
+
+    //A MESH THAT FAILED TO COOK LEAVES THE NODE EMPTY
+    if (node.mesh >= 0 && meshes[node.mesh].written)
+    {
+        const CookedMesh& mesh = meshes[node.mesh];
+
+        pugi::xml_node meshNode = componentsNode.append_child("Component");
+        meshNode.append_attribute("type") = (int)ComponentType::Mesh;
+        meshNode.append_attribute("path") = mesh.libraryPath.c_str();
+
+        if (mesh.hasMaterial)
+        {
+            pugi::xml_node textureNode = componentsNode.append_child("Component");
+            textureNode.append_attribute("type") = (int)ComponentType::Texture;
+            textureNode.append_attribute("path") = mesh.texturePath.c_str();
+            textureNode.append_attribute("useChecker") = false;
+            textureNode.append_attribute("transparent") = false;
+        }
+    }
+
+    if (node.childs.empty()) return;
+
+    pugi::xml_node childsNode = gameObjectNode.append_child("Childs");
+    for (const CookedNode& child : node.childs)
+    {
+        //EXTRA CHILDREN OF A NODE WITH SEVERAL MESHES ONLY EXIST FOR THEIR MESH
+        if (child.meshChild && !meshes[child.mesh].written) continue;
+
+        SaveCookedNode(childsNode.append_child("GameObject"), child, node.uid, meshes);
+    }
+}
+
+bool CookModel(const std::string& sourcePath, const ModelCookSettings& settings, bool& skipped)
+{
+    uint64_t settingsHash = GetModelSettingsHash(settings);
+
+    ImportRecord record;
+    skipped = ImportDatabase::GetInstance().Find(sourcePath, settingsHash, record);
+    if (skipped) return true;
+
+    Assimp::Importer importer;
+    const aiScene* scene = ReadModel(importer, sourcePath, settings.profile);
+    if (!scene) return false;
+
+    std::string canonicalPath = CanonicalPath(sourcePath);
+
+    ModelCookState state;
+    state.scene = scene;
+    FileIndex textureFiles(GetDirectoryFromPath(sourcePath));
+    state.textureFiles = &textureFiles;
+    state.pathHash = HashFNV1a(canonicalPath.data(), canonicalPath.size());
+
+    CookedNode root = BuildCookedNode(state, scene->mRootNode);
+    AssignMeshPaths(state, root);
+
+    SDL_CreateDirectory(MESH_LIBRARY_DIRECTORY);
+    SDL_CreateDirectory(MODEL_LIBRARY_DIRECTORY);
+
+    state.assimpUses = std::vector<std::atomic<int>>(scene->mNumMeshes);
+    for (const CookedMesh& mesh : state.meshes) state.assimpUses[mesh.assimpIndex]++;
+
+    JobSystem& jobs = JobSystem::GetInstance();
+
+    //A SINGLE BATCH RUNS ON THIS THREAD, IN ORDER. THE ALLOCATION COUNTER IS GLOBAL, SO THE BENCHMARK NEEDS IT TOO
+#ifdef W16_COUNT_ALLOCATIONS
+    size_t batchSize = state.meshes.size();
+#else
+    size_t batchSize = settings.lowMemory ? state.meshes.size() : 1;
+#endif
+
+    jobs.ParallelFor(state.meshes.size(), batchSize, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            size_t allocationsBefore = GetAllocationCount();
+            state.meshes[i].written = WriteCookedMesh(state, state.meshes[i], settings);
+
+#ifdef W16_COUNT_ALLOCATIONS
+            LOG("Allocation benchmark: %s used %zu heap allocations from conversion to Library file", state.meshes[i].assimpMesh->mName.C_Str(), GetAllocationCount() - allocationsBefore);
+#else
+            (void)allocationsBefore;
+#endif
+        }
+    });
+
+    //EVERY TEXTURE ONCE, IN THE FORMAT THE EDITOR ASKS FOR BY DEFAULT
+    std::vector<std::string> textures;
+    for (const CookedMesh& mesh : state.meshes)
+    {
+        if (!mesh.texturePath.empty() && ClaimTexture(mesh.texturePath)) textures.push_back(mesh.texturePath);
+    }
+
+    TextureFormat textureFormat = GetCookFormat(TextureUsage::Color, settings.compressTextures, settings.textureQuality);
+
+    jobs.ParallelFor(textures.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            CookedTexture cooked;
+            if (!CookTexture(textures[i], textureFormat, settings.textureQuality, cooked)) LOG("Error cooking texture: %s", textures[i].c_str());
+        }
+    });
+
+    std::string cookedPath = GetCookedModelPath(sourcePath);
+
+    pugi::xml_document doc;
+    SaveCookedNode(doc.append_child("Model").append_child("GameObject"), root, 0, state.meshes);
+
+    if (!doc.save_file(cookedPath.c_str()))
+    {
+        LOG("Error: Could not save cooked model %s", cookedPath.c_str());
+        return false;
+    }
+
+    std::vector<std::string> artifacts;
+    for (const CookedMesh& mesh : state.meshes)
+    {
+        if (mesh.written) artifacts.push_back(mesh.libraryPath);
+    }
+
+    LOG("Model cooked into Library: %s (%d meshes, %d textures)", cookedPath.c_str(), (int)artifacts.size(), (int)textures.size());
+
+    return ImportDatabase::GetInstance().Record(sourcePath, settingsHash, cookedPath, artifacts);
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include "BlockCompression.h"
+#include <string>
+#include <vector>
+#include <cstdint>
+
+struct aiMaterial;
+struct aiScene;
+class FileIndex;
+
+namespace Assimp { class Importer; }
+
+#define MODEL_LIBRARY_DIRECTORY "Library/Models"
+#define MESH_LIBRARY_DIRECTORY "Library/Meshes"
+
+//Assimp post processing presets. Editable keeps the hierarchy of the file as it is, RuntimeOptimized also merges
+//meshes, collapses the transform nodes nothing refers to and reorders triangles for the vertex cache.
+enum class ModelImportProfile
+{
+    Editable,
+    RuntimeOptimized,
+    Count
+};
+
+const char* GetImportProfileName(ModelImportProfile profile);
+
+//By the names GetImportProfileName gives. False if there is no such profile.
+bool FindImportProfile(const std::string& name, ModelImportProfile& profile);
+
+//Importer options that change what a cook writes. The editor fills them from its settings, w16cook from its arguments.
+struct ModelCookSettings
+{
+    bool packedVertexFormat = true;
+    bool compressMeshes = true;
+    bool compressTextures = true;
+    BlockQuality textureQuality = BlockQuality::Fast;
+    ModelImportProfile profile = ModelImportProfile::Editable;
+
+    //ONE MESH AT A TIME, SO ONLY ONE CONVERTED COPY IS EVER ALIVE. DOESN'T CHANGE WHAT IS WRITTEN
+    bool lowMemory = false;
+};
+
+//Assimp post processing of the profile
+unsigned int GetModelImportFlags(ModelImportProfile profile);
+
+//Reads the model and post processes it with the profile, logging the node, mesh and vertex counts of the file and of
+//the result. nullptr on error, the scene belongs to the importer.
+const aiScene* ReadModel(Assimp::Importer& importer, const std::string& path, ModelImportProfile profile);
+
+//Key of the settings in the import database. Textures are validated by their own cooked file names, so only what
+//changes the meshes and the hierarchy counts.
+uint64_t GetModelSettingsHash(const ModelCookSettings& settings);
+
+//Library/Models/<file name>_<path hash>.W16Model, one per source path
+std::string GetCookedModelPath(const std::string& sourcePath);
+
+//Diffuse texture of the material: its path as written, relative to the model, then the file name anywhere under the
+//model directory. files indexes that directory, one per import. Empty if the material has none or it can't be found.
+std::string FindMaterialTexture(const aiMaterial* material, FileIndex& files);
+
+//Imports the model without GL or GameObjects: writes every mesh, the diffuse textures and the hierarchy (the layout
+//GameObject::Save writes) to the Library and records them in the import database. Meshes and textures are cooked in
+//parallel on the job system. Skipped when the database says the cooked model is still valid.
+bool CookModel(const std::string& sourcePath, const ModelCookSettings& settings, bool& skipped);
@@ -0,0 +1,188 @@
+#include "Prefab.h"
+#include "MeshCache.h"
+#include "TextureCache.h"
+#include "AABB.h"
+#include "Log.h"
+#include "../GameObject.h"
+#include "../components/Mesh.h"
+#include "../components/Texture.h"
+#include "../components/Transform.h"
+
+#include "pugixml.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <cmath>
+
+Prefab::~Prefab()
+{
+    Release();
+}
+
+bool Prefab::Load(pugi::xml_node gameObjectNode)
+{
+    Release();
+
+    if (!gameObjectNode) return false;
+
+    boundsMin = glm::vec3(INFINITY, INFINITY, INFINITY);
+    boundsMax = glm::vec3(-INFINITY, -INFINITY, -INFINITY);
+
+    if (!FlattenNode(gameObjectNode, -1, glm::mat4(1.0f)))
+    {
+        Release();
+        return false;
+    }
+
+    //NO MESH AT ALL
+    if (boundsMin.x > boundsMax.x)
+    {
+        boundsMin = glm::vec3(0.0f);
+        boundsMax = glm::vec3(0.0f);
+    }
+
+    return true;
+}
+
+bool Prefab::LoadFile(const std::string& cookedPath)
+{
+    pugi::xml_document doc;
+    if (!doc.load_file(cookedPath.c_str()))
+    {
+        LOG("Error: Invalid cooked model %s", cookedPath.c_str());
+        return false;
+    }
+
+    return Load(doc.child("Model").child("GameObject"));
+}
+
+void Prefab::Release()
+{
+    for (PrefabNode& node : nodes)
+    {
+        Mesh::UnloadResource(node.mesh);
+        TextureCache::GetInstance().Release(node.texture);
+    }
+
+    nodes.clear();
+}
+
+bool Prefab::FlattenNode(pugi::xml_node gameObjectNode, int parent, const glm::mat4& parentMatrix)
+{
+    int index = (int)nodes.size();
+    nodes.emplace_back();
+
+    //THE VECTOR GROWS WHILE THE CHILDS ARE ADDED, SO NODES ARE ALWAYS ACCESSED BY INDEX
+    nodes[index].name = gameObjectNode.attribute("Name").as_string();
+    nodes[index].parent = parent;
+    nodes[index].enabled = gameObjectNode.attribute("Enabled").as_bool(true);
+    if (parent >= 0) nodes[parent].numChilds++;
+
+    for (pugi::xml_node componentNode = gameObjectNode.child("Components").child("Component"); componentNode; componentNode = componentNode.next_sibling("Component"))
+    {
+        PrefabNode& node = nodes[index];
+
+        switch ((ComponentType)componentNode.attribute("type").as_int())
+        {
+        case ComponentType::Transform:
+        {
+            pugi::xml_node position = componentNode.child("Position");
+            pugi::xml_node rotation = componentNode.child("Rotation");
+            pugi::xml_node scale = componentNode.child("Scale");
+
+            if (position) node.position = glm::vec3(position.attribute("x").as_float(), position.attribute("y").as_float(), position.attribute("z").as_float());
+            if (rotation) node.rotation = glm::quat(rotation.attribute("w").as_float(), rotation.attribute("x").as_float(), rotation.attribute("y").as_float(), rotation.attribute("z").as_float());
+            if (scale) node.scale = glm::vec3(scale.attribute("x").as_float(), scale.attribute("y").as_float(), scale.attribute("z").as_float());
+            break;
+        }
+        case ComponentType::Mesh:
+        {
+            std::string path = componentNode.attribute("path").as_string();
+
+            node.mesh = Mesh::LoadResource(path);
+            if (!node.mesh)
+            {
+                LOG("Error: Prefab mesh %s could not be loaded", path.c_str());
+                return false;
+            }
+            break;
+        }
+        case ComponentType::Texture:
+        {
+            node.hasTexture = true;
+            node.texturePath = componentNode.attribute("path").as_string();
+            node.useChecker = componentNode.attribute("useChecker").as_bool();
+            node.transparent = componentNode.attribute("transparent").as_bool();
+
+            //A MISSING IMAGE KEEPS ITS PATH AND DRAWS THE CHECKER, LIKE Texture::Load
+            node.texture = TextureCache::GetInstance().Acquire(node.texturePath, node.transparent ? TextureUsage::ColorAlpha : TextureUsage::Color);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    const PrefabNode& node = nodes[index];
+    glm::mat4 matrix = parentMatrix * glm::translate(glm::mat4(1.0f), node.position) * glm::mat4_cast(node.rotation) * glm::scale(glm::mat4(1.0f), node.scale);
+
+    if (node.mesh)
+    {
+        AABB localAABB;
+        localAABB.min = node.mesh->aabbMin;
+        localAABB.max = node.mesh->aabbMax;
+
+        AABB globalAABB = localAABB.GetGlobalAABB(matrix);
+        boundsMin = glm::min(boundsMin, globalAABB.min);
+        boundsMax = glm::max(boundsMax, globalAABB.max);
+    }
+
+    for (pugi::xml_node childNode = gameObjectNode.child("Childs").child("GameObject"); childNode; childNode = childNode.next_sibling("GameObject"))
+    {
+        if (!FlattenNode(childNode, index, matrix)) return false;
+    }
+
+    return true;
+}
+
+GameObject* Prefab::Instantiate(const glm::vec3& offset) const
+{
+    if (nodes.empty()) return nullptr;
+
+    std::vector<GameObject*> created(nodes.size());
+
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        const PrefabNode& node = nodes[i];
+
+        GameObject* gameObject = new GameObject(node.enabled, node.name);
+        gameObject->childs.reserve(node.numChilds);
+        created[i] = gameObject;
+
+        //SIBLING NAMES WERE MADE UNIQUE WHEN THE MODEL WAS COOKED, SO AddChild'S SEARCH IS SKIPPED
+        if (node.parent >= 0)
+        {
+            GameObject* parent = created[node.parent];
+            gameObject->parent = parent;
+            gameObject->parentUUID = parent->UUID;
+            parent->childs.push_back(gameObject);
+        }
+
+        gameObject->transform->SetLocalTransform(node.parent < 0 ? node.position + offset : node.position, node.rotation, node.scale);
+
+        if (node.mesh)
+        {
+            Mesh* mesh = (Mesh*)gameObject->AddComponent(ComponentType::Mesh);
+            mesh->ShareResource(node.mesh);
+        }
+
+        if (node.hasTexture)
+        {
+            Texture* texture = (Texture*)gameObject->AddComponent(ComponentType::Texture);
+            texture->use_checker = node.useChecker;
+            texture->transparent = node.transparent;
+            texture->ShareTexture(node.texturePath, node.texture);
+        }
+    }
+
+    return created[0];
+}
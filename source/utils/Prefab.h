@@ -0,0 +1,62 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+#include "glm/gtc/quaternion.hpp"
+
+class GameObject;
+struct MeshResource;
+struct TextureResource;
+
+namespace pugi { class xml_node; }
+
+//One node of a flattened hierarchy. Parents always come before their childs.
+struct PrefabNode
+{
+    std::string name;
+    int parent = -1;
+    int numChilds = 0;
+    bool enabled = true;
+
+    glm::vec3 position = glm::vec3(0.0f);
+    glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    glm::vec3 scale = glm::vec3(1.0f);
+
+    MeshResource* mesh = nullptr;
+
+    bool hasTexture = false;
+    std::string texturePath;
+    const TextureResource* texture = nullptr;
+    bool useChecker = false;
+    bool transparent = false;
+};
+
+//A cooked model loaded once as a template. It holds a reference to every mesh and texture it uses, so an instance only
+//copies handles: no files, no XML and no Assimp, just the GameObjects and their components.
+class Prefab
+{
+public:
+    ~Prefab();
+
+    //From the hierarchy of a cooked model (Transform, Mesh and Texture components). Meshes that aren't loaded yet are
+    //read from the Library now. False if a mesh can't be read.
+    bool Load(pugi::xml_node gameObjectNode);
+    bool LoadFile(const std::string& cookedPath);
+    void Release();
+
+    //A new tree with the root moved by offset, not in the scene yet. UUIDs are new, names are the ones of the model.
+    GameObject* Instantiate(const glm::vec3& offset = glm::vec3(0.0f)) const;
+
+    size_t GetNumNodes() const { return nodes.size(); }
+
+    //Of the whole model, in the space of its root's parent
+    glm::vec3 GetSize() const { return boundsMax - boundsMin; }
+
+private:
+    bool FlattenNode(pugi::xml_node gameObjectNode, int parent, const glm::mat4& parentMatrix);
+
+private:
+    std::vector<PrefabNode> nodes;
+    glm::vec3 boundsMin = glm::vec3(0.0f);
+    glm::vec3 boundsMax = glm::vec3(0.0f);
+};
@@ -0,0 +1,35 @@
+#include "ProcessMemory.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#ifdef _WIN32
+
+size_t GetPeakResidentBytes()
+{
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+
+    return counters.PeakWorkingSetSize;
+}
+
+#else
+
+size_t GetPeakResidentBytes()
+{
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+
+    //KILOBYTES ON LINUX, BYTES ON MACOS
+#ifdef __APPLE__
+    return (size_t)usage.ru_maxrss;
+#else
+    return (size_t)usage.ru_maxrss * 1024;
+#endif
+}
+
+#endif
@@ -0,0 +1,5 @@
+#pragma once
+#include <cstddef>
+
+//Highest working set the process has reached since it started, in bytes. 0 if the OS doesn't report it.
+size_t GetPeakResidentBytes();
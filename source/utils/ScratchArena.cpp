@@ -0,0 +1,61 @@
+#include "ScratchArena.h"
+#include <algorithm>
+
+#define SCRATCH_ARENA_ALIGNMENT 64
+
+ScratchArena& ScratchArena::GetThreadArena()
+{
+    thread_local ScratchArena arena;
+    return arena;
+}
+
+void* ScratchArena::AllocateBytes(size_t bytes)
+{
+    if (bytes == 0) bytes = 1;
+
+    while (currentBlock < blocks.size())
+    {
+        Block& block = blocks[currentBlock];
+        uintptr_t base = reinterpret_cast<uintptr_t>(block.memory.get());
+        size_t alignedOffset = ((base + currentOffset + SCRATCH_ARENA_ALIGNMENT - 1) & ~(uintptr_t)(SCRATCH_ARENA_ALIGNMENT - 1)) - base;
+
+        if (alignedOffset + bytes <= block.capacity)
+        {
+            currentOffset = alignedOffset + bytes;
+            return block.memory.get() + alignedOffset;
+        }
+
+        //THE NEXT BLOCK IS ONLY REUSED IF THE REQUEST FITS, OTHERWISE IT'S REPLACED BY A BIGGER ONE
+        if (currentBlock + 1 < blocks.size() && blocks[currentBlock + 1].capacity < bytes + SCRATCH_ARENA_ALIGNMENT)
+        {
+            blocks.resize(currentBlock + 1);
+        }
+
+        if (currentBlock + 1 >= blocks.size()) break;
+
+        currentBlock++;
+        currentOffset = 0;
+    }
+
+    Block block;
+    block.capacity = std::max((size_t)SCRATCH_ARENA_BLOCK_SIZE, bytes + SCRATCH_ARENA_ALIGNMENT);
+    block.memory.reset(new uint8_t[block.capacity]);
+    blocks.push_back(std::move(block));
+
+    currentBlock = blocks.size() - 1;
+    currentOffset = 0;
+    return AllocateBytes(bytes);
+}
+
+void ScratchArena::Rewind(const Marker& marker)
+{
+    currentBlock = marker.block;
+    currentOffset = marker.offset;
+}
+
+size_t ScratchArena::GetReservedBytes() const
+{
+    size_t bytes = 0;
+    for (const Block& block : blocks) bytes += block.capacity;
+    return bytes;
+}
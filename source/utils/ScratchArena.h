@@ -0,0 +1,64 @@
+#pragma once
+#include "Span.h"
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+#define SCRATCH_ARENA_BLOCK_SIZE (4 * 1024 * 1024)
+
+//Per thread bump allocator for temporary import buffers. Memory is kept between meshes, so after the first
+//few imports temporaries don't hit the heap. Use a ScratchScope to give back everything allocated inside it.
+class ScratchArena
+{
+public:
+    static ScratchArena& GetThreadArena();
+
+    //Uninitialized storage, aligned to 64 bytes
+    template<typename T>
+    Span<T> Allocate(size_t count)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Scratch memory is never constructed or destroyed");
+        return Span<T>(static_cast<T*>(AllocateBytes(count * sizeof(T))), count);
+    }
+
+    struct Marker
+    {
+        size_t block;
+        size_t offset;
+    };
+
+    Marker GetMarker() const { return { currentBlock, currentOffset }; }
+    void Rewind(const Marker& marker);
+
+    size_t GetReservedBytes() const;
+
+private:
+    void* AllocateBytes(size_t bytes);
+
+    struct Block
+    {
+        std::unique_ptr<uint8_t[]> memory;
+        size_t capacity;
+    };
+
+    std::vector<Block> blocks;
+    size_t currentBlock = 0;
+    size_t currentOffset = 0;
+};
+
+class ScratchScope
+{
+public:
+    ScratchScope() : arena(ScratchArena::GetThreadArena()), marker(arena.GetMarker()) {}
+    ~ScratchScope() { arena.Rewind(marker); }
+
+    ScratchScope(const ScratchScope&) = delete;
+    ScratchScope& operator=(const ScratchScope&) = delete;
+
+    template<typename T>
+    Span<T> Allocate(size_t count) { return arena.Allocate<T>(count); }
+
+private:
+    ScratchArena& arena;
+    ScratchArena::Marker marker;
+};
@@ -0,0 +1,32 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <type_traits>
+
+//Non owning view over contiguous elements, like C++20 std::span
+template<typename T>
+class Span
+{
+public:
+    Span() : data(nullptr), size(0) {}
+    Span(T* data, size_t size) : data(data), size(size) {}
+
+    template<typename U, typename = typename std::enable_if<std::is_same<typename std::remove_const<T>::type, U>::value>::type>
+    Span(std::vector<U>& vector) : data(vector.data()), size(vector.size()) {}
+
+    template<typename U, typename = typename std::enable_if<std::is_same<T, const U>::value>::type>
+    Span(const std::vector<U>& vector) : data(vector.data()), size(vector.size()) {}
+
+    T* Data() const { return data; }
+    size_t Size() const { return size; }
+    bool Empty() const { return size == 0; }
+
+    T& operator[](size_t i) const { return data[i]; }
+
+    T* begin() const { return data; }
+    T* end() const { return data + size; }
+
+private:
+    T* data;
+    size_t size;
+};
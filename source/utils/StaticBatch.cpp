@@ -0,0 +1,474 @@
+#include "StaticBatch.h"
+#include "Tree.h"
+#include "Frustum.h"
+#include "JobSystem.h"
+#include "VertexPacking.h"
+#include "MeshSimplify.h"
+#include "MeshFile.h"
+#include "MappedFile.h"
+#include "Hash.h"
+#include "TextureCache.h"
+#include "Log.h"
+#include "../GameObject.h"
+#include "../Engine.h"
+#include "../Render.h"
+#include "../Loader.h"
+#include "../components/Texture.h"
+#include "SDL3/SDL_filesystem.h"
+
+#include <string>
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+
+#define STATIC_BATCH_JOB_OBJECTS 16
+#define HLOD_KEY_VERSION 2
+
+struct BatchSource
+{
+    Mesh* mesh;
+    glm::mat4 matrix;
+    const std::vector<Vertex>* vertices;
+    const std::vector<unsigned int>* indices;
+    size_t firstVertex;
+    size_t firstIndex;
+};
+
+//GEOMETRY MAY BE PAGED IN FROM THE LIBRARY HERE, SO THIS PART STAYS ON THE MAIN THREAD
+static void GatherSources(const std::vector<GameObject*>& objects, std::vector<BatchSource>& sources, size_t& numVertices, size_t& numIndices, AABB& bounds)
+{
+    sources.clear();
+    sources.reserve(objects.size());
+    numVertices = 0;
+    numIndices = 0;
+    bounds.min = glm::vec3(INFINITY);
+    bounds.max = glm::vec3(-INFINITY);
+
+    for (GameObject* gameObject : objects)
+    {
+        BatchSource source;
+        source.mesh = (Mesh*)gameObject->GetComponent(ComponentType::Mesh);
+        if (!gameObject->TryGetGlobalMatrix(source.matrix)) continue;
+
+        source.vertices = &source.mesh->GetVertices();
+        source.indices = &source.mesh->GetIndices();
+        if (source.vertices->empty() || source.indices->empty()) continue;
+
+        source.firstVertex = numVertices;
+        source.firstIndex = numIndices;
+        numVertices += source.vertices->size();
+        numIndices += source.indices->size();
+
+        AABB globalAABB = source.mesh->aabb->GetGlobalAABB(source.matrix);
+        bounds.min = glm::min(bounds.min, globalAABB.min);
+        bounds.max = glm::max(bounds.max, globalAABB.max);
+
+        sources.push_back(source);
+    }
+}
+
+//PRE-TRANSFORM INTO WORLD SPACE
+static void MergeSources(const std::vector<BatchSource>& sources, size_t numVertices, size_t numIndices, std::vector<Vertex>& vertices, std::vector<unsigned int>& indices)
+{
+    vertices.resize(numVertices);
+    indices.resize(numIndices);
+
+    JobSystem::GetInstance().ParallelFor(sources.size(), STATIC_BATCH_JOB_OBJECTS, [&](size_t begin, size_t end) {
+        for (size_t s = begin; s < end; s++)
+        {
+            const BatchSource& source = sources[s];
+            glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(source.matrix)));
+
+            for (size_t i = 0; i < source.vertices->size(); i++)
+            {
+                const Vertex& in = (*source.vertices)[i];
+                Vertex& out = vertices[source.firstVertex + i];
+
+                out.position = glm::vec3(source.matrix * glm::vec4(in.position, 1.0f));
+                out.normal = glm::normalize(normalMatrix * in.normal);
+                out.texCoords = in.texCoords;
+            }
+
+            for (size_t i = 0; i < source.indices->size(); i++)
+            {
+                indices[source.firstIndex + i] = (*source.indices)[i] + (unsigned int)source.firstVertex;
+            }
+        }
+    });
+}
+
+static bool UploadBatch(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices, StaticBatch& batch)
+{
+    batch.meshData.numVertices = (int)vertices.size();
+    batch.meshData.numIndices = (int)indices.size();
+    batch.meshData.vertexFormat = VertexFormat::Full;
+
+    if (CanUseShortIndices(vertices.size()))
+    {
+        std::vector<uint16_t> shortIndices(indices.size());
+        PackIndices(indices, shortIndices);
+        batch.meshData.indexFormat = IndexFormat::UInt16;
+        return Engine::GetInstance().render->UploadMeshToGPU(batch.meshData, vertices.data(), shortIndices.data());
+    }
+
+    batch.meshData.indexFormat = IndexFormat::UInt32;
+    return Engine::GetInstance().render->UploadMeshToGPU(batch.meshData, vertices.data(), indices.data());
+}
+
+//SAME MESHES IN THE SAME PLACES GIVE THE SAME KEY, ACROSS SESSIONS TOO. A LIBRARY FILE COOKED AGAIN UNDER THE SAME NAME
+//CHANGES ITS CONTENT HASH, SO ITS OLD PROXIES ARE NOT REUSED
+static uint64_t GetProxyKey(const std::vector<GameObject*>& objects, bool hasUVs)
+{
+    uint32_t header[3] = { HLOD_KEY_VERSION, HLOD_GRID_RESOLUTION, hasUVs ? 1u : 0u };
+    uint64_t key = HashFNV1a(header, sizeof(header));
+
+    for (GameObject* gameObject : objects)
+    {
+        Mesh* mesh = (Mesh*)gameObject->GetComponent(ComponentType::Mesh);
+        glm::mat4 matrix = glm::mat4(1.0f);
+        gameObject->TryGetGlobalMatrix(matrix);
+
+        int32_t counts[2] = { mesh->meshData.numVertices, mesh->meshData.numIndices };
+        key = HashFNV1a(mesh->libraryPath.data(), mesh->libraryPath.size(), key);
+        key = HashFNV1a(&mesh->contentHash, sizeof(mesh->contentHash), key);
+        key = HashFNV1a(&gameObject->UUID, sizeof(gameObject->UUID), key);
+        key = HashFNV1a(counts, sizeof(counts), key);
+        key = HashFNV1a(&matrix[0][0], sizeof(float) * 16, key);
+    }
+
+    return key;
+}
+
+static std::string GetProxyPath(uint64_t key)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx", (unsigned long long)key);
+    return std::string(HLOD_LIBRARY_DIRECTORY) + "/" + name + ".W16Mesh";
+}
+
+static bool LoadProxy(const std::string& path, StaticBatch& batch)
+{
+    if (!SDL_GetPathInfo(path.c_str(), nullptr)) return false;
+
+    MappedFile file;
+    MeshFileData fileData;
+    if (!file.Open(path) || !IsMeshFileV2(file) || !ReadMeshFile(file, fileData)) return false;
+    if (fileData.vertexFormat != VertexFormat::Full || fileData.numIndices == 0) return false;
+
+    batch.meshData.numVertices = (int)fileData.numVertices;
+    batch.meshData.numIndices = (int)fileData.numIndices;
+    batch.meshData.vertexFormat = fileData.vertexFormat;
+    batch.meshData.indexFormat = fileData.indexFormat;
+    batch.bounds.min = fileData.aabbMin;
+    batch.bounds.max = fileData.aabbMax;
+
+    return Engine::GetInstance().render->UploadMeshToGPU(batch.meshData, fileData.vertexData, fileData.indexData);
+}
+
+unsigned int StaticBatch::GetTextureID(unsigned int checkerTextureID) const
+{
+    return texture && texture->textureID != 0 ? texture->textureID : checkerTextureID;
+}
+
+StaticBatchNode::~StaticBatchNode()
+{
+    for (StaticBatch& batch : batches)
+    {
+        Engine::GetInstance().render->DeleteMeshFromGPU(batch.meshData);
+        TextureCache::GetInstance().Release(batch.texture);
+    }
+
+    for (StaticBatch& batch : proxy)
+    {
+        Engine::GetInstance().render->DeleteMeshFromGPU(batch.meshData);
+        TextureCache::GetInstance().Release(batch.texture);
+    }
+
+    for (StaticBatchNode* child : children)
+    {
+        delete child;
+    }
+}
+
+StaticBatcher::~StaticBatcher()
+{
+    delete root;
+}
+
+void StaticBatcher::Build(TreeNode* treeRoot, float hlodMinNodeSize)
+{
+    Clear();
+
+    bool hlod = hlodMinNodeSize > 0.0f;
+    std::unordered_set<uint64_t> previousKeys;
+
+    if (hlod)
+    {
+        SDL_CreateDirectory(HLOD_LIBRARY_DIRECTORY);
+        previousKeys.swap(proxyKeys);
+    }
+
+    BatchGroups groups;
+    if (treeRoot) root = BuildNode(treeRoot, hlodMinNodeSize, groups);
+
+    //CONTENTS CHANGED, THE OLD PROXIES WILL NEVER MATCH AGAIN
+    if (hlod)
+    {
+        for (uint64_t key : previousKeys)
+        {
+            if (proxyKeys.count(key) == 0) SDL_RemovePath(GetProxyPath(key).c_str());
+        }
+    }
+
+    LOG("Static batching merged %d objects into %d batches, %d HLOD proxies (%d cooked)", (int)members.size(), numBatches, numProxies, numCookedProxies);
+}
+
+void StaticBatcher::Clear()
+{
+    for (Mesh* mesh : members)
+    {
+        mesh->staticBatched = false;
+    }
+    members.clear();
+    memberBatches.clear();
+
+    delete root;
+    root = nullptr;
+    numBatches = 0;
+    numProxies = 0;
+    numCookedProxies = 0;
+}
+
+StaticBatchNode* StaticBatcher::BuildNode(TreeNode* treeNode, float hlodMinNodeSize, BatchGroups& parentGroups)
+{
+    StaticBatchNode* node = new StaticBatchNode();
+    node->bounds.min = glm::vec3(INFINITY);
+    node->bounds.max = glm::vec3(-INFINITY);
+
+    //GROUP BY THE STATE THE DEFAULT SHADER NEEDS, TRANSPARENT OBJECTS STAY SORTED PER OBJECT
+    BatchGroups groups;
+
+    //EVERY OBJECT BATCHED IN THIS NODE AND BELOW IT, FOR THE PROXY
+    BatchGroups subtreeGroups;
+
+    for (GameObject* gameObject : treeNode->gameObjects)
+    {
+        if (!gameObject->GetEnabled()) continue;
+
+        Mesh* mesh = (Mesh*)gameObject->GetComponent(ComponentType::Mesh);
+        if (!mesh || !mesh->enabled || mesh->meshData.VAO == 0) continue;
+        if (mesh->meshData.numIndices > STATIC_BATCH_MAX_MESH_INDICES) continue;
+
+        Texture* texture = (Texture*)gameObject->GetComponent(ComponentType::Texture);
+        if (texture && texture->transparent) continue;
+
+        //GROUPED BY RESOURCE, NOT GL TEXTURE: ONE STILL DECODING IS DRAWN WITH THE CHECKER UNTIL IT IS UPLOADED
+        const TextureResource* resource = texture && !texture->use_checker ? texture->resource : nullptr;
+
+        groups[std::make_pair(resource, mesh->hasUVs)].push_back(gameObject);
+    }
+
+    for (auto& group : groups)
+    {
+        StaticBatch batch;
+        batch.hasUVs = group.first.second;
+
+        BuildBatch(group.second, batch);
+
+        if (batch.numObjects == 0) continue;
+
+        batch.texture = TextureCache::GetInstance().AddReference(group.first.first);
+
+        node->bounds.min = glm::min(node->bounds.min, batch.bounds.min);
+        node->bounds.max = glm::max(node->bounds.max, batch.bounds.max);
+        node->batches.push_back(batch);
+        numBatches++;
+
+        for (Mesh* mesh : batch.meshes) memberBatches[mesh] = std::make_pair(node, node->batches.size() - 1);
+
+        std::vector<GameObject*>& subtreeGroup = subtreeGroups[group.first];
+        subtreeGroup.insert(subtreeGroup.end(), group.second.begin(), group.second.end());
+    }
+
+    for (TreeNode* treeChild : treeNode->children)
+    {
+        if (!treeChild) continue;
+
+        StaticBatchNode* child = BuildNode(treeChild, hlodMinNodeSize, subtreeGroups);
+        if (!child) continue;
+
+        node->bounds.min = glm::min(node->bounds.min, child->bounds.min);
+        node->bounds.max = glm::max(node->bounds.max, child->bounds.max);
+        child->parent = node;
+        node->children.push_back(child);
+    }
+
+    if (node->batches.empty() && node->children.empty())
+    {
+        delete node;
+        return nullptr;
+    }
+
+    glm::vec3 size = treeNode->limits.max - treeNode->limits.min;
+    if (hlodMinNodeSize > 0.0f && std::max(size.x, std::max(size.y, size.z)) >= hlodMinNodeSize)
+    {
+        BuildProxy(subtreeGroups, node->proxy);
+        if (!node->proxy.empty()) numProxies++;
+    }
+
+    //ONLY NOW, THE PARENT MAY ALREADY HOLD ITS OWN OBJECTS AND THOSE OF EARLIER SIBLINGS
+    for (auto& group : subtreeGroups)
+    {
+        std::vector<GameObject*>& parentGroup = parentGroups[group.first];
+        parentGroup.insert(parentGroup.end(), group.second.begin(), group.second.end());
+    }
+
+    return node;
+}
+
+void StaticBatcher::BuildBatch(const std::vector<GameObject*>& objects, StaticBatch& batch)
+{
+    std::vector<BatchSource> sources;
+    size_t numVertices = 0;
+    size_t numIndices = 0;
+    GatherSources(objects, sources, numVertices, numIndices, batch.bounds);
+
+    if (sources.empty()) return;
+
+    std::vector<Vertex> vertices;
+    std::vector<unsigned int> indices;
+    MergeSources(sources, numVertices, numIndices, vertices, indices);
+
+    if (!UploadBatch(vertices, indices, batch)) return;
+
+    for (const BatchSource& source : sources)
+    {
+        source.mesh->staticBatched = true;
+        members.push_back(source.mesh);
+        batch.meshes.push_back(source.mesh);
+    }
+    batch.numObjects = (int)sources.size();
+}
+
+void StaticBatcher::BuildProxy(const BatchGroups& groups, std::vector<StaticBatch>& proxy)
+{
+    for (const auto& group : groups)
+    {
+        StaticBatch batch;
+        batch.hasUVs = group.first.second;
+        batch.numObjects = (int)group.second.size();
+
+        uint64_t key = GetProxyKey(group.second, batch.hasUVs);
+        std::string path = GetProxyPath(key);
+
+        if (LoadProxy(path, batch))
+        {
+            proxyKeys.insert(key);
+            batch.texture = TextureCache::GetInstance().AddReference(group.first.first);
+            proxy.push_back(batch);
+            continue;
+        }
+
+        //COOK
+        std::vector<BatchSource> sources;
+        size_t numVertices = 0;
+        size_t numIndices = 0;
+        GatherSources(group.second, sources, numVertices, numIndices, batch.bounds);
+
+        if (sources.empty()) continue;
+
+        std::vector<Vertex> merged;
+        std::vector<unsigned int> mergedIndices;
+        MergeSources(sources, numVertices, numIndices, merged, mergedIndices);
+
+        std::vector<Vertex> vertices;
+        std::vector<unsigned int> indices;
+        SimplifyByClustering(merged, mergedIndices, batch.bounds, HLOD_GRID_RESOLUTION, vertices, indices);
+
+        if (indices.empty() || !UploadBatch(vertices, indices, batch)) continue;
+
+        MeshFileData fileData;
+        fileData.vertexFormat = VertexFormat::Full;
+        fileData.indexFormat = IndexFormat::UInt32;
+        fileData.numVertices = (uint32_t)vertices.size();
+        fileData.numIndices = (uint32_t)indices.size();
+        fileData.aabbMin = batch.bounds.min;
+        fileData.aabbMax = batch.bounds.max;
+        fileData.vertexData = vertices.data();
+        fileData.indexData = indices.data();
+
+        //STILL DRAWN THIS SESSION, BUT NOT COUNTED AS COOKED AND NOT KEPT AS A LIBRARY FILE
+        if (WriteMeshFile(path, fileData, Engine::GetInstance().loader->compressLibraryMeshes))
+        {
+            proxyKeys.insert(key);
+            numCookedProxies++;
+        }
+        else
+        {
+            LOG("Error: Could not cook HLOD proxy %s", path.c_str());
+        }
+
+        batch.texture = TextureCache::GetInstance().AddReference(group.first.first);
+        proxy.push_back(batch);
+    }
+}
+
+void StaticBatcher::Invalidate(Mesh* mesh)
+{
+    auto member = memberBatches.find(mesh);
+    if (member == memberBatches.end()) return;
+
+    StaticBatchNode* node = member->second.first;
+    StaticBatch& batch = node->batches[member->second.second];
+
+    //THE WHOLE BATCH GOES, SO EVERY MESH IN IT IS DRAWN ON ITS OWN
+    if (!batch.stale)
+    {
+        batch.stale = true;
+        for (Mesh* batched : batch.meshes) batched->staticBatched = false;
+    }
+
+    for (; node && !node->proxyStale; node = node->parent) node->proxyStale = true;
+}
+
+void StaticBatcher::CollectVisible(const Frustum& frustum, const glm::vec3& cameraPosition, float projectionScale, float hlodScreenSize,
+    std::vector<const StaticBatch*>& batches) const
+{
+    batches.clear();
+    if (root) CollectVisible(root, frustum, cameraPosition, projectionScale, hlodScreenSize, batches);
+}
+
+void StaticBatcher::CollectVisible(const StaticBatchNode* node, const Frustum& frustum, const glm::vec3& cameraPosition, float projectionScale,
+    float hlodScreenSize, std::vector<const StaticBatch*>& batches) const
+{
+    //A NODE OUTSIDE THE FRUSTUM HIDES ITS WHOLE SUBTREE
+    if (!frustum.InFrustum(node->bounds)) return;
+
+    //FAR ENOUGH, THE PROXY STANDS IN FOR THE WHOLE SUBTREE
+    if (!node->proxy.empty() && !node->proxyStale)
+    {
+        glm::vec3 center = (node->bounds.min + node->bounds.max) * 0.5f;
+        float radius = glm::length(node->bounds.max - node->bounds.min) * 0.5f;
+        float distance = glm::length(center - cameraPosition);
+
+        if (distance > radius && radius * projectionScale / distance < hlodScreenSize)
+        {
+            for (const StaticBatch& batch : node->proxy)
+            {
+                batches.push_back(&batch);
+            }
+            return;
+        }
+    }
+
+    for (const StaticBatch& batch : node->batches)
+    {
+        if (batch.stale || (node->batches.size() > 1 && !frustum.InFrustum(batch.bounds))) continue;
+        batches.push_back(&batch);
+    }
+
+    for (const StaticBatchNode* child : node->children)
+    {
+        CollectVisible(child, frustum, cameraPosition, projectionScale, hlodScreenSize, batches);
+    }
+}
@@ -0,0 +1,102 @@
+#pragma once
+#include "AABB.h"
+#include "../components/Mesh.h"
+#include <glm/glm.hpp>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <cstdint>
+
+class TreeNode;
+class Frustum;
+struct TextureResource;
+
+//Meshes above this size keep their own draw and meshlet culling, batching them saves nothing
+#define STATIC_BATCH_MAX_MESH_INDICES (MESHLET_MIN_MESH_TRIANGLES * 3)
+
+#define HLOD_GRID_RESOLUTION 32
+#define HLOD_LIBRARY_DIRECTORY "Library/HLOD"
+
+//World space geometry of every opaque static mesh in one octree node that shares a texture and UV state.
+struct StaticBatch
+{
+    MeshData meshData;
+    AABB bounds;
+    bool hasUVs = false;
+    int numObjects = 0;
+
+    //HELD UNTIL THE BATCH IS DELETED. nullptr DRAWS THE CHECKER
+    const TextureResource* texture = nullptr;
+
+    //EMPTY FOR PROXIES. A STALE BATCH IS SKIPPED AND ITS MESHES ARE DRAWN ONE BY ONE UNTIL THE NEXT BUILD
+    std::vector<Mesh*> meshes;
+    bool stale = false;
+
+    //Read at draw time, so textures that finish loading or are reloaded need no rebuild. The checker while there is no image.
+    unsigned int GetTextureID(unsigned int checkerTextureID) const;
+};
+
+struct StaticBatchNode
+{
+    AABB bounds;
+    std::vector<StaticBatch> batches;
+    std::vector<StaticBatchNode*> children;
+
+    //SIMPLIFIED MERGE OF EVERY BATCH IN THE SUBTREE (HLOD), EMPTY FOR SMALL NODES. NOT DRAWN ONCE A BATCH BELOW IS STALE
+    std::vector<StaticBatch> proxy;
+    bool proxyStale = false;
+
+    StaticBatchNode* parent = nullptr;
+
+    ~StaticBatchNode();
+};
+
+//Mirrors the static octree with merged buffers. Rebuilt with the tree, culled per node like it.
+//Nodes at least hlodMinNodeSize wide also get a proxy, cooked into the Library keyed by a hash of their contents.
+class StaticBatcher
+{
+public:
+    ~StaticBatcher();
+
+    void Build(TreeNode* root, float hlodMinNodeSize);
+    void Clear();
+
+    //The mesh moved: its batch and the proxies above it stop drawing and their meshes are drawn on their own.
+    //Cheap enough for every frame of an edit, the batches are built again once it ends.
+    void Invalidate(Mesh* mesh);
+
+    //Nodes whose projected height (fraction of the screen) is below hlodScreenSize draw their proxy instead of descending.
+    //projectionScale is projection[1][1]. Pass hlodScreenSize 0 to always draw the full batches.
+    void CollectVisible(const Frustum& frustum, const glm::vec3& cameraPosition, float projectionScale, float hlodScreenSize,
+        std::vector<const StaticBatch*>& batches) const;
+
+    int GetBatchCount() const { return numBatches; }
+    int GetObjectCount() const { return (int)members.size(); }
+    int GetProxyCount() const { return numProxies; }
+
+private:
+    typedef std::map<std::pair<const TextureResource*, bool>, std::vector<GameObject*>> BatchGroups;
+
+    //Adds every object batched in the subtree to parentGroups, after the node's own proxy is built
+    StaticBatchNode* BuildNode(TreeNode* node, float hlodMinNodeSize, BatchGroups& parentGroups);
+    void BuildBatch(const std::vector<GameObject*>& objects, StaticBatch& batch);
+    void BuildProxy(const BatchGroups& groups, std::vector<StaticBatch>& proxy);
+
+    void CollectVisible(const StaticBatchNode* node, const Frustum& frustum, const glm::vec3& cameraPosition, float projectionScale,
+        float hlodScreenSize, std::vector<const StaticBatch*>& batches) const;
+
+private:
+    StaticBatchNode* root = nullptr;
+    std::vector<Mesh*> members;
+    int numBatches = 0;
+
+    //NODE AND BATCH INDEX OF EVERY MEMBER
+    std::unordered_map<Mesh*, std::pair<StaticBatchNode*, size_t>> memberBatches;
+    int numProxies = 0;
+    int numCookedProxies = 0;
+
+    //CONTENT KEYS OF THE PROXIES IN THE LIBRARY, THE ONES NOT REBUILT ARE STALE AND DELETED
+    std::unordered_set<uint64_t> proxyKeys;
+};
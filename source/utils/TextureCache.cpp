@@ -0,0 +1,309 @@
+#include "TextureCache.h"
+#include "Hash.h"
+#include "FilePath.h"
+#include "MappedFile.h"
+#include "TextureStreamer.h"
+#include "JobSystem.h"
+#include "Log.h"
+#include "../Engine.h"
+#include "../Render.h"
+
+#include "SDL3/SDL_filesystem.h"
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <cstring>
+
+const TextureResource* TextureCache::Acquire(const std::string& path, TextureUsage usage)
+{
+    //MISSING FILES FAIL RIGHT AWAY SO CALLERS CAN TRY ANOTHER PATH
+    if (!SDL_GetPathInfo(path.c_str(), nullptr)) return nullptr;
+
+    //THE SAME FILE CAN BE SAMPLED AS COLOUR AND AS COLOUR WITH ALPHA
+    std::string key = CanonicalPath(path) + "|" + std::to_string((int)usage);
+
+    //SAME PATH, NO DISK ACCESS. IT MAY STILL BE DECODING
+    auto known = resources.find(key);
+    if (known != resources.end())
+    {
+        known->second.references++;
+        return &known->second;
+    }
+
+    TextureResource& resource = resources[key];
+    resource.key = key;
+    resource.serial = nextSerial++;
+    resource.references = 1;
+    resource.format = ChooseFormat(usage);
+    resource.loading = true;
+
+    numDecoding++;
+    QueueDecode(resource, path);
+
+    return &resource;
+}
+
+int TextureCache::Reload(const std::string& path)
+{
+    std::string prefix = CanonicalPath(path) + "|";
+    int reloaded = 0;
+
+    for (auto& pair : resources)
+    {
+        if (pair.first.compare(0, prefix.size(), prefix) != 0) continue;
+
+        //A NEW SERIAL DROPS ANY DECODE STILL IN FLIGHT. THE OLD IMAGE IS DRAWN UNTIL THE NEW ONE IS UPLOADED
+        TextureResource& resource = pair.second;
+        if (!resource.loading) numDecoding++;
+        resource.loading = true;
+        resource.serial = nextSerial++;
+
+        QueueDecode(resource, path);
+        reloaded++;
+    }
+
+    return reloaded;
+}
+
+void TextureCache::QueueDecode(const TextureResource& resource, const std::string& path)
+{
+    numInFlight++;
+
+    DecodedTexture job;
+    job.key = resource.key;
+    job.path = path;
+    job.serial = resource.serial;
+    job.cooked.format = resource.format;
+    BlockQuality jobQuality = quality;
+
+    JobSystem::GetInstance().Submit([this, job, jobQuality]() mutable {
+        job.failed = !CookTexture(job.path, job.cooked.format, jobQuality, job.cooked);
+
+        {
+            std::lock_guard<std::mutex> lock(completedMutex);
+            completed.push_back(std::move(job));
+        }
+
+        numInFlight--;
+    });
+}
+
+const TextureResource* TextureCache::AddReference(const TextureResource* resource)
+{
+    if (!resource) return nullptr;
+
+    auto it = resources.find(resource->key);
+    if (it == resources.end() || &it->second != resource) return nullptr;
+
+    it->second.references++;
+    return &it->second;
+}
+
+void TextureCache::Release(const TextureResource* resource)
+{
+    if (!resource) return;
+
+    auto it = resources.find(resource->key);
+    if (it == resources.end() || &it->second != resource || --it->second.references > 0) return;
+
+    //A DECODE STILL IN FLIGHT IS DROPPED WHEN IT COMPLETES, ITS SERIAL NO LONGER MATCHES
+    if (it->second.loading) numDecoding--;
+
+    //A RELOADING RESOURCE STILL HOLDS ITS OLD IMAGE
+    if (it->second.textureID != 0) ReleaseTexture(it->second.textureKey);
+
+    resources.erase(it);
+}
+
+void TextureCache::ReleaseTexture(uint64_t textureKey)
+{
+    auto texture = textures.find(textureKey);
+    if (texture == textures.end() || --texture->second.users > 0) return;
+
+    videoBytes -= texture->second.videoBytes;
+    TextureStreamer::GetInstance().Unregister(texture->second.textureID);
+    Engine::GetInstance().render->DeleteTextureFromGPU(texture->second.textureID);
+    textures.erase(texture);
+}
+
+void TextureCache::Update()
+{
+    {
+        std::lock_guard<std::mutex> lock(completedMutex);
+        for (DecodedTexture& decoded : completed) pendingUploads.push_back(std::move(decoded));
+        completed.clear();
+    }
+
+    Render* render = Engine::GetInstance().render;
+    size_t frameBytes = 0;
+
+    for (size_t i = 0; i < pendingUploads.size();)
+    {
+        DecodedTexture& decoded = pendingUploads[i];
+
+        //ITS COPY INTO THE UPLOAD RING IS STILL RUNNING
+        if (decoded.staged && !decoded.staged->load(std::memory_order_acquire))
+        {
+            i++;
+            continue;
+        }
+
+        auto resource = resources.find(decoded.key);
+        bool stale = resource == resources.end() || resource->second.serial != decoded.serial;
+
+        if (!stale && !decoded.failed && !decoded.staged && textures.find(GetTextureKey(decoded)) == textures.end())
+        {
+            //WHAT DOESN'T FIT THIS FRAME WAITS FOR THE NEXT ONE, BUT AT LEAST ONE TEXTURE GOES UP
+            if (frameBytes > 0 && frameBytes >= uploadBudgetBytes)
+            {
+                i++;
+                continue;
+            }
+
+            size_t bytes = 0;
+            for (int level = GetUploadBaseLevel(decoded); level < (int)decoded.cooked.texture.levels.size(); level++) bytes += decoded.cooked.texture.levels[level].size;
+            frameBytes += bytes;
+
+            //STAGED TEXTURES ARE UPLOADED ON A LATER FRAME, ONCE A WORKER HAS COPIED THEM INTO THE RING
+            if (Stage(decoded))
+            {
+                i++;
+                continue;
+            }
+        }
+
+        if (!stale)
+        {
+            numDecoding--;
+            resource->second.loading = false;
+
+            if (decoded.failed)
+            {
+                LOG("Error loading texture: %s", decoded.path.c_str());
+            }
+            else
+            {
+                Upload(decoded, resource->second);
+            }
+        }
+
+        //NOTHING HAPPENS IF THE UPLOAD ALREADY FENCED IT
+        if (decoded.staging) render->ReleaseUploadStaging(decoded.staging);
+
+        pendingUploads.erase(pendingUploads.begin() + i);
+    }
+}
+
+bool TextureCache::Stage(DecodedTexture& decoded)
+{
+    int baseLevel = GetUploadBaseLevel(decoded);
+    std::vector<TextureLevel>& levels = decoded.cooked.texture.levels;
+
+    size_t bytes = 0;
+    for (int level = baseLevel; level < (int)levels.size(); level++) bytes += (levels[level].size + W16TEX_ALIGNMENT - 1) & ~(size_t)(W16TEX_ALIGNMENT - 1);
+
+    uint8_t* staging = Engine::GetInstance().render->AllocateUploadStaging(bytes);
+    if (!staging) return false;
+
+    //THE LEVELS POINT INTO THE RING FROM NOW ON, THE SOURCES STAY ALIVE WITH decoded UNTIL THE COPY IS DONE
+    std::vector<std::pair<const void*, TextureLevel>> copies;
+    size_t offset = 0;
+
+    for (int level = baseLevel; level < (int)levels.size(); level++)
+    {
+        const void* source = levels[level].data;
+        levels[level].data = staging + offset;
+        copies.emplace_back(source, levels[level]);
+        offset += (levels[level].size + W16TEX_ALIGNMENT - 1) & ~(size_t)(W16TEX_ALIGNMENT - 1);
+    }
+
+    decoded.staging = staging;
+    decoded.staged = std::make_shared<std::atomic<bool>>(false);
+
+    std::shared_ptr<std::atomic<bool>> staged = decoded.staged;
+    numInFlight++;
+
+    JobSystem::GetInstance().Submit([this, copies, staged]() {
+        for (const std::pair<const void*, TextureLevel>& copy : copies)
+        {
+            memcpy(const_cast<void*>(copy.second.data), copy.first, copy.second.size);
+        }
+
+        staged->store(true, std::memory_order_release);
+        numInFlight--;
+    });
+
+    return true;
+}
+
+int TextureCache::GetUploadBaseLevel(const DecodedTexture& decoded)
+{
+    //WITH STREAMING ON ONLY THE TAIL LEVELS GO UP NOW, THE REST IS READ BACK FROM THE COOKED FILE ON DEMAND
+    return TextureStreamer::GetInstance().enabled && !decoded.cooked.cookedPath.empty() ? TextureStreamer::GetTailLevel(decoded.cooked.texture) : 0;
+}
+
+uint64_t TextureCache::GetTextureKey(const DecodedTexture& decoded)
+{
+    return HashFNV1a(&decoded.cooked.format, sizeof(decoded.cooked.format), decoded.cooked.contentHash);
+}
+
+void TextureCache::CleanUp()
+{
+    while (numInFlight > 0) std::this_thread::yield();
+
+    completed.clear();
+    pendingUploads.clear();
+}
+
+TextureFormat TextureCache::ChooseFormat(TextureUsage usage) const
+{
+    TextureFormat format = GetCookFormat(usage, compress, quality);
+
+    //DRIVERS WITHOUT THE FORMAT GET THE UNCOMPRESSED LEVELS
+    return Engine::GetInstance().render->SupportsTextureFormat(format) ? format : TextureFormat::RGBA8;
+}
+
+void TextureCache::Upload(DecodedTexture& decoded, TextureResource& resource)
+{
+    uint64_t textureKey = GetTextureKey(decoded);
+
+    //SAME IMAGE AND FORMAT UNDER ANOTHER PATH, NO UPLOAD
+    auto texture = textures.find(textureKey);
+    if (texture != textures.end())
+    {
+        LOG("Texture %s shares GPU texture %u", decoded.path.c_str(), texture->second.textureID);
+    }
+    else
+    {
+        int baseLevel = GetUploadBaseLevel(decoded);
+
+        SharedTexture shared;
+        shared.width = (int)decoded.cooked.texture.width;
+        shared.height = (int)decoded.cooked.texture.height;
+
+        //STREAMED LEVELS ARE COUNTED BY THE STREAMER
+        for (int level = baseLevel; level < (int)decoded.cooked.texture.levels.size(); level++)
+        {
+            shared.videoBytes += decoded.cooked.texture.levels[level].size;
+        }
+
+        shared.textureID = Engine::GetInstance().render->UploadTextureToGPU(decoded.cooked.texture, baseLevel);
+        if (shared.textureID == 0) return;
+
+        if (baseLevel > 0) TextureStreamer::GetInstance().Register(shared.textureID, decoded.cooked.cookedPath, decoded.cooked.texture, baseLevel);
+
+        videoBytes += shared.videoBytes;
+        texture = textures.emplace(textureKey, shared).first;
+    }
+
+    texture->second.users++;
+
+    //A RELOAD LETS GO OF THE OLD IMAGE ONLY NOW, THE NEW ONE IS ALREADY COUNTED IF IT IS THE SAME
+    if (resource.textureID != 0) ReleaseTexture(resource.textureKey);
+
+    resource.textureID = texture->second.textureID;
+    resource.width = texture->second.width;
+    resource.height = texture->second.height;
+    resource.contentHash = decoded.cooked.contentHash;
+    resource.textureKey = textureKey;
+}
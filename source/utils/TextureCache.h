@@ -0,0 +1,121 @@
+#pragma once
+#include "TextureCook.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+//One per path and usage, held by the components. textureID stays 0 (the checker is drawn) until the decode finishes.
+struct TextureResource
+{
+    unsigned int textureID = 0;
+    int width = 0;
+    int height = 0;
+    int references = 0;
+    uint64_t contentHash = 0;
+    TextureFormat format = TextureFormat::RGBA8;
+    bool loading = false;
+
+    //CACHE BOOKKEEPING
+    std::string key;
+    uint64_t serial = 0;
+    uint64_t textureKey = 0;
+};
+
+#define TEXTURE_UPLOAD_DEFAULT_BUDGET (32ull * 1024 * 1024)
+
+//Shares one GL texture between every component that uses the same image. Resources are looked up by canonical path,
+//GL textures by a hash of the file contents and format, so copies of an image under different paths are uploaded once.
+//New contents are cooked once into Library/Textures/<hash>_<format>.W16Tex with their mip chain, block compressed
+//when compress is set: BC1 for colour, BC3 (BC7 on High quality) for colour with alpha and BC5 for normal maps.
+//Reading, decoding and cooking run on the job system. DevIL keeps a global bound image, so its calls are serialised.
+class TextureCache
+{
+public:
+    static TextureCache& GetInstance() {
+        static TextureCache instance;
+        return instance;
+    }
+
+    //Adds a reference, queueing the decode the first time. nullptr if the file doesn't exist.
+    const TextureResource* Acquire(const std::string& path, TextureUsage usage = TextureUsage::Color);
+
+    //One more reference to a resource the caller already holds, without touching the disk.
+    const TextureResource* AddReference(const TextureResource* resource);
+
+    //Frees the GL texture when the last resource using it goes away.
+    void Release(const TextureResource* resource);
+
+    //Decodes the file again for every resource of the path, every component using them gets the new image once it is
+    //uploaded. How many resources are reloading, 0 if nothing uses the path.
+    int Reload(const std::string& path);
+
+    //Moves finished decodes into the upload ring (or uploads them directly), about uploadBudgetBytes per frame. GL thread only.
+    void Update();
+
+    //Waits for the decodes in flight
+    void CleanUp();
+
+    size_t GetNumTextures() const { return textures.size(); }
+    size_t GetVideoBytes() const { return videoBytes; }
+    int GetNumDecoding() const { return numDecoding; }
+
+public:
+    //Only affect textures cooked after the change, the format is part of the cooked file name
+    bool compress = true;
+    BlockQuality quality = BlockQuality::Fast;
+    size_t uploadBudgetBytes = TEXTURE_UPLOAD_DEFAULT_BUDGET;
+
+private:
+    struct SharedTexture
+    {
+        unsigned int textureID = 0;
+        int width = 0;
+        int height = 0;
+        size_t videoBytes = 0;
+        int users = 0;
+    };
+
+    //Output of a decode job. Owns the level memory, or the mapping of the cooked file, until it is uploaded.
+    struct DecodedTexture
+    {
+        std::string key;
+        std::string path;
+        uint64_t serial = 0;
+        CookedTexture cooked;
+        bool failed = false;
+
+        //SET WHEN THE UPLOADED LEVELS ARE COPIED INTO THE RENDER'S UPLOAD RING
+        uint8_t* staging = nullptr;
+        std::shared_ptr<std::atomic<bool>> staged;
+    };
+
+    TextureFormat ChooseFormat(TextureUsage usage) const;
+
+    void QueueDecode(const TextureResource& resource, const std::string& path);
+    void ReleaseTexture(uint64_t textureKey);
+
+    //False when the ring has no room, the levels are then uploaded from client memory
+    bool Stage(DecodedTexture& decoded);
+    void Upload(DecodedTexture& decoded, TextureResource& resource);
+
+    static int GetUploadBaseLevel(const DecodedTexture& decoded);
+    static uint64_t GetTextureKey(const DecodedTexture& decoded);
+
+private:
+    std::unordered_map<std::string, TextureResource> resources;
+    std::unordered_map<uint64_t, SharedTexture> textures;
+
+    std::vector<DecodedTexture> completed;
+    std::mutex completedMutex;
+    std::atomic<int> numInFlight{ 0 };
+
+    std::vector<DecodedTexture> pendingUploads;
+    int numDecoding = 0;
+    size_t videoBytes = 0;
+    uint64_t nextSerial = 1;
+};
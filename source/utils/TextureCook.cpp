@@ -0,0 +1,189 @@
+#include "TextureCook.h"
+#include "BlockCompression.h"
+#include "MappedFile.h"
+#include "Hash.h"
+#include "Log.h"
+
+#include <IL/il.h>
+#include "SDL3/SDL_filesystem.h"
+#include <fstream>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_set>
+#include <algorithm>
+#include <cstdio>
+
+static std::string HashToHex(uint64_t hash)
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx", (unsigned long long)hash);
+    return name;
+}
+
+static const char* GetFormatName(TextureFormat format)
+{
+    switch (format)
+    {
+    case TextureFormat::BC1: return "bc1";
+    case TextureFormat::BC3: return "bc3";
+    case TextureFormat::BC5: return "bc5";
+    case TextureFormat::BC7: return "bc7";
+    default: return "rgba8";
+    }
+}
+
+//DEVIL DECODES INTO ITS GLOBALLY BOUND IMAGE
+static std::mutex devilMutex;
+
+//COOKED PATHS BEING WRITTEN. THE SAME CONTENTS UNDER TWO PATHS ARE COOKED ONCE, THE SECOND JOB MAPS THE RESULT
+static std::mutex cookingMutex;
+static std::condition_variable cookingDone;
+static std::unordered_set<std::string> cooking;
+
+TextureFormat GetCookFormat(TextureUsage usage, bool compress, BlockQuality quality)
+{
+    if (!compress) return TextureFormat::RGBA8;
+
+    if (usage == TextureUsage::ColorAlpha) return quality == BlockQuality::High ? TextureFormat::BC7 : TextureFormat::BC3;
+    if (usage == TextureUsage::Normal) return TextureFormat::BC5;
+    return TextureFormat::BC1;
+}
+
+static bool LoadCooked(CookedTexture& cooked)
+{
+    if (!SDL_GetPathInfo(cooked.cookedPath.c_str(), nullptr)) return false;
+
+    std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
+    if (!file->Open(cooked.cookedPath) || !ReadTextureFile(*file, cooked.texture)) return false;
+
+    //A FILE NAMED AFTER A HASH IT WASN'T COOKED FROM IS RE-COOKED
+    if (cooked.texture.sourceHash != cooked.contentHash || cooked.texture.format != cooked.format) return false;
+
+    //THE LEVELS ARE UPLOADED STRAIGHT FROM THE MAPPING
+    cooked.file = file;
+    return true;
+}
+
+static bool Cook(const std::string& path, CookedTexture& cooked, const std::vector<char>& contents, BlockQuality quality)
+{
+    std::vector<uint8_t> rgba;
+    uint32_t width = 0;
+    uint32_t height = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(devilMutex);
+
+        unsigned int imageID = 0;
+        ilGenImages(1, &imageID);
+        ilBindImage(imageID);
+
+        bool loaded = ilLoadL(ilTypeFromExt(path.c_str()), contents.data(), (unsigned int)contents.size()) != 0;
+        if (loaded && !ilConvertImage(IL_RGBA, IL_UNSIGNED_BYTE))
+        {
+            LOG("Error converting image to RGBA: %s", path.c_str());
+            loaded = false;
+        }
+
+        if (loaded)
+        {
+            width = (uint32_t)ilGetInteger(IL_IMAGE_WIDTH);
+            height = (uint32_t)ilGetInteger(IL_IMAGE_HEIGHT);
+            const uint8_t* data = ilGetData();
+            rgba.assign(data, data + (size_t)width * height * 4);
+        }
+
+        ilBindImage(0);
+        ilDeleteImages(1, &imageID);
+
+        if (!loaded) return false;
+    }
+
+    LOG("Texture loaded into CPU from: %s (Width: %u, Height: %u)", path.c_str(), width, height);
+
+    //MIPS AND BLOCK COMPRESSION RUN OUTSIDE THE LOCK
+    BuildMipChain(rgba.data(), width, height, cooked.levels);
+
+    //A STALE COOKED FILE MAY HAVE BEEN READ INTO IT
+    TextureFileData& texture = cooked.texture;
+    texture = TextureFileData();
+    texture.format = cooked.format;
+    texture.width = width;
+    texture.height = height;
+    texture.sourceHash = cooked.contentHash;
+
+    for (std::vector<uint8_t>& mip : cooked.levels)
+    {
+        if (IsBlockCompressed(cooked.format))
+        {
+            std::vector<uint8_t> blocks(GetTextureLevelSize(cooked.format, width, height));
+            CompressBlocks(cooked.format, mip.data(), width, height, quality, blocks.data());
+            mip.swap(blocks);
+        }
+
+        TextureLevel level;
+        level.data = mip.data();
+        level.size = mip.size();
+        level.width = width;
+        level.height = height;
+        texture.levels.push_back(level);
+
+        width = std::max(width / 2, 1u);
+        height = std::max(height / 2, 1u);
+    }
+
+    SDL_CreateDirectory(TEXTURE_LIBRARY_DIRECTORY);
+    if (WriteTextureFile(cooked.cookedPath, texture))
+    {
+        LOG("Texture cooked into Library: %s", cooked.cookedPath.c_str());
+    }
+    else
+    {
+        //WITHOUT A COOKED FILE THERE IS NOTHING TO STREAM FROM
+        cooked.cookedPath.clear();
+    }
+
+    return true;
+}
+
+bool CookTexture(const std::string& path, TextureFormat format, BlockQuality quality, CookedTexture& cooked)
+{
+    std::ifstream file(path, std::ios::in | std::ios::binary | std::ios::ate);
+    std::vector<char> contents;
+    cooked.format = format;
+
+    if (file.is_open())
+    {
+        contents.resize((size_t)file.tellg());
+        file.seekg(0);
+    }
+
+    if (contents.empty() || !file.read(contents.data(), contents.size())) return false;
+
+    cooked.contentHash = HashFNV1a(contents.data(), contents.size());
+
+    std::string cookedName = HashToHex(cooked.contentHash) + "_" + GetFormatName(cooked.format);
+    if (IsBlockCompressed(cooked.format) && quality == BlockQuality::High) cookedName += "_hq";
+    cooked.cookedPath = std::string(TEXTURE_LIBRARY_DIRECTORY) + "/" + cookedName + ".W16Tex";
+    std::string cookedPath = cooked.cookedPath;
+
+    while (true)
+    {
+        if (LoadCooked(cooked)) return true;
+
+        std::unique_lock<std::mutex> lock(cookingMutex);
+        if (cooking.insert(cookedPath).second) break;
+
+        //IF THAT COOK FAILS THIS JOB TRIES ITSELF
+        cookingDone.wait(lock, [&cookedPath]() { return cooking.count(cookedPath) == 0; });
+    }
+
+    bool cookedNow = Cook(path, cooked, contents, quality);
+
+    {
+        std::lock_guard<std::mutex> lock(cookingMutex);
+        cooking.erase(cookedPath);
+    }
+    cookingDone.notify_all();
+
+    return cookedNow;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include "BlockCompression.h"
+#include "TextureFile.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+class MappedFile;
+
+#define TEXTURE_LIBRARY_DIRECTORY "Library/Textures"
+
+//What the texture is sampled as, picks the block format it is cooked into
+enum class TextureUsage
+{
+    Color,
+    ColorAlpha,
+    Normal
+};
+
+//A source image in its cooked form. Owns the level memory of a fresh cook, or the mapping of the cooked file.
+struct CookedTexture
+{
+    uint64_t contentHash = 0;
+    TextureFormat format = TextureFormat::RGBA8;
+    TextureFileData texture;
+    std::vector<std::vector<uint8_t>> levels;
+    std::shared_ptr<MappedFile> file;
+
+    //EMPTY IF THE LIBRARY FILE COULDN'T BE WRITTEN
+    std::string cookedPath;
+};
+
+//BC1 for colour, BC3 (BC7 on High quality) for colour with alpha and BC5 for normal maps. RGBA8 without compress.
+TextureFormat GetCookFormat(TextureUsage usage, bool compress, BlockQuality quality);
+
+//Maps Library/Textures/<hash>_<format>.W16Tex if it was cooked from the current contents of path. Otherwise decodes
+//path with DevIL, builds the mip chain, block compresses it and writes that file. No GL, safe on any thread, calls
+//that end in the same cooked file cook it once.
+bool CookTexture(const std::string& path, TextureFormat format, BlockQuality quality, CookedTexture& cooked);
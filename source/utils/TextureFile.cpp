@@ -0,0 +1,227 @@
+#include "TextureFile.h"
+#include "BlockCompression.h"
+#include "MappedFile.h"
+#include "JobSystem.h"
+#include "Hash.h"
+#include "FilePath.h"
+#include "Log.h"
+
+#include "SDL3/SDL_filesystem.h"
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+
+#define MIP_BATCH_ROWS 16
+
+static uint64_t AlignOffset(uint64_t offset)
+{
+    return (offset + W16TEX_ALIGNMENT - 1) & ~(uint64_t)(W16TEX_ALIGNMENT - 1);
+}
+
+static uint64_t HashTextureFile(const TextureFileHeader& header, const TextureFileLevel* levels, const void* const* data)
+{
+    TextureFileHeader hashedHeader = header;
+    hashedHeader.contentHash = 0;
+
+    uint64_t hash = HashFNV1a(&hashedHeader, sizeof(TextureFileHeader));
+    hash = HashFNV1a(levels, sizeof(TextureFileLevel) * header.numLevels, hash);
+
+    for (uint32_t i = 0; i < header.numLevels; i++)
+    {
+        hash = HashFNV1a(data[i], (size_t)levels[i].size, hash);
+    }
+
+    return hash;
+}
+
+size_t GetTextureLevelSize(TextureFormat format, uint32_t width, uint32_t height)
+{
+    if (IsBlockCompressed(format)) return (size_t)((width + 3) / 4) * ((height + 3) / 4) * GetBlockBytes(format);
+
+    return (size_t)width * height * 4;
+}
+
+void BuildMipChain(const uint8_t* rgba, uint32_t width, uint32_t height, std::vector<std::vector<uint8_t>>& levels)
+{
+    levels.clear();
+    levels.emplace_back(rgba, rgba + (size_t)width * height * 4);
+
+    while ((width > 1 || height > 1) && levels.size() < W16TEX_MAX_LEVELS)
+    {
+        uint32_t nextWidth = std::max(width / 2, 1u);
+        uint32_t nextHeight = std::max(height / 2, 1u);
+
+        levels.emplace_back((size_t)nextWidth * nextHeight * 4);
+        const uint8_t* source = levels[levels.size() - 2].data();
+        uint8_t* target = levels.back().data();
+
+        //2X2 BOX, ODD EDGES REPEAT THE LAST TEXEL
+        JobSystem::GetInstance().ParallelFor(nextHeight, MIP_BATCH_ROWS, [&](size_t begin, size_t end) {
+            for (size_t y = begin; y < end; y++)
+            {
+                uint32_t y0 = std::min((uint32_t)y * 2, height - 1);
+                uint32_t y1 = std::min((uint32_t)y * 2 + 1, height - 1);
+
+                for (uint32_t x = 0; x < nextWidth; x++)
+                {
+                    uint32_t x0 = std::min(x * 2, width - 1);
+                    uint32_t x1 = std::min(x * 2 + 1, width - 1);
+
+                    const uint8_t* a = source + ((size_t)y0 * width + x0) * 4;
+                    const uint8_t* b = source + ((size_t)y0 * width + x1) * 4;
+                    const uint8_t* c = source + ((size_t)y1 * width + x0) * 4;
+                    const uint8_t* d = source + ((size_t)y1 * width + x1) * 4;
+                    uint8_t* out = target + ((size_t)y * nextWidth + x) * 4;
+
+                    for (int channel = 0; channel < 4; channel++)
+                    {
+                        out[channel] = (uint8_t)((a[channel] + b[channel] + c[channel] + d[channel] + 2) / 4);
+                    }
+                }
+            }
+        });
+
+        width = nextWidth;
+        height = nextHeight;
+    }
+}
+
+bool WriteTextureFile(const std::string& path, const TextureFileData& texture)
+{
+    uint32_t numLevels = (uint32_t)texture.levels.size();
+    if (numLevels == 0 || numLevels > W16TEX_MAX_LEVELS) return false;
+
+    TextureFileHeader header = {};
+    header.magic = W16TEX_MAGIC;
+    header.version = W16TEX_VERSION;
+    header.format = (uint32_t)texture.format;
+    header.width = texture.width;
+    header.height = texture.height;
+    header.numLevels = numLevels;
+    header.sourceHash = texture.sourceHash;
+
+    //LEVEL TABLE
+    TextureFileLevel levels[W16TEX_MAX_LEVELS] = {};
+    const void* data[W16TEX_MAX_LEVELS] = {};
+
+    uint64_t offset = sizeof(TextureFileHeader) + sizeof(TextureFileLevel) * numLevels;
+    for (uint32_t i = 0; i < numLevels; i++)
+    {
+        levels[i].width = texture.levels[i].width;
+        levels[i].height = texture.levels[i].height;
+        levels[i].size = texture.levels[i].size;
+        levels[i].offset = AlignOffset(offset);
+        offset = levels[i].offset + levels[i].size;
+        data[i] = texture.levels[i].data;
+    }
+
+    header.contentHash = HashTextureFile(header, levels, data);
+
+    //WRITTEN ASIDE AND MOVED INTO PLACE, SO A READER NEVER MAPS A HALF WRITTEN FILE
+    std::string temporaryPath = GetTemporaryPath(path);
+    std::ofstream file(temporaryPath, std::ios::out | std::ios::binary);
+    if (!file.is_open())
+    {
+        LOG("Error: Could not open the .W16Tex file for writing: %s", path.c_str());
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(levels), sizeof(TextureFileLevel) * numLevels);
+
+    const char padding[W16TEX_ALIGNMENT] = {};
+    uint64_t written = sizeof(header) + sizeof(TextureFileLevel) * numLevels;
+
+    for (uint32_t i = 0; i < numLevels; i++)
+    {
+        file.write(padding, (std::streamsize)(levels[i].offset - written));
+        file.write(reinterpret_cast<const char*>(data[i]), (std::streamsize)levels[i].size);
+        written = levels[i].offset + levels[i].size;
+    }
+
+    file.close();
+    if (!file.good())
+    {
+        LOG("Error: Failed writing the .W16Tex file: %s", path.c_str());
+        SDL_RemovePath(temporaryPath.c_str());
+        return false;
+    }
+
+    if (!ReplaceWithFile(temporaryPath, path))
+    {
+        LOG("Error: Could not move the .W16Tex file into place: %s", path.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool ReadTextureFile(const MappedFile& file, TextureFileData& texture, bool verifyHash)
+{
+    const uint8_t* data = file.GetData();
+    size_t size = file.GetSize();
+
+    TextureFileHeader header;
+    if (size < sizeof(header)) return false;
+    memcpy(&header, data, sizeof(header));
+
+    if (header.magic != W16TEX_MAGIC)
+    {
+        LOG("Error: Not a W16Tex file");
+        return false;
+    }
+
+    if (header.version != W16TEX_VERSION)
+    {
+        LOG("Error: Unsupported W16Tex version %u", header.version);
+        return false;
+    }
+
+    if (header.format > (uint32_t)TextureFormat::BC7 || header.width == 0 || header.height == 0)
+    {
+        LOG("Error: Unknown W16Tex format");
+        return false;
+    }
+
+    if (header.numLevels == 0 || header.numLevels > W16TEX_MAX_LEVELS || sizeof(TextureFileHeader) + (uint64_t)header.numLevels * sizeof(TextureFileLevel) > size)
+    {
+        LOG("Error: W16Tex level table out of bounds");
+        return false;
+    }
+
+    const TextureFileLevel* levels = reinterpret_cast<const TextureFileLevel*>(data + sizeof(TextureFileHeader));
+    const void* levelData[W16TEX_MAX_LEVELS] = {};
+
+    texture = TextureFileData();
+    texture.format = (TextureFormat)header.format;
+    texture.width = header.width;
+    texture.height = header.height;
+    texture.sourceHash = header.sourceHash;
+    texture.levels.resize(header.numLevels);
+
+    for (uint32_t i = 0; i < header.numLevels; i++)
+    {
+        const TextureFileLevel& level = levels[i];
+
+        if (level.offset % W16TEX_ALIGNMENT != 0 || level.offset > size || level.size > size - level.offset ||
+            level.size != GetTextureLevelSize(texture.format, level.width, level.height))
+        {
+            LOG("Error: W16Tex level %u out of bounds", i);
+            return false;
+        }
+
+        levelData[i] = data + level.offset;
+        texture.levels[i].data = levelData[i];
+        texture.levels[i].size = (size_t)level.size;
+        texture.levels[i].width = level.width;
+        texture.levels[i].height = level.height;
+    }
+
+    if (verifyHash && HashTextureFile(header, levels, levelData) != header.contentHash)
+    {
+        LOG("Error: W16Tex hash mismatch, the file is corrupted");
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+class MappedFile;
+
+//W16Tex layout: TextureFileHeader, numLevels TextureFileLevel entries and then every mip level, largest first, each one
+//starting at a 64 byte boundary so it can be uploaded straight from the mapping. The hash covers the header (with the
+//hash zeroed), the level table and every level. sourceHash is the hash of the image file the texture was cooked from.
+#define W16TEX_MAGIC 0x54363157u //"W16T"
+#define W16TEX_VERSION 1
+#define W16TEX_ALIGNMENT 64
+#define W16TEX_MAX_LEVELS 16
+
+enum class TextureFormat : uint32_t
+{
+    RGBA8 = 0,
+    BC1 = 1,
+    BC3 = 2,
+    BC5 = 3,
+    BC7 = 4
+};
+
+struct TextureFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t format;
+    uint32_t width;
+    uint32_t height;
+    uint32_t numLevels;
+    uint32_t flags;
+    uint32_t reserved;
+    uint64_t sourceHash;
+    uint64_t contentHash;
+    uint32_t padding[4];
+};
+
+struct TextureFileLevel
+{
+    uint64_t offset;
+    uint64_t size;
+    uint32_t width;
+    uint32_t height;
+    uint64_t reserved;
+};
+
+static_assert(sizeof(TextureFileHeader) == 64, "W16Tex header must stay 64 bytes");
+static_assert(sizeof(TextureFileLevel) == 32, "W16Tex level entry must stay 32 bytes");
+
+struct TextureLevel
+{
+    const void* data = nullptr;
+    size_t size = 0;
+    uint32_t width = 0;
+    uint32_t height = 0;
+};
+
+//Mip chain as stored in a texture file. When read from a mapping the pointers point inside it.
+struct TextureFileData
+{
+    TextureFormat format = TextureFormat::RGBA8;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint64_t sourceHash = 0;
+    std::vector<TextureLevel> levels;
+};
+
+size_t GetTextureLevelSize(TextureFormat format, uint32_t width, uint32_t height);
+
+//Box filtered chain down to 1x1. levels[0] is a copy of the source image.
+void BuildMipChain(const uint8_t* rgba, uint32_t width, uint32_t height, std::vector<std::vector<uint8_t>>& levels);
+
+bool WriteTextureFile(const std::string& path, const TextureFileData& texture);
+
+//Validates the header, the level table bounds and the hash. Streaming reads of a file already checked skip the hash.
+bool ReadTextureFile(const MappedFile& file, TextureFileData& texture, bool verifyHash = true);
@@ -0,0 +1,276 @@
+#include "TextureStreamer.h"
+#include "MappedFile.h"
+#include "JobSystem.h"
+#include "Log.h"
+#include "../Engine.h"
+#include "../Render.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <cstring>
+
+int TextureStreamer::GetTailLevel(const TextureFileData& texture)
+{
+    for (int level = 0; level < (int)texture.levels.size(); level++)
+    {
+        if (std::max(texture.levels[level].width, texture.levels[level].height) <= TEXTURE_STREAMING_TAIL_SIZE) return level;
+    }
+
+    return (int)texture.levels.size() - 1;
+}
+
+size_t TextureStreamer::GetLevelBytes(const StreamedTexture& texture, int first, int last)
+{
+    size_t bytes = 0;
+    for (int level = first; level < last; level++) bytes += texture.levelBytes[level];
+    return bytes;
+}
+
+void TextureStreamer::Register(unsigned int textureID, const std::string& cookedPath, const TextureFileData& texture, int residentLevel)
+{
+    Unregister(textureID);
+
+    StreamedTexture& streamed = textures[textureID];
+    streamed.cookedPath = cookedPath;
+    streamed.format = texture.format;
+    streamed.size = std::max(texture.width, texture.height);
+    streamed.tailLevel = residentLevel;
+    streamed.residentLevel = residentLevel;
+    streamed.requestedLevel = residentLevel;
+    streamed.wantedLevel = residentLevel;
+    streamed.serial = nextSerial++;
+
+    for (const TextureLevel& level : texture.levels) streamed.levelBytes.push_back(level.size);
+}
+
+void TextureStreamer::Unregister(unsigned int textureID)
+{
+    auto it = textures.find(textureID);
+    if (it == textures.end()) return;
+
+    StreamedTexture& texture = it->second;
+
+    //A READ STILL IN FLIGHT IS DROPPED WHEN IT COMPLETES, ITS SERIAL NO LONGER MATCHES
+    if (texture.loading)
+    {
+        numLoading--;
+        loadingBytes -= GetLevelBytes(texture, texture.loadingLevel, texture.residentLevel);
+    }
+
+    residentBytes -= GetLevelBytes(texture, texture.residentLevel, texture.tailLevel);
+    textures.erase(it);
+}
+
+void TextureStreamer::Request(unsigned int textureID, float screenPixels)
+{
+    auto it = textures.find(textureID);
+    if (it == textures.end()) return;
+
+    StreamedTexture& texture = it->second;
+
+    //ONE TEXEL PER PIXEL, ROUNDED TOWARDS THE FINER LEVEL
+    int level = 0;
+    if (screenPixels < (float)texture.size) level = (int)std::floor(std::log2((float)texture.size / std::max(screenPixels, 1.0f)));
+    level = std::min(std::max(level, 0), texture.tailLevel);
+
+    if (texture.lastRequestFrame != frame) texture.requestedLevel = level;
+    else texture.requestedLevel = std::min(texture.requestedLevel, level);
+
+    texture.lastRequestFrame = frame;
+}
+
+void TextureStreamer::Update()
+{
+    UploadCompleted();
+
+    std::vector<std::pair<int, unsigned int>> loads;
+
+    for (auto& pair : textures)
+    {
+        StreamedTexture& texture = pair.second;
+
+        //TEXTURES NOT SEEN THIS FRAME ONLY NEED THEIR TAIL. WITH STREAMING OFF EVERY LEVEL IS BROUGHT BACK
+        if (!enabled) texture.wantedLevel = 0;
+        else texture.wantedLevel = texture.lastRequestFrame == frame ? texture.requestedLevel : texture.tailLevel;
+
+        if (!texture.loading && !texture.cookedPath.empty() && texture.wantedLevel < texture.residentLevel)
+        {
+            loads.emplace_back(texture.residentLevel - texture.wantedLevel, pair.first);
+        }
+    }
+
+    if (enabled) Evict(budgetBytes);
+
+    //MOST MISSING LEVELS FIRST
+    std::sort(loads.begin(), loads.end(), [](const std::pair<int, unsigned int>& a, const std::pair<int, unsigned int>& b) { return a.first > b.first; });
+
+    for (const std::pair<int, unsigned int>& load : loads)
+    {
+        if (numLoading >= maxLoadsPerFrame) break;
+
+        StreamedTexture& texture = textures[load.second];
+        size_t bytes = GetLevelBytes(texture, texture.wantedLevel, texture.residentLevel);
+
+        if (enabled && residentBytes + loadingBytes + bytes > budgetBytes)
+        {
+            if (bytes > budgetBytes) continue;
+
+            Evict(budgetBytes - bytes);
+            if (residentBytes + loadingBytes + bytes > budgetBytes) continue;
+        }
+
+        StartLoad(load.second, texture, texture.wantedLevel);
+    }
+
+    frame++;
+}
+
+void TextureStreamer::CleanUp()
+{
+    while (numInFlight > 0) std::this_thread::yield();
+
+    completed.clear();
+    textures.clear();
+    numLoading = 0;
+    residentBytes = 0;
+    loadingBytes = 0;
+}
+
+void TextureStreamer::UploadCompleted()
+{
+    std::vector<CompletedLoad> loads;
+    {
+        std::lock_guard<std::mutex> lock(completedMutex);
+        loads.swap(completed);
+    }
+
+    for (CompletedLoad& load : loads)
+    {
+        auto it = textures.find(load.textureID);
+        if (it == textures.end() || it->second.serial != load.serial)
+        {
+            if (load.staging) Engine::GetInstance().render->ReleaseUploadStaging(load.staging);
+            continue;
+        }
+
+        StreamedTexture& texture = it->second;
+        size_t bytes = GetLevelBytes(texture, load.firstLevel, texture.residentLevel);
+
+        texture.loading = false;
+        numLoading--;
+        loadingBytes -= bytes;
+
+        //THE TEXTURE KEEPS WHAT IT HAS AND STOPS STREAMING
+        if (load.levels.empty())
+        {
+            if (load.staging) Engine::GetInstance().render->ReleaseUploadStaging(load.staging);
+            LOG("Error streaming texture levels from %s", texture.cookedPath.c_str());
+            texture.cookedPath.clear();
+            continue;
+        }
+
+        Engine::GetInstance().render->UploadTextureLevels(load.textureID, texture.format, load.levels, load.firstLevel);
+        texture.residentLevel = load.firstLevel;
+        residentBytes += bytes;
+    }
+}
+
+void TextureStreamer::Evict(size_t targetBytes)
+{
+    if (residentBytes + loadingBytes <= targetBytes) return;
+
+    //ONLY LEVELS FINER THAN WHAT IS NEEDED RIGHT NOW, LEAST RECENTLY SEEN FIRST
+    std::vector<std::pair<uint64_t, unsigned int>> candidates;
+    for (auto& pair : textures)
+    {
+        const StreamedTexture& texture = pair.second;
+        if (!texture.loading && texture.residentLevel < texture.wantedLevel) candidates.emplace_back(texture.lastRequestFrame, pair.first);
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+
+    for (const std::pair<uint64_t, unsigned int>& candidate : candidates)
+    {
+        if (residentBytes + loadingBytes <= targetBytes) break;
+
+        StreamedTexture& texture = textures[candidate.second];
+        Engine::GetInstance().render->EvictTextureLevels(candidate.second, texture.residentLevel, texture.wantedLevel);
+
+        residentBytes -= GetLevelBytes(texture, texture.residentLevel, texture.wantedLevel);
+        texture.residentLevel = texture.wantedLevel;
+    }
+}
+
+void TextureStreamer::StartLoad(unsigned int textureID, StreamedTexture& texture, int firstLevel)
+{
+    texture.loading = true;
+    texture.loadingLevel = firstLevel;
+    numLoading++;
+    loadingBytes += GetLevelBytes(texture, firstLevel, texture.residentLevel);
+    numInFlight++;
+
+    std::string path = texture.cookedPath;
+    uint64_t serial = texture.serial;
+    int lastLevel = texture.residentLevel;
+    TextureFormat format = texture.format;
+
+    //LEVEL OFFSETS INSIDE THE STAGING MEMORY, NULL IF THE RING IS OFF OR FULL
+    std::vector<size_t> offsets;
+    std::vector<size_t> sizes(texture.levelBytes.begin() + firstLevel, texture.levelBytes.begin() + lastLevel);
+    size_t stagingBytes = 0;
+    for (int level = firstLevel; level < lastLevel; level++)
+    {
+        offsets.push_back(stagingBytes);
+        stagingBytes += (texture.levelBytes[level] + W16TEX_ALIGNMENT - 1) & ~(size_t)(W16TEX_ALIGNMENT - 1);
+    }
+
+    uint8_t* staging = Engine::GetInstance().render->AllocateUploadStaging(stagingBytes);
+
+    //THE WORKER TOUCHES THE MAPPING, SO THE DISK READ NEVER STALLS THE FRAME. NO GL CALLS HERE
+    JobSystem::GetInstance().Submit([this, textureID, serial, path, firstLevel, lastLevel, format, staging, offsets, sizes]() {
+        CompletedLoad load;
+        load.textureID = textureID;
+        load.serial = serial;
+        load.firstLevel = firstLevel;
+        load.staging = staging;
+
+        MappedFile file;
+        TextureFileData data;
+
+        if (file.Open(path) && ReadTextureFile(file, data, false) && data.format == format && (int)data.levels.size() >= lastLevel)
+        {
+            for (int level = firstLevel; level < lastLevel; level++)
+            {
+                //RE-COOKED UNDER THE SAME NAME, THE LEVELS NO LONGER FIT
+                if (data.levels[level].size != sizes[level - firstLevel])
+                {
+                    load.levels.clear();
+                    load.data.clear();
+                    break;
+                }
+
+                const uint8_t* bytes = static_cast<const uint8_t*>(data.levels[level].data);
+                load.levels.push_back(data.levels[level]);
+
+                if (staging)
+                {
+                    memcpy(staging + offsets[level - firstLevel], bytes, data.levels[level].size);
+                    load.levels.back().data = staging + offsets[level - firstLevel];
+                }
+                else
+                {
+                    load.data.emplace_back(bytes, bytes + data.levels[level].size);
+                    load.levels.back().data = load.data.back().data();
+                }
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(completedMutex);
+            completed.push_back(std::move(load));
+        }
+
+        numInFlight--;
+    });
+}
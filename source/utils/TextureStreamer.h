@@ -0,0 +1,98 @@
+#pragma once
+#include "TextureFile.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+#define TEXTURE_STREAMING_DEFAULT_BUDGET (256ull * 1024 * 1024)
+
+//Levels this size and smaller are uploaded with the texture and never evicted
+#define TEXTURE_STREAMING_TAIL_SIZE 64
+
+//Keeps only the mip levels a texture needs on screen in VRAM. Textures start with their tail levels resident, finer
+//levels are read from the cooked W16Tex on the job system and uploaded in Update(). When streamed levels go over the
+//budget the ones nobody needs right now are dropped, least recently seen texture first.
+class TextureStreamer
+{
+public:
+    static TextureStreamer& GetInstance() {
+        static TextureStreamer instance;
+        return instance;
+    }
+
+    //First level of the resident tail
+    static int GetTailLevel(const TextureFileData& texture);
+
+    void Register(unsigned int textureID, const std::string& cookedPath, const TextureFileData& texture, int residentLevel);
+    void Unregister(unsigned int textureID);
+
+    //screenPixels is the projected size of what the texture covers this frame
+    void Request(unsigned int textureID, float screenPixels);
+
+    //Uploads finished reads, evicts and starts new reads. Once per frame on the GL thread, after the requests.
+    void Update();
+
+    //Waits for the reads in flight and forgets every texture
+    void CleanUp();
+
+    size_t GetResidentBytes() const { return residentBytes; }
+    size_t GetNumTextures() const { return textures.size(); }
+    int GetNumLoading() const { return numLoading; }
+
+public:
+    bool enabled = true;
+    size_t budgetBytes = TEXTURE_STREAMING_DEFAULT_BUDGET;
+    int maxLoadsPerFrame = 4;
+
+private:
+    struct StreamedTexture
+    {
+        std::string cookedPath;
+        TextureFormat format = TextureFormat::RGBA8;
+        uint32_t size = 0;
+        std::vector<size_t> levelBytes;
+        int tailLevel = 0;
+        int residentLevel = 0;
+        int requestedLevel = 0;
+        int wantedLevel = 0;
+        int loadingLevel = 0;
+        uint64_t lastRequestFrame = 0;
+        uint64_t serial = 0;
+        bool loading = false;
+    };
+
+    struct CompletedLoad
+    {
+        unsigned int textureID = 0;
+        uint64_t serial = 0;
+        int firstLevel = 0;
+        std::vector<std::vector<uint8_t>> data;
+        std::vector<TextureLevel> levels;
+
+        //LEVELS READ STRAIGHT INTO THE RENDER'S UPLOAD RING, data STAYS EMPTY
+        uint8_t* staging = nullptr;
+    };
+
+    //Bytes of the levels in [first, last)
+    static size_t GetLevelBytes(const StreamedTexture& texture, int first, int last);
+
+    void UploadCompleted();
+    void Evict(size_t targetBytes);
+    void StartLoad(unsigned int textureID, StreamedTexture& texture, int firstLevel);
+
+private:
+    std::unordered_map<unsigned int, StreamedTexture> textures;
+    std::vector<CompletedLoad> completed;
+    std::mutex completedMutex;
+    std::atomic<int> numInFlight{ 0 };
+
+    int numLoading = 0;
+    size_t residentBytes = 0;
+    size_t loadingBytes = 0;
+    uint64_t frame = 1;
+    uint64_t nextSerial = 1;
+};
@@ -0,0 +1,166 @@
+#include "VertexPacking.h"
+#include "AABB.h"
+
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+uint16_t FloatToHalf(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    uint32_t sign = (bits >> 16) & 0x8000;
+    uint32_t exponent = (bits >> 23) & 0xFF;
+    uint32_t mantissa = bits & 0x7FFFFF;
+
+    //INF AND NAN
+    if (exponent == 0xFF) return (uint16_t)(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+
+    int halfExponent = (int)exponent - 127 + 15;
+
+    if (halfExponent >= 31) return (uint16_t)(sign | 0x7C00);
+
+    //DENORMALS, ROUND TO NEAREST EVEN
+    if (halfExponent <= 0)
+    {
+        if (halfExponent < -10) return (uint16_t)sign;
+
+        mantissa |= 0x800000;
+        uint32_t shift = 14 - halfExponent;
+        uint32_t half = mantissa >> shift;
+        uint32_t remainder = mantissa & ((1u << shift) - 1);
+        uint32_t middle = 1u << (shift - 1);
+        if (remainder > middle || (remainder == middle && (half & 1))) half++;
+        return (uint16_t)(sign | half);
+    }
+
+    uint32_t half = ((uint32_t)halfExponent << 10) | (mantissa >> 13);
+    uint32_t remainder = mantissa & 0x1FFF;
+    if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1))) half++;
+
+    return (uint16_t)(sign | half);
+}
+
+float HalfToFloat(uint16_t value)
+{
+    uint32_t sign = (uint32_t)(value & 0x8000) << 16;
+    uint32_t exponent = (value >> 10) & 0x1F;
+    uint32_t mantissa = value & 0x3FF;
+
+    if (exponent == 0)
+    {
+        float denormal = std::ldexp((float)mantissa, -24);
+        return sign ? -denormal : denormal;
+    }
+
+    uint32_t bits;
+    if (exponent == 31) bits = sign | 0x7F800000 | (mantissa << 13);
+    else bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+
+    float result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+glm::vec2 OctEncode(const glm::vec3& normal)
+{
+    float sum = std::fabs(normal.x) + std::fabs(normal.y) + std::fabs(normal.z);
+    if (sum <= 0.0f) return glm::vec2(0.0f);
+
+    glm::vec3 n = normal / sum;
+
+    if (n.z >= 0.0f) return glm::vec2(n.x, n.y);
+
+    return glm::vec2(
+        (1.0f - std::fabs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f),
+        (1.0f - std::fabs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f));
+}
+
+glm::vec3 OctDecode(const glm::vec2& encoded)
+{
+    glm::vec3 n = glm::vec3(encoded.x, encoded.y, 1.0f - std::fabs(encoded.x) - std::fabs(encoded.y));
+    float t = std::max(-n.z, 0.0f);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+    return glm::normalize(n);
+}
+
+static int16_t ToSnorm16(float value)
+{
+    return (int16_t)std::lround(std::min(std::max(value, -1.0f), 1.0f) * 32767.0f);
+}
+
+static float FromSnorm16(int16_t value)
+{
+    return std::max((float)value / 32767.0f, -1.0f);
+}
+
+void PackVertices(const std::vector<Vertex>& vertices, const AABB& aabb, Span<PackedVertex> packed)
+{
+    glm::vec3 extent = aabb.max - aabb.min;
+    glm::vec3 invExtent = glm::vec3(
+        extent.x > 0.0f ? 65535.0f / extent.x : 0.0f,
+        extent.y > 0.0f ? 65535.0f / extent.y : 0.0f,
+        extent.z > 0.0f ? 65535.0f / extent.z : 0.0f);
+
+    for (size_t i = 0; i < vertices.size(); i++)
+    {
+        const Vertex& vertex = vertices[i];
+        PackedVertex& out = packed[i];
+
+        for (int axis = 0; axis < 3; axis++)
+        {
+            float quantized = (vertex.position[axis] - aabb.min[axis]) * invExtent[axis];
+            out.position[axis] = (uint16_t)std::lround(std::min(std::max(quantized, 0.0f), 65535.0f));
+        }
+        out.position[3] = 0;
+
+        glm::vec2 octNormal = OctEncode(vertex.normal);
+        out.normal[0] = ToSnorm16(octNormal.x);
+        out.normal[1] = ToSnorm16(octNormal.y);
+
+        out.texCoords[0] = FloatToHalf(vertex.texCoords.x);
+        out.texCoords[1] = FloatToHalf(vertex.texCoords.y);
+    }
+}
+
+void UnpackVertices(const PackedVertex* packed, size_t count, const AABB& aabb, std::vector<Vertex>& vertices)
+{
+    vertices.resize(count);
+
+    glm::vec3 scale = (aabb.max - aabb.min) / 65535.0f;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const PackedVertex& in = packed[i];
+        Vertex& vertex = vertices[i];
+
+        vertex.position = aabb.min + glm::vec3(in.position[0], in.position[1], in.position[2]) * scale;
+        vertex.normal = OctDecode(glm::vec2(FromSnorm16(in.normal[0]), FromSnorm16(in.normal[1])));
+        vertex.texCoords = glm::vec2(HalfToFloat(in.texCoords[0]), HalfToFloat(in.texCoords[1]));
+    }
+}
+
+bool CanUseShortIndices(size_t numVertices)
+{
+    return numVertices <= 65536;
+}
+
+void PackIndices(const std::vector<unsigned int>& indices, Span<uint16_t> packed)
+{
+    for (size_t i = 0; i < indices.size(); i++)
+    {
+        packed[i] = (uint16_t)indices[i];
+    }
+}
+
+size_t GetVertexStride(VertexFormat format)
+{
+    return format == VertexFormat::Packed ? sizeof(PackedVertex) : sizeof(Vertex);
+}
+
+size_t GetIndexSize(IndexFormat format)
+{
+    return format == IndexFormat::UInt16 ? sizeof(uint16_t) : sizeof(uint32_t);
+}
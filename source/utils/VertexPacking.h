@@ -0,0 +1,24 @@
+#pragma once
+#include "../components/Mesh.h"
+#include "Span.h"
+#include <vector>
+#include <cstdint>
+
+class AABB;
+
+//Positions are quantized to 16 bits inside the mesh AABB, normals are octahedral encoded and UVs are half floats.
+uint16_t FloatToHalf(float value);
+float HalfToFloat(uint16_t value);
+
+glm::vec2 OctEncode(const glm::vec3& normal);
+glm::vec3 OctDecode(const glm::vec2& encoded);
+
+//The output spans must hold as many elements as the input
+void PackVertices(const std::vector<Vertex>& vertices, const AABB& aabb, Span<PackedVertex> packed);
+void UnpackVertices(const PackedVertex* packed, size_t count, const AABB& aabb, std::vector<Vertex>& vertices);
+
+bool CanUseShortIndices(size_t numVertices);
+void PackIndices(const std::vector<unsigned int>& indices, Span<uint16_t> packed);
+
+size_t GetVertexStride(VertexFormat format);
+size_t GetIndexSize(IndexFormat format);
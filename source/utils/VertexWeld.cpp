@@ -0,0 +1,201 @@
+#include "VertexWeld.h"
+#include "JobSystem.h"
+#include "../components/Mesh.h"
+
+#include <atomic>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+#define WELD_BATCH 4096
+#define WELD_EMPTY_KEY UINT64_MAX
+#define WELD_NO_VERTEX UINT32_MAX
+#define WELD_CELL_BITS 21
+#define WELD_CELL_MAX ((1 << WELD_CELL_BITS) - 1)
+
+static uint64_t PackCell(int x, int y, int z)
+{
+    x = std::min(std::max(x, 0), WELD_CELL_MAX);
+    y = std::min(std::max(y, 0), WELD_CELL_MAX);
+    z = std::min(std::max(z, 0), WELD_CELL_MAX);
+    return ((uint64_t)x << (WELD_CELL_BITS * 2)) | ((uint64_t)y << WELD_CELL_BITS) | (uint64_t)z;
+}
+
+static uint64_t HashCell(uint64_t key)
+{
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdull;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ull;
+    key ^= key >> 33;
+    return key;
+}
+
+class CellTable
+{
+public:
+    CellTable(size_t numVertices) : nexts(numVertices)
+    {
+        size_t capacity = 16;
+        while (capacity < numVertices * 2) capacity <<= 1;
+
+        mask = capacity - 1;
+        keys = std::vector<std::atomic<uint64_t>>(capacity);
+        heads = std::vector<std::atomic<uint32_t>>(capacity);
+
+        JobSystem::GetInstance().ParallelFor(capacity, WELD_BATCH * 4, [this](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+            {
+                keys[i].store(WELD_EMPTY_KEY, std::memory_order_relaxed);
+                heads[i].store(WELD_NO_VERTEX, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    //Chains every vertex of a cell. The chain order depends on the insertion order, so searches must visit the whole chain
+    void Insert(uint64_t key, uint32_t vertex)
+    {
+        size_t slot = HashCell(key) & mask;
+
+        while (true)
+        {
+            uint64_t current = keys[slot].load();
+
+            if (current == WELD_EMPTY_KEY)
+            {
+                if (!keys[slot].compare_exchange_strong(current, key)) continue;
+                current = key;
+            }
+
+            if (current == key)
+            {
+                nexts[vertex] = heads[slot].exchange(vertex);
+                return;
+            }
+
+            slot = (slot + 1) & mask;
+        }
+    }
+
+    uint32_t Find(uint64_t key) const
+    {
+        size_t slot = HashCell(key) & mask;
+
+        while (true)
+        {
+            uint64_t current = keys[slot].load(std::memory_order_relaxed);
+            if (current == key) return heads[slot].load(std::memory_order_relaxed);
+            if (current == WELD_EMPTY_KEY) return WELD_NO_VERTEX;
+            slot = (slot + 1) & mask;
+        }
+    }
+
+    uint32_t Next(uint32_t vertex) const { return nexts[vertex]; }
+
+private:
+    std::vector<std::atomic<uint64_t>> keys;
+    std::vector<std::atomic<uint32_t>> heads;
+    std::vector<uint32_t> nexts;
+    size_t mask;
+};
+
+size_t WeldPositions(const std::vector<Vertex>& vertices, float epsilon, std::vector<unsigned int>& remap, std::vector<unsigned int>& uniqueVertices)
+{
+    size_t numVertices = vertices.size();
+    remap.resize(numVertices);
+    uniqueVertices.clear();
+
+    if (numVertices == 0) return 0;
+
+    JobSystem& jobs = JobSystem::GetInstance();
+
+    //GRID ORIGIN
+    size_t numBatches = (numVertices + WELD_BATCH - 1) / WELD_BATCH;
+    std::vector<glm::vec3> batchMin(numBatches, glm::vec3(INFINITY));
+
+    jobs.ParallelFor(numVertices, WELD_BATCH, [&](size_t begin, size_t end) {
+        glm::vec3 localMin = glm::vec3(INFINITY);
+        for (size_t i = begin; i < end; i++)
+        {
+            localMin = glm::min(localMin, vertices[i].position);
+        }
+        batchMin[begin / WELD_BATCH] = localMin;
+    });
+
+    glm::vec3 origin = glm::vec3(INFINITY);
+    for (const glm::vec3& localMin : batchMin) origin = glm::min(origin, localMin);
+
+    float cellSize = epsilon > 0.0f ? epsilon : 1e-7f;
+    float invCellSize = 1.0f / cellSize;
+
+    //CELL PER VERTEX AND EVERY VERTEX PER CELL
+    std::vector<glm::ivec3> cells(numVertices);
+    CellTable table(numVertices);
+
+    jobs.ParallelFor(numVertices, WELD_BATCH, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            glm::vec3 cell = glm::floor((vertices[i].position - origin) * invCellSize);
+            cells[i] = glm::ivec3((int)cell.x, (int)cell.y, (int)cell.z);
+            table.Insert(PackCell(cells[i].x, cells[i].y, cells[i].z), (uint32_t)i);
+        }
+    });
+
+    //EVERY VERTEX PICKS THE LOWEST VERTEX WITHIN EPSILON IN THE 27 NEIGHBOUR CELLS
+    std::vector<uint32_t> representative(numVertices);
+    float epsilonSquared = epsilon * epsilon;
+
+    jobs.ParallelFor(numVertices, WELD_BATCH, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            const glm::vec3& position = vertices[i].position;
+            uint32_t best = (uint32_t)i;
+
+            for (int dx = -1; dx <= 1; dx++)
+            for (int dy = -1; dy <= 1; dy++)
+            for (int dz = -1; dz <= 1; dz++)
+            {
+                uint32_t candidate = table.Find(PackCell(cells[i].x + dx, cells[i].y + dy, cells[i].z + dz));
+                for (; candidate != WELD_NO_VERTEX; candidate = table.Next(candidate))
+                {
+                    if (candidate >= best) continue;
+
+                    glm::vec3 delta = vertices[candidate].position - position;
+                    if (glm::dot(delta, delta) <= epsilonSquared) best = candidate;
+                }
+            }
+
+            representative[i] = best;
+        }
+    });
+
+    //FOLLOW THE CHAINS TO THEIR ROOT. REPRESENTATIVES ONLY DECREASE, SO THIS ENDS
+    jobs.ParallelFor(numVertices, WELD_BATCH, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            uint32_t root = representative[i];
+            while (representative[root] != root) root = representative[root];
+            remap[i] = root;
+        }
+    });
+
+    //COMPACT IDS IN SOURCE ORDER
+    std::vector<unsigned int> compactId(numVertices, 0);
+    for (size_t i = 0; i < numVertices; i++)
+    {
+        if (remap[i] == i)
+        {
+            compactId[i] = (unsigned int)uniqueVertices.size();
+            uniqueVertices.push_back((unsigned int)i);
+        }
+    }
+
+    jobs.ParallelFor(numVertices, WELD_BATCH, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+        {
+            remap[i] = compactId[remap[i]];
+        }
+    });
+
+    return uniqueVertices.size();
+}
@@ -0,0 +1,11 @@
+#pragma once
+#include <vector>
+#include <cstddef>
+
+struct Vertex;
+
+#define WELD_RELATIVE_EPSILON 1e-6f
+
+//Welds vertices closer than epsilon with a parallel spatial hash. remap[i] is the welded id of vertex i, in [0, uniqueVertices.size()),
+//and uniqueVertices[id] is the lowest source vertex of every welded group. The result doesn't depend on the thread count.
+size_t WeldPositions(const std::vector<Vertex>& vertices, float epsilon, std::vector<unsigned int>& remap, std::vector<unsigned int>& uniqueVertices);
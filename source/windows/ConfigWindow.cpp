@@ -2,6 +2,14 @@
 #include "imgui.h"
 #include "../Engine.h"
 #include "../Render.h"
+#include "../Loader.h"
+#include "../Scene.h"
+#include "../utils/MeshResidency.h"
+#include "../utils/StaticBatch.h"
+#include "../utils/TextureCache.h"
+#include "../utils/TextureStreamer.h"
+#include "../utils/ImportDatabase.h"
+#include "../utils/MeshCache.h"
 #include "../Window.h"
 
 ConfigWindow::ConfigWindow(bool active) : UIWindow("Configuration", active)
@@ -77,6 +85,87 @@ void ConfigWindow::Draw()
             150.0f,
             ImVec2(-1.0f, 50)
         );
+
+        ImGui::Text("Peak: %.1f MB", mem_counters.PeakWorkingSetSize / (1024.0f * 1024.0f));
+    }
+
+    if (ImGui::CollapsingHeader("Render"))
+    {
+        Render* render = Engine::GetInstance().render;
+        ImGui::Checkbox("Meshlet Culling", &render->meshletCulling);
+        ImGui::Checkbox("Validate Meshlet Culling", &render->validateMeshletCulling);
+        ImGui::Checkbox("Packed Vertex Format (new meshes)", &render->packedVertexFormat);
+        ImGui::Checkbox("Static Batching", &render->staticBatching);
+        ImGui::Text("Static Batches: %d (%d objects)", render->GetStaticBatcher()->GetBatchCount(), render->GetStaticBatcher()->GetObjectCount());
+
+        //PROXIES ARE BUILT WITH THE STATIC TREE, CHANGING THE NODE SIZE REBUILDS IT
+        if (ImGui::Checkbox("HLOD Proxies", &render->hlod)) Engine::GetInstance().scene->MarkStaticTreeDirty();
+        ImGui::SliderFloat("HLOD Min Node Size", &render->hlodMinNodeSize, 4.0f, 512.0f);
+        if (ImGui::IsItemDeactivatedAfterEdit()) Engine::GetInstance().scene->MarkStaticTreeDirty();
+        ImGui::SliderFloat("HLOD Screen Size", &render->hlodScreenSize, 0.0f, 0.5f);
+        ImGui::Text("HLOD Proxies: %d", render->GetStaticBatcher()->GetProxyCount());
+    }
+
+    if (ImGui::CollapsingHeader("Library"))
+    {
+        ImGui::Checkbox("Compress Meshes", &Engine::GetInstance().loader->compressLibraryMeshes);
+        ImGui::Checkbox("Load Cooked Models", &Engine::GetInstance().loader->useImportCache);
+        ImGui::Checkbox("Async Model Import", &Engine::GetInstance().loader->asyncImport);
+        ImGui::SliderFloat("Import Budget (ms)", &Engine::GetInstance().loader->importBudgetMs, 0.5f, 16.0f);
+        ImGui::Checkbox("Low Memory Import", &Engine::GetInstance().loader->lowMemoryImport);
+        ImGui::Checkbox("Watch Assets", &Engine::GetInstance().loader->watchAssets);
+        ImGui::SliderFloat("Watch Interval (s)", &Engine::GetInstance().loader->watchIntervalSec, 0.25f, 10.0f);
+
+        Loader* loader = Engine::GetInstance().loader;
+        if (ImGui::BeginCombo("Import Profile", GetImportProfileName(loader->importProfile)))
+        {
+            for (int i = 0; i < (int)ModelImportProfile::Count; i++)
+            {
+                ModelImportProfile profile = (ModelImportProfile)i;
+                if (ImGui::Selectable(GetImportProfileName(profile), loader->importProfile == profile)) loader->importProfile = profile;
+            }
+            ImGui::EndCombo();
+        }
+        ImGui::Text("Import Database: %d assets", (int)ImportDatabase::GetInstance().GetNumRecords());
+        ImGui::Text("Prefabs: %d, shared meshes: %d", loader->GetNumPrefabs(), (int)MeshCache::GetInstance().GetNumShared());
+        ImGui::Text("Reloading: %d models", loader->GetNumReloads());
+
+        //COPIES OF THE LAST MODEL LOADED, IN A GRID
+        const std::string& lastModel = loader->GetLastModelPath();
+        if (!lastModel.empty())
+        {
+            ImGui::SliderInt("Instances", &prefabInstances, 1, 10000);
+            if (ImGui::Button("Spawn Instances")) loader->InstantiatePrefab(lastModel, prefabInstances);
+            ImGui::SameLine();
+            ImGui::TextUnformatted(lastModel.c_str());
+        }
+
+        MeshResidency& residency = MeshResidency::GetInstance();
+        int budgetMB = (int)(residency.budgetBytes / (1024 * 1024));
+
+        ImGui::Checkbox("Evict CPU Mesh Copies", &residency.enabled);
+        if (ImGui::SliderInt("CPU Mesh Budget (MB)", &budgetMB, 16, 8192)) residency.budgetBytes = (size_t)budgetMB * 1024 * 1024;
+        ImGui::Text("Resident: %.1f MB in %d resources", residency.GetResidentBytes() / (1024.0f * 1024.0f), (int)residency.GetNumResident());
+
+        TextureCache& textures = TextureCache::GetInstance();
+        const char* qualityNames[] = { "Fast", "High" };
+        int quality = (int)textures.quality;
+
+        ImGui::Checkbox("Compress Textures", &textures.compress);
+        if (ImGui::Combo("Compression Quality", &quality, qualityNames, IM_ARRAYSIZE(qualityNames))) textures.quality = (BlockQuality)quality;
+        TextureStreamer& streamer = TextureStreamer::GetInstance();
+        int streamingBudgetMB = (int)(streamer.budgetBytes / (1024 * 1024));
+
+        ImGui::Checkbox("Stream Texture Mips", &streamer.enabled);
+        if (ImGui::SliderInt("Texture Streaming Budget (MB)", &streamingBudgetMB, 16, 8192)) streamer.budgetBytes = (size_t)streamingBudgetMB * 1024 * 1024;
+
+        size_t textureBytes = textures.GetVideoBytes() + streamer.GetResidentBytes();
+        ImGui::Text("Textures: %d unique, %.1f MB VRAM", (int)textures.GetNumTextures(), textureBytes / (1024.0f * 1024.0f));
+        ImGui::Text("Decoding: %d textures", textures.GetNumDecoding());
+        ImGui::Checkbox("Upload Through Pixel Buffers", &Engine::GetInstance().render->pboUploads);
+        ImGui::Checkbox("Validate Texture Uploads", &Engine::GetInstance().render->validateTextureUploads);
+        ImGui::Text("Upload Ring: %.1f MB in use", Engine::GetInstance().render->GetUploadStagingBytes() / (1024.0f * 1024.0f));
+        ImGui::Text("Streamed: %.1f MB in %d textures, %d reads in flight", streamer.GetResidentBytes() / (1024.0f * 1024.0f), (int)streamer.GetNumTextures(), streamer.GetNumLoading());
     }
 
     if (ImGui::CollapsingHeader("Hardware & Versions"))
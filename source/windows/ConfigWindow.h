@@ -16,5 +16,7 @@ private:
     std::vector<float> fps_log;
     std::vector<float> memory_log;
 
+    int prefabInstances = 100;
+
     PROCESS_MEMORY_COUNTERS mem_counters;
 };
\ No newline at end of file
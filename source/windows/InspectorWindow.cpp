@@ -114,6 +114,9 @@ void InspectorWindow::Draw()
 
                     if (mesh)
                     {
+                        bool meshEnabled = mesh->enabled;
+                        if (ImGui::Checkbox("Enabled##Mesh", &meshEnabled)) mesh->SetEnabled(meshEnabled);
+
                         ImGui::Text("Vertices:");
                         ImGui::SameLine(); 
                         ImGui::TextColored(ImVec4(0.8f, 0.8f, 0.0f, 1.0f), "%d", mesh->meshData.numVertices);
@@ -126,6 +129,14 @@ void InspectorWindow::Draw()
                         ImGui::SameLine();
                         ImGui::TextColored(ImVec4(0.0f, 0.7f, 0.9f, 1.0f), "%u", mesh->meshData.VAO);
 
+                        ImGui::Text("Vertex Format:");
+                        ImGui::SameLine();
+                        ImGui::TextUnformatted(mesh->meshData.vertexFormat == VertexFormat::Packed ? "Packed (16 B)" : "Full (32 B)");
+
+                        ImGui::Text("Index Format:");
+                        ImGui::SameLine();
+                        ImGui::TextUnformatted(mesh->meshData.indexFormat == IndexFormat::UInt16 ? "16 bit" : "32 bit");
+
                         ImGui::Text("Has UVs:");
                         ImGui::SameLine();
                         ImGui::TextUnformatted(mesh->hasUVs ? "Yes" : "No");
@@ -146,13 +157,20 @@ void InspectorWindow::Draw()
 
                         ImGui::Text("Size:");
                         ImGui::SameLine();
-                        ImGui::TextColored(ImVec4(0.0f, 0.7f, 0.9f, 1.0f), "%dx%d", texture->width, texture->height);
+                        if (texture->IsLoading()) ImGui::TextColored(ImVec4(0.9f, 0.7f, 0.0f, 1.0f), "Loading...");
+                        else ImGui::TextColored(ImVec4(0.0f, 0.7f, 0.9f, 1.0f), "%dx%d", texture->GetWidth(), texture->GetHeight());
                         ImGui::Text("Texture ID (GPU):");
                         ImGui::SameLine();
-                        ImGui::TextColored(ImVec4(0.0f, 0.7f, 0.9f, 1.0f), "%u", texture->textureID);
+                        ImGui::TextColored(ImVec4(0.0f, 0.7f, 0.9f, 1.0f), "%u", texture->GetTextureID());
                         ImGui::Separator();
-                        ImGui::Checkbox("Use Checker Texture", &texture->use_checker);
-                        ImGui::Checkbox("Transparent", &texture->transparent);
+                        bool changed = ImGui::Checkbox("Use Checker Texture", &texture->use_checker);
+                        if (ImGui::Checkbox("Transparent", &texture->transparent))
+                        {
+                            //THE BLOCK FORMAT DEPENDS ON IT
+                            if (!texture->path.empty()) texture->LoadTexture(texture->path);
+                            changed = true;
+                        }
+                        if (changed && gameObject->GetStatic()) Engine::GetInstance().scene->MarkStaticTreeDirty();
                     }
                 }
                 break;